@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_aligned_allocator_h__
+#define __Pongasoft_re_mock_aligned_allocator_h__
+
+#include <JukeboxTypes.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace re::mock {
+
+/**
+ * Alignment used for all audio memory handed to a device (DSP buffers, sample data, FFT working memory). It is a
+ * multiple of `JBox_GetOptimalFFTAlignment()` and of the widest SIMD register (AVX-512) so that aligned vector loads
+ * never split a cache line. */
+constexpr std::size_t kAudioAlignment = 64;
+
+/**
+ * Minimal allocator (usable with `std::vector`) which guarantees that the storage is aligned on `Alignment` bytes */
+template<typename T, std::size_t Alignment = kAudioAlignment>
+class AlignedAllocator
+{
+public:
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of 2");
+
+  using value_type = T;
+
+  template<typename U>
+  struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+  AlignedAllocator() noexcept = default;
+
+  template<typename U>
+  constexpr AlignedAllocator(AlignedAllocator<U, Alignment> const &) noexcept {}
+
+  T *allocate(std::size_t n)
+  {
+    return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+  }
+
+  void deallocate(T *p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t{Alignment});
+  }
+
+  template<typename U>
+  constexpr bool operator==(AlignedAllocator<U, Alignment> const &) const noexcept { return true; }
+
+  template<typename U>
+  constexpr bool operator!=(AlignedAllocator<U, Alignment> const &) const noexcept { return false; }
+};
+
+//! `std::vector` whose storage is aligned on `kAudioAlignment`
+template<typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+//! Storage for (interleaved) sample data
+using SampleData = aligned_vector<TJBox_AudioSample>;
+
+//! Returns `true` if `iPtr` is aligned on `Alignment` bytes
+template<std::size_t Alignment = kAudioAlignment>
+inline bool is_aligned(void const *iPtr) { return reinterpret_cast<std::uintptr_t>(iPtr) % Alignment == 0; }
+
+// Allows comparing aligned vectors with regular ones (found by ADL)
+template<typename T>
+inline bool operator==(aligned_vector<T> const &lhs, std::vector<T> const &rhs)
+{
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template<typename T>
+inline bool operator==(std::vector<T> const &lhs, aligned_vector<T> const &rhs) { return rhs == lhs; }
+
+template<typename T>
+inline bool operator!=(aligned_vector<T> const &lhs, std::vector<T> const &rhs) { return !(lhs == rhs); }
+
+template<typename T>
+inline bool operator!=(std::vector<T> const &lhs, aligned_vector<T> const &rhs) { return !(rhs == lhs); }
+
+}
+
+#endif //__Pongasoft_re_mock_aligned_allocator_h__
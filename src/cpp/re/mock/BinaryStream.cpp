@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "BinaryStream.h"
+#include <cstring>
+#include <fstream>
+
+namespace re::mock {
+
+//------------------------------------------------------------------------
+// BinaryWriter::BinaryWriter
+//------------------------------------------------------------------------
+BinaryWriter::BinaryWriter(Magic const &iMagic, TJBox_UInt32 iVersion)
+{
+  write(iMagic);
+  write(iVersion);
+}
+
+//------------------------------------------------------------------------
+// BinaryWriter::write
+//------------------------------------------------------------------------
+void BinaryWriter::write(void const *iData, size_t iSize)
+{
+  auto bytes = reinterpret_cast<char const *>(iData);
+  fBytes.insert(fBytes.end(), bytes, bytes + iSize);
+}
+
+//------------------------------------------------------------------------
+// BinaryWriter::writeString
+//------------------------------------------------------------------------
+void BinaryWriter::writeString(std::string const &iString)
+{
+  write(static_cast<TJBox_UInt32>(iString.size()));
+  write(iString.data(), iString.size());
+}
+
+//------------------------------------------------------------------------
+// BinaryWriter::save
+//------------------------------------------------------------------------
+void BinaryWriter::save(std::string const &iFilePath) const
+{
+  std::ofstream stream{iFilePath, std::ios::binary | std::ios::trunc};
+  RE_MOCK_ASSERT(stream.is_open(), "Cannot open [%s] for writing", iFilePath);
+  stream.write(fBytes.data(), static_cast<std::streamsize>(fBytes.size()));
+  RE_MOCK_ASSERT(stream.good(), "Error while writing [%s]", iFilePath);
+}
+
+//------------------------------------------------------------------------
+// BinaryWriter::flush
+//------------------------------------------------------------------------
+void BinaryWriter::flush(std::ostream &oStream)
+{
+  if(fBytes.empty())
+    return;
+
+  oStream.write(fBytes.data(), static_cast<std::streamsize>(fBytes.size()));
+  oStream.flush();
+  fBytes.clear();
+}
+
+//------------------------------------------------------------------------
+// BinaryReader::load
+//------------------------------------------------------------------------
+BinaryReader BinaryReader::load(std::string const &iFilePath,
+                                Magic const &iMagic,
+                                TJBox_UInt32 iVersion,
+                                std::string iDescription)
+{
+  std::ifstream stream{iFilePath, std::ios::binary | std::ios::ate};
+  RE_MOCK_ASSERT(stream.is_open(), "Cannot open %s [%s]", iDescription, iFilePath);
+
+  auto bytes = std::make_shared<std::vector<char>>(static_cast<size_t>(stream.tellg()));
+  stream.seekg(0);
+  stream.read(bytes->data(), static_cast<std::streamsize>(bytes->size()));
+  RE_MOCK_ASSERT(stream.good(), "Error while reading %s [%s]", iDescription, iFilePath);
+
+  BinaryReader res{std::move(bytes), std::move(iDescription)};
+
+  RE_MOCK_ASSERT(res.fBytes->size() >= sizeof(Magic) && res.read<Magic>() == iMagic,
+                 "[%s] is not a %s", iFilePath, res.fDescription);
+  auto version = res.read<TJBox_UInt32>();
+  RE_MOCK_ASSERT(version == iVersion, "Unsupported %s version [%d] (expected %d)", res.fDescription, version, iVersion);
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// BinaryReader::read
+//------------------------------------------------------------------------
+void BinaryReader::read(void *oData, size_t iSize)
+{
+  RE_MOCK_ASSERT(fPosition + iSize <= fBytes->size(), "Truncated %s", fDescription);
+  std::memcpy(oData, fBytes->data() + fPosition, iSize);
+  fPosition += iSize;
+}
+
+//------------------------------------------------------------------------
+// BinaryReader::readString
+//------------------------------------------------------------------------
+std::string BinaryReader::readString()
+{
+  auto size = read<TJBox_UInt32>();
+  std::string res(size, '\0');
+  read(res.data(), size);
+  return res;
+}
+
+}
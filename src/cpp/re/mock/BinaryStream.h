@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_binary_stream_h__
+#define __Pongasoft_re_mock_binary_stream_h__
+
+#include <JukeboxTypes.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Errors.h"
+
+namespace re::mock {
+
+/**
+ * The binary stream shared by the binary file formats (`StateArchive`, `InputRecording`):
+ *
+ * - header: magic (4 chars) + version (`UInt32`)
+ * - values in native byte order
+ * - strings as `UInt32` size + chars */
+class BinaryWriter
+{
+public:
+  using Magic = std::array<char, 4>;
+
+  BinaryWriter() = default;
+
+  //! Starts the stream with its header
+  BinaryWriter(Magic const &iMagic, TJBox_UInt32 iVersion);
+
+  template<typename T>
+  inline void write(T const &iValue) { write(&iValue, sizeof(T)); }
+  void write(void const *iData, size_t iSize);
+  void writeString(std::string const &iString);
+
+  //! Overwrites a value previously written at `iOffset` (ex: a count only known at the end)
+  template<typename T>
+  inline void overwrite(size_t iOffset, T const &iValue) {
+    RE_MOCK_INTERNAL_ASSERT(iOffset + sizeof(T) <= fBytes.size());
+    std::copy_n(reinterpret_cast<char const *>(&iValue), sizeof(T), fBytes.data() + iOffset);
+  }
+
+  //! Current size (the offset of the next value written)
+  size_t size() const { return fBytes.size(); }
+
+  std::vector<char> const &getBytes() const { return fBytes; }
+
+  //! Writes the bytes to the file at once
+  void save(std::string const &iFilePath) const;
+
+  //! Appends the bytes written so far to the stream and clears them (capacity is kept)
+  void flush(std::ostream &oStream);
+
+private:
+  std::vector<char> fBytes{};
+};
+
+/**
+ * Reads a stream written by `BinaryWriter` (every read is bounds checked). The bytes are shared, so copying a
+ * reader is cheap (and the copy reads from the same position independently). */
+class BinaryReader
+{
+public:
+  using Magic = BinaryWriter::Magic;
+
+  /**
+   * Reads the file at once and validates its header. `iDescription` describes the content of the file in error
+   * messages (ex: "state").
+   *
+   * @throw Exception if the file cannot be read or does not have the expected header */
+  static BinaryReader load(std::string const &iFilePath, Magic const &iMagic, TJBox_UInt32 iVersion, std::string iDescription);
+
+  template<typename T>
+  T read()
+  {
+    T res{};
+    read(&res, sizeof(T));
+    return res;
+  }
+
+  void read(void *oData, size_t iSize);
+  std::string readString();
+
+  bool done() const { return fPosition == fBytes->size(); }
+
+private:
+  BinaryReader(std::shared_ptr<const std::vector<char>> iBytes, std::string iDescription) :
+    fBytes{std::move(iBytes)}, fDescription{std::move(iDescription)} {}
+
+private:
+  std::shared_ptr<const std::vector<char>> fBytes;
+  std::string fDescription;
+  size_t fPosition{};
+};
+
+}
+
+#endif //__Pongasoft_re_mock_binary_stream_h__
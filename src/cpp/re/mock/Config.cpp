@@ -497,12 +497,12 @@ std::unique_ptr<resource::Patch> Config::findPatchResource(std::string const &iR
 
   // check the path as-is
   if(FileManager::fileExists(resourceFile))
-    return PatchParser::from(resourceFile);
+    return std::make_unique<resource::Patch>(*PatchParser::fromCache(resourceFile));
 
   // resolve the path against the resource dir
   auto resolvedResource = resource_file(resourceFile.fFilePath);
   if(resolvedResource && FileManager::fileExists(*resolvedResource))
-    return PatchParser::from(*resolvedResource);
+    return std::make_unique<resource::Patch>(*PatchParser::fromCache(*resolvedResource));
 
   return nullptr;
 }
@@ -150,10 +150,22 @@ struct Realtime
   using create_native_object_t = std::function<void *(const char iOperation[], const TJBox_Value iParams[], TJBox_UInt32 iCount)>;
   using destroy_native_object_t = std::function<void (const char iOperation[], void *iPrivateState)>;
   using render_realtime_t = std::function<void (void *iPrivateState, const TJBox_PropertyDiff iPropertyDiffs[], TJBox_UInt32 iDiffCount)>;
+  using clone_native_object_t = std::function<void *(const char iOperation[], void const *iPrivateState)>;
+  using serialize_native_object_t = std::function<std::string(const char iOperation[], void const *iPrivateState)>;
+  using deserialize_native_object_t = std::function<void *(const char iOperation[], std::string const &iBytes)>;
 
   create_native_object_t create_native_object{};
   destroy_native_object_t destroy_native_object{};
   render_realtime_t render_realtime{};
+  /**
+   * Optional: used by `Rack::snapshot()` / `Rack::restore()` to copy read/write native objects. Not set by default
+   * since a copy is only safe if the object does not own resources (raw pointers, handles...) freed by
+   * `destroy_native_object`: opt in with `Realtime::cloner<T>()` (ex: `DeviceConfig::rt_cloner()`) */
+  clone_native_object_t clone_native_object{};
+  //! Optional: used by `Motherboard::saveState()` / `Motherboard::loadState()` to save native objects (skipped otherwise)
+  serialize_native_object_t serialize_native_object{};
+  //! Optional: recreates a native object from the bytes produced by `serialize_native_object`
+  deserialize_native_object_t deserialize_native_object{};
 
   template<typename T>
   static create_native_object_t bySampleRateCreator(std::string iOperation = "Instance");
@@ -164,6 +176,10 @@ struct Realtime
   template<typename T>
   static render_realtime_t defaultRenderRealtime();
 
+  //! Returns a cloner using the copy constructor of `T` (empty if `T` is not copy constructible). Must be opted in.
+  template<typename T>
+  static clone_native_object_t cloner(std::string iOperation = "Instance");
+
   template<typename T>
   static Realtime byDefault();
 };
@@ -256,6 +272,10 @@ struct Config
   Config &enable_trace() { fTraceEnabled = true; return *this; }
   Config &disable_trace() { fTraceEnabled = false; return *this; }
 
+  //! Maximum number of traces kept in memory until they are flushed (see `Rack::flushTraces()`)
+  size_t traceBufferSize() const { return fTraceBufferSize; }
+  Config &trace_buffer_size(size_t iSize) { fTraceBufferSize = iSize; return *this; }
+
   Info const &info() const { return fInfo; }
 
   Config &default_patch(std::string const &s) { fInfo.default_patch(s); return *this; }
@@ -301,7 +321,8 @@ struct Config
   Config clone() const { return *this; }
 
   template<typename T>
-  Config &rt_jbox_export(std::optional<Realtime::destroy_native_object_t> iDestroyNativeObject = Realtime::destroyer<T>());
+  Config &rt_jbox_export(std::optional<Realtime::destroy_native_object_t> iDestroyNativeObject = Realtime::destroyer<T>(),
+                         std::optional<Realtime::clone_native_object_t> iCloneNativeObject = std::nullopt);
 
   Config& patch_string(std::string iResourcePath, std::string const &iPatchString) { fResources[iResourcePath] = ConfigResource::Patch{resource::String{iPatchString}}; return *this; }
   Config& patch_file(std::string iResourcePath, fs::path const &iPatchFile) { fResources[iResourcePath] = ConfigResource::Patch{resource::File{iPatchFile}}; return *this; }
@@ -346,6 +367,7 @@ protected:
 
   bool fDebugConfig{};
   bool fTraceEnabled{true};
+  size_t fTraceBufferSize{256};
   Info fInfo{};
   std::optional<fs::path> fDeviceRootDir{};
   std::optional<fs::path> fDeviceResourcesDir{};
@@ -379,6 +401,7 @@ struct DeviceConfig
 
   DeviceConfig &enable_trace() { fConfig.enable_trace(); return *this; }
   DeviceConfig &disable_trace() { fConfig.disable_trace(); return *this; }
+  DeviceConfig &trace_buffer_size(size_t iSize) { fConfig.trace_buffer_size(iSize); return *this; }
 
   DeviceConfig &device_root_dir(fs::path s) { fConfig.device_root_dir(s); return *this;}
   DeviceConfig &device_resources_dir(fs::path s) { fConfig.device_resources_dir(s); return *this;}
@@ -398,12 +421,20 @@ struct DeviceConfig
 
   DeviceConfig &rt(rt_callback_t iCallback) { fConfig.rt(std::move(iCallback)); return *this; }
 
-  DeviceConfig &rt_jbox_export(std::optional<Realtime::destroy_native_object_t> iDestroyNativeObject = Realtime::destroyer<T>())
+  DeviceConfig &rt_jbox_export(std::optional<Realtime::destroy_native_object_t> iDestroyNativeObject = Realtime::destroyer<T>(),
+                               std::optional<Realtime::clone_native_object_t> iCloneNativeObject = std::nullopt)
   {
-    fConfig.template rt_jbox_export<T>(iDestroyNativeObject);
+    fConfig.template rt_jbox_export<T>(iDestroyNativeObject, iCloneNativeObject);
     return *this;
   }
 
+  //! Opts in to copying the device (copy constructor) in `Rack::snapshot()` (only safe for a shallow copyable device)
+  DeviceConfig &rt_cloner()
+  {
+    static_assert(std::is_copy_constructible_v<T>, "rt_cloner requires a copy constructible device");
+    return rt([](Realtime &rt) { rt.clone_native_object = Realtime::cloner<T>(); });
+  }
+
   DeviceConfig clone() const { return *this; }
 
   DeviceConfig& patch_string(std::string iResourcePath, std::string const &iPatchString) { fConfig.patch_string(iResourcePath, iPatchString); return *this; }
@@ -463,6 +494,24 @@ Realtime::destroy_native_object_t Realtime::destroyer(std::string iOperation)
   };
 }
 
+//------------------------------------------------------------------------
+// Realtime::cloner
+//------------------------------------------------------------------------
+template<typename T>
+Realtime::clone_native_object_t Realtime::cloner(std::string iOperation)
+{
+  if constexpr(std::is_copy_constructible_v<T>)
+  {
+    return [operation=iOperation](const char iOperation[], void const *iNativeObject) -> void * {
+      if(std::strcmp(iOperation, operation.c_str()) == 0)
+        return new T(*reinterpret_cast<T const *>(iNativeObject));
+      return nullptr;
+    };
+  }
+  else
+    return {};
+}
+
 //------------------------------------------------------------------------
 // Realtime::bySampleRateCreator
 //------------------------------------------------------------------------
@@ -501,13 +550,16 @@ Realtime::render_realtime_t Realtime::defaultRenderRealtime()
 // Config::rt_jbox_export
 //------------------------------------------------------------------------
 template<typename T>
-Config &Config::rt_jbox_export(std::optional<Realtime::destroy_native_object_t> iDestroyNativeObject)
+Config &Config::rt_jbox_export(std::optional<Realtime::destroy_native_object_t> iDestroyNativeObject,
+                               std::optional<Realtime::clone_native_object_t> iCloneNativeObject)
 {
-  rt([iDestroyNativeObject](Realtime &rt) {
+  rt([iDestroyNativeObject, iCloneNativeObject](Realtime &rt) {
     rt.create_native_object = JBox_Export_CreateNativeObject;
     rt.render_realtime = JBox_Export_RenderRealtime;
     if(iDestroyNativeObject)
       rt.destroy_native_object = iDestroyNativeObject.value();
+    if(iCloneNativeObject)
+      rt.clone_native_object = iCloneNativeObject.value();
   });
   return *this;
 }
@@ -220,6 +220,17 @@ void DeviceTester::play(Duration iDuration, std::optional<tester::Timeline> iTim
     newTimeline().play(iDuration);
 }
 
+//------------------------------------------------------------------------
+// DeviceTester::preRoll
+//------------------------------------------------------------------------
+rack::PreRollStats DeviceTester::preRoll(Duration iDuration, std::optional<tester::Timeline> iTimeline)
+{
+  if(iTimeline)
+    return iTimeline->preRoll(iDuration);
+  else
+    return newTimeline().preRoll(iDuration);
+}
+
 //------------------------------------------------------------------------
 // DeviceTester::loadSample
 //------------------------------------------------------------------------
@@ -473,6 +484,16 @@ MockDevice::NoteEvents ExtensionNotePlayerTester::nextBatch(MockDevice::NoteEven
 
 namespace tester {
 
+//------------------------------------------------------------------------
+// Timeline::Timeline
+//------------------------------------------------------------------------
+Timeline::Timeline(DeviceTester *iTester) :
+  fTester{iTester},
+  fEvents{CountingAllocator<EventImpl>{iTester->fDevice.getMemoryCounter(MemoryReport::Subsystem::kTimelineEvents)}},
+  fOnEveryBatchEvents{CountingAllocator<Event>{iTester->fDevice.getMemoryCounter(MemoryReport::Subsystem::kTimelineEvents)}}
+{
+}
+
 const Timeline::Event Timeline::kNoOp = [](long iAtBatch) { return true; };
 const Timeline::Event Timeline::kEnd  = [](long iAtBatch) { return false; };
 
@@ -581,6 +602,14 @@ void Timeline::execute(bool iWithTransport, std::optional<Duration> iDuration) c
                  "Timeline should not call nextBatch() directly (or indirectly). Use after() api instead.");
 }
 
+//------------------------------------------------------------------------
+// Timeline::preRoll
+//------------------------------------------------------------------------
+rack::PreRollStats Timeline::preRoll(std::optional<Duration> iDuration) const
+{
+  return fTester->rack().preRoll([this, &iDuration]() { execute(true, iDuration); });
+}
+
 //------------------------------------------------------------------------
 // Timeline::executeEvents
 //------------------------------------------------------------------------
@@ -161,12 +161,20 @@ public:
   //! Executes the timeline while playing the transport
   inline void play(std::optional<Duration> iDuration = std::nullopt) const { execute(true, iDuration); }
 
+  /**
+   * Same as `play()` but in pre-roll mode: the transport, sequencer and devices advance as usual but the
+   * observers (like `MAUDst`) are skipped (see `Rack::preRoll()`). Useful to reach a given state (for example bar 300)
+   * as fast as possible.
+   *
+   * @return the number of batches processed and how long it took */
+  rack::PreRollStats preRoll(std::optional<Duration> iDuration = std::nullopt) const;
+
   // required for compilation
   friend class re::mock::DeviceTester;
 
 private:
-  //! Private constructor
-  Timeline(DeviceTester *iTester) : fTester{iTester} {}
+  //! Private constructor (the events are charged to the device of the tester)
+  Timeline(DeviceTester *iTester);
 
   // add an event at the given batch
   Timeline &event(size_t iAtBatch, Event iEvent);
@@ -185,17 +193,17 @@ private:
 protected:
   void ensureSorted() const;
 
-  std::vector<EventImpl> const &getEvents() const { ensureSorted(); return fEvents; }
+  counted_vector<EventImpl> const &getEvents() const { ensureSorted(); return fEvents; }
 
   size_t executeEvents(std::optional<Duration> iDuration) const;
 
 private:
   DeviceTester *fTester;
   size_t fCurrentBath{};
-  std::vector<EventImpl> fEvents{};
+  counted_vector<EventImpl> fEvents;
   mutable bool fSorted{true};
   int fLastEventId{};
-  std::vector<Event> fOnEveryBatchEvents{};
+  counted_vector<Event> fOnEveryBatchEvents;
 };
 
 }
@@ -371,6 +379,9 @@ public:
   //! Creates a new timeline that can either be executed (resp. played) or passed to various other calls
   tester::Timeline newTimeline() { return tester::Timeline(this); }
 
+  //! Formats and outputs the pending traces (see `Rack::setTraceAutoFlush()`)
+  inline void flushTraces(std::ostream &oStream = std::cout) { fRack.flushTraces(oStream); }
+
   //! Executes exactly one batch on the rack (which translates to one call to `JBox_Export_RenderRealtime` for all the devices in the rack).
   inline void nextBatch() { fRack.nextBatch(); }
 
@@ -405,6 +416,13 @@ public:
   //! Same as `iTimeline.play()`
   inline void play(tester::Timeline iTimeline) { iTimeline.play(); }
 
+  /**
+   * Same as `play()` but in pre-roll mode: the device under test is rendered but nothing is captured by the
+   * mock destinations (see `Timeline::preRoll()`)
+   *
+   * @return the number of batches processed and how long it took (`getBatchesPerSecond()`) */
+  rack::PreRollStats preRoll(Duration iDuration, std::optional<tester::Timeline> iTimeline = std::nullopt);
+
   /**
    * Convenient method to load a sample given a path
    *
@@ -430,6 +448,9 @@ public:
    * option in Reason) */
   void deviceReset() { fDevice.reset(); }
 
+  //! Loads the patch file into the device under test (similar to loading a patch in Reason)
+  void deviceLoadPatch(resource::File const &iPatchFile) { fDevice.loadPatch(iPatchFile); }
+
   /**
    * Loads the midi file provided and populates the sequencer track (of the device under test) with
    * the notes contained on all tracks (if `iTrack` is set to `-1`) or a specific track.
@@ -119,6 +119,44 @@ void Extension::importMidiNotes(smf::MidiEventList const &iEvents)
   fImpl->loadMidiNotes(iEvents);
 }
 
+//------------------------------------------------------------------------
+// Extension::saveState
+//------------------------------------------------------------------------
+void Extension::saveState(std::string const &iFilePath) const
+{
+  StateArchive::Writer writer{StateArchive::Kind::kDevice};
+  motherboard().saveState(writer);
+  writer.save(iFilePath);
+}
+
+//------------------------------------------------------------------------
+// Extension::loadState
+//------------------------------------------------------------------------
+void Extension::loadState(std::string const &iFilePath)
+{
+  auto reader = StateArchive::Reader::load(iFilePath, StateArchive::Kind::kDevice);
+  // the whole file is validated before the state is applied
+  auto state = withJukebox<std::unique_ptr<MotherboardSnapshot>>([&reader](Motherboard &m) { return m.decodeState(reader); });
+  RE_MOCK_ASSERT(reader.done(), "Unexpected data at the end of [%s]", iFilePath);
+  withJukebox([&state](Motherboard &m) { m.loadState(std::move(state)); });
+}
+
+//------------------------------------------------------------------------
+// Extension::setObserver
+//------------------------------------------------------------------------
+void Extension::setObserver(bool iObserver)
+{
+  fImpl->fObserver = iObserver;
+}
+
+//------------------------------------------------------------------------
+// Extension::isObserver
+//------------------------------------------------------------------------
+bool Extension::isObserver() const
+{
+  return fImpl->fObserver;
+}
+
 //------------------------------------------------------------------------
 // Extension::AudioOutSocket ==
 //------------------------------------------------------------------------
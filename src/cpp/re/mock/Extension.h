@@ -164,6 +164,66 @@ public:
    * Add the midi notes contained in the list of events (1 track of a midi file) to the sequencer track */
   void importMidiNotes(smf::MidiEventList const &iEvents);
 
+  /**
+   * Marks this extension as an observer: a device whose sole purpose is to capture what other devices produce
+   * (like `MAUDst`, `MCVDst` or `MNPDst`). Observers are not rendered while the rack is pre-rolling
+   * (see `Rack::preRoll()`). */
+  void setObserver(bool iObserver);
+
+  //! Returns `true` if this extension is an observer (see `setObserver()`)
+  bool isObserver() const;
+
+  /**
+   * Enables profiling of the `JBox_xxx` api calls made by this device (calls, time and bytes transferred per api).
+   * Profiling is off by default and costs nothing when off. */
+  inline void enableJboxProfiler() { motherboard().enableJboxProfiler(); }
+  inline void disableJboxProfiler() { motherboard().disableJboxProfiler(); }
+  inline void resetJboxProfiler() { motherboard().resetJboxProfiler(); }
+
+  //! Returns the counters accumulated since profiling was enabled / reset (use `toString()` for a report)
+  inline JboxProfiler::Snapshot getJboxProfilerSnapshot() const { return motherboard().getJboxProfilerSnapshot(); }
+
+  /**
+   * Records the inputs of this device (properties stored by the host and audio inputs, batch by batch) into
+   * `iFilePath` (see `InputRecording`) until `stopInputRecording()` is called. */
+  inline void startInputRecording(std::string const &iFilePath) { motherboard().startInputRecording(iFilePath); }
+
+  //! Stops recording and returns the number of batches recorded
+  inline size_t stopInputRecording() { return motherboard().stopInputRecording(); }
+
+  /**
+   * Replays a recording (see `startInputRecording()`) into this device which should be a fresh instance of the
+   * recorded device (for example in a rack containing only this device). The device is rendered once per recorded
+   * batch: there is no need (and it would be wrong) to call `Rack::nextBatch()`.
+   *
+   * @note the first replayed batch also delivers (as diffs) the values the device had when the recording started
+   *       and which differ from the defaults (see `InputRecording`)
+   *
+   * @return the number of batches replayed */
+  inline size_t replayInputs(InputRecording const &iRecording) {
+    return withJukebox<size_t>([&iRecording](Motherboard &m) { return m.replayInputs(iRecording); });
+  }
+
+  //! Loads the recording and replays it (see `replayInputs(InputRecording const &)`)
+  inline size_t replayInputs(std::string const &iFilePath) { return replayInputs(*InputRecording::load(iFilePath)); }
+
+  /**
+   * Saves the full state of this device into `iFilePath` (see `StateArchive`), to be restored later (for example in
+   * another process) with `loadState()`. */
+  void saveState(std::string const &iFilePath) const;
+
+  //! Restores the state saved by `saveState()` into this device (same config)
+  void loadState(std::string const &iFilePath);
+
+  //! Memory used by this device broken down by subsystem (see `Motherboard::memoryReport()`)
+  inline MemoryReport memoryReport() const { return motherboard().memoryReport(); }
+
+  //! Counter for the subsystem so that memory owned outside the device can be charged to it (ex: tester timelines)
+  inline std::shared_ptr<MemoryCounter> const &getMemoryCounter(MemoryReport::Subsystem iSubsystem) const
+  {
+    return motherboard().getMemoryCounter(iSubsystem);
+  }
+
   /**
    * Return the value of the property as the (opaque) Jukebox value
    * @param iPropertyPath the full path to the property (ex: `/custom_properties/my_prop`) */
@@ -305,6 +365,13 @@ public:
    * @see `setNoteInEvent(TJBox_UInt8, TJBox_UInt8, TJBox_UInt16)` */
   inline void setNoteInEvents(Motherboard::NoteEvents const &iNoteEvents) { motherboard().setNoteInEvents(iNoteEvents); }
 
+  /**
+   * Set multiple note events at once from a contiguous array of events (all events are validated before any
+   * is applied).
+   *
+   * @see `setNoteInEvent(TJBox_UInt8, TJBox_UInt8, TJBox_UInt16)` */
+  inline void setNoteInEvents(TJBox_NoteEvent const *iNoteEvents, std::size_t iCount) { motherboard().setNoteInEvents(iNoteEvents, iCount); }
+
    //! Get the value of the CV socket given its full path (`/cv_inputs/my_cv_socket`)
   inline TJBox_Float64 getCVSocketValue(std::string const &iSocketPath) const { return motherboard().getCVSocketValue(iSocketPath); }
 
@@ -394,6 +461,14 @@ public:
   //! Applies the patch
   inline void loadPatch(resource::Patch const &iPatch) { motherboard().loadPatch(iPatch); }
 
+  //! Applies the compiled patch (no path resolution / validation, see `compilePatch()`)
+  inline void loadPatch(CompiledPatch const &iPatch) { motherboard().loadPatch(iPatch); }
+
+  /**
+   * Resolves and validates the patch against this device once, so that it can then be applied repeatedly and cheaply
+   * with `loadPatch(CompiledPatch const &)` (for example to switch between presets inside a timeline) */
+  inline CompiledPatch compilePatch(resource::Patch const &iPatch) const { return motherboard().compilePatch(iPatch); }
+
   /**
    * Generate a patch object containing all properties that can be saved into a patch (persistence is set to `patch`).
    *
@@ -401,6 +476,12 @@ public:
    *       known state by calling `loadPatch(snapshotPatch)` */
   inline resource::Patch generatePatch() const { return motherboard().generatePatch(); }
 
+  /**
+   * Generate a patch object containing only the properties (persisted in patches) that changed since the previous
+   * call (or since the device was created). Much cheaper than `generatePatch()` for devices with many properties.
+   * Note that a property set and then set back to its original value is still part of the delta. */
+  inline resource::Patch generatePatchDelta() { return motherboard().generatePatchDelta(); }
+
   /**
    * When the device is instantiated, the lua code can provide default values for all the properties. If the device
    * uses patches and defines a default patch (in `info.lua`), then the default values are overiden by the values
@@ -529,6 +610,12 @@ public:
   //! Disable dispatching property diffs to rtc bindings (behaves as if rtc_bindings is empty)
   void disableRTCBindings() { motherboard().disableRTCBindings(); }
 
+  //! Validate the values stored by the device while rendering (default)
+  void enableRenderValidation() { motherboard().enableRenderValidation(); }
+
+  //! Skip validating the values stored by the device while rendering (values stored via the api are still validated)
+  void disableRenderValidation() { motherboard().disableRenderValidation(); }
+
   int getInstanceId() const;
 
   friend class re::mock::Rack;
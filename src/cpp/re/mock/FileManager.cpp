@@ -237,7 +237,8 @@ std::unique_ptr<resource::Sample> FileManager::loadSample(resource::File const &
 //------------------------------------------------------------------------
 void FileManager::saveSample(TJBox_UInt32 iChannels,
                              TJBox_UInt32 iSampleRate,
-                             std::vector<TJBox_AudioSample> const &iData,
+                             TJBox_AudioSample const *iData,
+                             size_t iSampleCount,
                              resource::File const &iToFile)
 {
   ma_encoder_config config = ma_encoder_config_init(ma_encoding_format_wav, ma_format_f32, iChannels, iSampleRate);
@@ -253,9 +254,9 @@ void FileManager::saveSample(TJBox_UInt32 iChannels,
   }
   auto encoderUninit = stl::defer([&encoder] { ma_encoder_uninit(&encoder); });
 
-  ma_uint64 framesToWrite = iData.size() / iChannels;
+  ma_uint64 framesToWrite = iSampleCount / iChannels;
   ma_uint64 framesWritten;
-  result = ma_encoder_write_pcm_frames(&encoder, iData.data(), framesToWrite, &framesWritten);
+  result = ma_encoder_write_pcm_frames(&encoder, iData, framesToWrite, &framesWritten);
   if(result != MA_SUCCESS)
   {
     RE_MOCK_LOG_ERROR("Error writing sample file [%s] %d/%s",
@@ -38,9 +38,22 @@ public:
   static void saveSample(resource::Sample const &iSample, resource::File const &iToFile) {
     saveSample(iSample.fChannels, iSample.fSampleRate, iSample.fData, iToFile);
   }
+  static void saveSample(TJBox_UInt32 iChannels,
+                         TJBox_UInt32 iSampleRate,
+                         SampleData const &iData,
+                         resource::File const &iToFile) {
+    saveSample(iChannels, iSampleRate, iData.data(), iData.size(), iToFile);
+  }
   static void saveSample(TJBox_UInt32 iChannels,
                          TJBox_UInt32 iSampleRate,
                          std::vector<TJBox_AudioSample> const &iData,
+                         resource::File const &iToFile) {
+    saveSample(iChannels, iSampleRate, iData.data(), iData.size(), iToFile);
+  }
+  static void saveSample(TJBox_UInt32 iChannels,
+                         TJBox_UInt32 iSampleRate,
+                         TJBox_AudioSample const *iData,
+                         size_t iSampleCount,
                          resource::File const &iToFile);
 
   static std::unique_ptr<smf::MidiFile> loadMidi(resource::File const &iFile, bool iConvertToReasonPPQ = true);
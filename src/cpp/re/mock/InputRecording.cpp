@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "InputRecording.h"
+#include "Errors.h"
+#include <algorithm>
+
+namespace re::mock {
+
+namespace {
+constexpr BinaryWriter::Magic kMagic{'R', 'E', 'M', 'I'};
+}
+
+//------------------------------------------------------------------------
+// InputRecording::isRecordable
+//------------------------------------------------------------------------
+bool InputRecording::isRecordable(JboxValue const &iValue)
+{
+  switch(iValue.getValueType())
+  {
+    case kJBox_Nil:
+    case kJBox_Number:
+    case kJBox_Boolean:
+    case kJBox_Incompatible:
+    case kJBox_String:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::Writer
+//------------------------------------------------------------------------
+InputRecording::Writer::Writer(std::string iFilePath) :
+  fFilePath{std::move(iFilePath)},
+  fStream{fFilePath, std::ios::binary | std::ios::trunc},
+  fBuffer{kMagic, kVersion}
+{
+  RE_MOCK_ASSERT(fStream.is_open(), "Cannot open [%s] for writing", fFilePath);
+  fBuffer.flush(fStream);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::~Writer
+//------------------------------------------------------------------------
+InputRecording::Writer::~Writer()
+{
+  // whatever was recorded since the last batch (stores not followed by a batch are never replayed)
+  fBuffer.flush(fStream);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::addAudioInput
+//------------------------------------------------------------------------
+void InputRecording::Writer::addAudioInput(impl::JboxProperty const *iBufferProperty)
+{
+  fAudioInputs.emplace_back(iBufferProperty);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::state
+//------------------------------------------------------------------------
+void InputRecording::Writer::state(impl::JboxProperty const &iProperty)
+{
+  auto value = iProperty.loadValue();
+  if(isRecordable(*value))
+    write(Record::kState, iProperty, *value, 0);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::store
+//------------------------------------------------------------------------
+void InputRecording::Writer::store(impl::JboxProperty const &iProperty, JboxValue const &iValue, TJBox_UInt16 iAtFrameIndex)
+{
+  if(isRecordable(iValue))
+    write(Record::kStore, iProperty, iValue, iAtFrameIndex);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::nextBatch
+//------------------------------------------------------------------------
+void InputRecording::Writer::nextBatch()
+{
+  for(auto property: fAudioInputs)
+  {
+    auto const &buffer = property->loadValue()->getDSPBuffer();
+
+    // silent buffers are not recorded (inputs are cleared after every batch)
+    if(std::all_of(buffer.begin(), buffer.end(), [](auto s) { return s == 0; }))
+      continue;
+
+    auto id = getPropertyId(*property);
+    fBuffer.write(Record::kAudio);
+    fBuffer.write(id);
+    fBuffer.write(buffer.data(), buffer.size() * sizeof(TJBox_AudioSample));
+  }
+
+  fBuffer.write(Record::kBatch);
+  fBatchCount++;
+  fBuffer.flush(fStream);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::write
+//------------------------------------------------------------------------
+void InputRecording::Writer::write(Record iRecord,
+                                   impl::JboxProperty const &iProperty,
+                                   JboxValue const &iValue,
+                                   TJBox_UInt16 iAtFrameIndex)
+{
+  auto id = getPropertyId(iProperty);
+  fBuffer.write(iRecord);
+  fBuffer.write(id);
+  fBuffer.write(iAtFrameIndex);
+  fBuffer.write(static_cast<TJBox_UInt8>(iValue.getValueType()));
+  switch(iValue.getValueType())
+  {
+    case kJBox_Number:
+      fBuffer.write(iValue.getNumber());
+      break;
+
+    case kJBox_Boolean:
+      fBuffer.write(static_cast<TJBox_UInt8>(iValue.getBoolean() ? 1 : 0));
+      break;
+
+    case kJBox_String:
+    {
+      auto const &s = iValue.getString();
+      fBuffer.write(static_cast<TJBox_Int32>(s.fMaxSize));
+      fBuffer.writeString(s.fValue);
+      break;
+    }
+
+    default:
+      // nil / incompatible: no payload
+      break;
+  }
+}
+
+//------------------------------------------------------------------------
+// InputRecording::Writer::getPropertyId
+//------------------------------------------------------------------------
+TJBox_UInt32 InputRecording::Writer::getPropertyId(impl::JboxProperty const &iProperty)
+{
+  auto iter = fPropertyIds.find(&iProperty);
+  if(iter != fPropertyIds.end())
+    return iter->second;
+
+  auto id = static_cast<TJBox_UInt32>(fPropertyIds.size());
+  fPropertyIds[&iProperty] = id;
+
+  fBuffer.write(Record::kProperty);
+  fBuffer.write(id);
+  fBuffer.writeString(iProperty.fInfo.fPropertyPath);
+  return id;
+}
+
+//------------------------------------------------------------------------
+// readValue
+//------------------------------------------------------------------------
+static InputRecording::Value readValue(BinaryReader &iReader)
+{
+  InputRecording::Value res{};
+  res.fType = static_cast<TJBox_ValueType>(iReader.read<TJBox_UInt8>());
+  switch(res.fType)
+  {
+    case kJBox_Number:
+      res.fNumber = iReader.read<TJBox_Float64>();
+      break;
+
+    case kJBox_Boolean:
+      res.fBoolean = iReader.read<TJBox_UInt8>() != 0;
+      break;
+
+    case kJBox_String:
+      res.fMaxSize = iReader.read<TJBox_Int32>();
+      res.fString = iReader.readString();
+      break;
+
+    case kJBox_Nil:
+    case kJBox_Incompatible:
+      break;
+
+    default:
+      RE_MOCK_FAIL("Invalid value type [%d] in recording", res.fType);
+  }
+  return res;
+}
+
+//------------------------------------------------------------------------
+// InputRecording::load
+//------------------------------------------------------------------------
+std::unique_ptr<InputRecording> InputRecording::load(std::string const &iFilePath)
+{
+  auto res = std::unique_ptr<InputRecording>(new InputRecording(BinaryReader::load(iFilePath, kMagic, kVersion, "recording")));
+
+  // validates the records and extracts the properties and number of batches
+  res->decode(Handler{}, &res->fPropertyPaths, &res->fBatchCount);
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// InputRecording::replay
+//------------------------------------------------------------------------
+void InputRecording::replay(Handler const &iHandler) const
+{
+  decode(iHandler, nullptr, nullptr);
+}
+
+//------------------------------------------------------------------------
+// InputRecording::decode
+//------------------------------------------------------------------------
+void InputRecording::decode(Handler const &iHandler, std::vector<std::string> *oPropertyPaths, size_t *oBatchCount) const
+{
+  auto const &propertyPaths = oPropertyPaths ? *oPropertyPaths : fPropertyPaths;
+
+  auto reader = fRecords; // (shares the bytes)
+
+  impl::DSPBuffer buffer{};
+
+  while(!reader.done())
+  {
+    auto record = reader.read<Record>();
+    switch(record)
+    {
+      case Record::kProperty:
+      {
+        auto id = reader.read<TJBox_UInt32>();
+        auto path = reader.readString();
+        if(oPropertyPaths)
+        {
+          RE_MOCK_ASSERT(id == oPropertyPaths->size(), "Invalid property id [%d] in recording", id);
+          oPropertyPaths->emplace_back(std::move(path));
+        }
+        break;
+      }
+
+      case Record::kState:
+      case Record::kStore:
+      {
+        auto id = reader.read<TJBox_UInt32>();
+        RE_MOCK_ASSERT(id < propertyPaths.size(), "Invalid property id [%d] in recording", id);
+        auto atFrameIndex = reader.read<TJBox_UInt16>();
+        auto value = readValue(reader);
+        if(iHandler.fOnStore)
+          iHandler.fOnStore(id, value, atFrameIndex, record == Record::kState);
+        break;
+      }
+
+      case Record::kAudio:
+      {
+        auto id = reader.read<TJBox_UInt32>();
+        RE_MOCK_ASSERT(id < propertyPaths.size(), "Invalid property id [%d] in recording", id);
+        reader.read(buffer.data(), buffer.size() * sizeof(TJBox_AudioSample));
+        if(iHandler.fOnAudio)
+          iHandler.fOnAudio(id, buffer);
+        break;
+      }
+
+      case Record::kBatch:
+        if(oBatchCount)
+          (*oBatchCount)++;
+        if(iHandler.fOnBatch)
+          iHandler.fOnBatch();
+        break;
+
+      default:
+        RE_MOCK_FAIL("Invalid record [%d] in recording", static_cast<int>(record));
+    }
+  }
+}
+
+}
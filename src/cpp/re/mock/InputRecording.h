@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_input_recording_h__
+#define __Pongasoft_re_mock_input_recording_h__
+
+#include <JukeboxTypes.h>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BinaryStream.h"
+#include "Config.h"
+#include "MotherboardImpl.h"
+
+namespace re::mock {
+
+/**
+ * A recording of the inputs a device receives from the host, batch by batch: every property stored outside of the
+ * device rendering (transport, notes, cv values, properties changed by the rtc bindings, by the test...) and the
+ * content of its audio inputs. Replaying it into a fresh instance of the same device
+ * (see `rack::Extension::replayInputs()`) feeds the device exactly what it received, without running the rest of
+ * the rack, the sequencer or the realtime controller bindings, which makes it a minimal repro to profile the device
+ * on its own.
+ *
+ * Only the values which can be serialized are recorded (nil, number, boolean, incompatible and strings): native
+ * objects, blobs and samples are not (a fresh device creates its own native objects when instantiated).
+ *
+ * The values the device had when the recording started (`Record::kState`) were delivered to the recorded device
+ * before the recording (or never, for its defaults). A fresh device has to catch up: the ones which differ from its
+ * defaults are stored at the beginning of the replay and therefore delivered as diffs on the first replayed batch,
+ * which is the only batch whose diffs differ from the ones the recorded device received.
+ *
+ * Binary format (see `BinaryWriter`):
+ *
+ * - header: `REMI` + version (`UInt32`)
+ * - a sequence of records, each starting with its type (`UInt8`, see `Record`)
+ *   - `kProperty`: id (`UInt32`), path (`UInt32` size + chars); declares a property the first time it is used
+ *   - `kState` / `kStore`: property id (`UInt32`), frame index (`UInt16`), value type (`UInt8`) + value
+ *   - `kAudio`: property id (`UInt32`) of the audio input buffer, 64 samples (`Float32`)
+ *   - `kBatch`: end of batch (the device renders) */
+class InputRecording
+{
+public:
+  constexpr static TJBox_UInt32 kVersion = 1;
+
+  enum class Record : TJBox_UInt8
+  {
+    kProperty = 1,
+    kState    = 2, // value when the recording started
+    kStore    = 3,
+    kAudio    = 4,
+    kBatch    = 5
+  };
+
+  struct Value
+  {
+    TJBox_ValueType fType{kJBox_Nil};
+    TJBox_Float64 fNumber{};
+    bool fBoolean{};
+    int fMaxSize{}; // strings only (> 0 for an RT string)
+    std::string fString{};
+  };
+
+  /**
+   * Writes a recording: owned by the motherboard while recording (see `Motherboard::startInputRecording()`). Each
+   * batch is buffered in memory and written to the file at the end of the batch. */
+  class Writer
+  {
+  public:
+    explicit Writer(std::string iFilePath);
+    ~Writer();
+
+    //! Records the content of this audio input buffer (if not silent) at the end of every batch
+    void addAudioInput(impl::JboxProperty const *iBufferProperty);
+
+    //! Records the current value of the property (when the recording starts)
+    void state(impl::JboxProperty const &iProperty);
+
+    //! Records a store (ignored when the value cannot be recorded)
+    void store(impl::JboxProperty const &iProperty, JboxValue const &iValue, TJBox_UInt16 iAtFrameIndex);
+
+    //! Records the audio inputs and the end of the batch
+    void nextBatch();
+
+    size_t getBatchCount() const { return fBatchCount; }
+    std::string const &getFilePath() const { return fFilePath; }
+
+  private:
+    void write(Record iRecord, impl::JboxProperty const &iProperty, JboxValue const &iValue, TJBox_UInt16 iAtFrameIndex);
+    TJBox_UInt32 getPropertyId(impl::JboxProperty const &iProperty);
+
+  private:
+    std::string fFilePath;
+    std::ofstream fStream;
+    BinaryWriter fBuffer; // current batch
+    std::map<impl::JboxProperty const *, TJBox_UInt32> fPropertyIds{};
+    std::vector<impl::JboxProperty const *> fAudioInputs{};
+    size_t fBatchCount{};
+  };
+
+  //! Callbacks invoked by `replay()` in the order of the recording
+  struct Handler
+  {
+    std::function<void(TJBox_UInt32 iPropertyId, Value const &iValue, TJBox_UInt16 iAtFrameIndex, bool iState)> fOnStore{};
+    std::function<void(TJBox_UInt32 iPropertyId, impl::DSPBuffer const &iBuffer)> fOnAudio{};
+    std::function<void()> fOnBatch{};
+  };
+
+public:
+  //! Returns `true` if the value can be recorded
+  static bool isRecordable(JboxValue const &iValue);
+
+  /**
+   * Loads a recording: the file is read at once and validated, the records are decoded when replayed.
+   *
+   * @throw Exception if the file cannot be read or is not a (compatible) recording */
+  static std::unique_ptr<InputRecording> load(std::string const &iFilePath);
+
+  //! Number of batches recorded
+  size_t getBatchCount() const { return fBatchCount; }
+
+  //! The properties used by the recording (indexed by property id)
+  std::vector<std::string> const &getPropertyPaths() const { return fPropertyPaths; }
+
+  //! Decodes the records and invokes the handler for each of them
+  void replay(Handler const &iHandler) const;
+
+private:
+  explicit InputRecording(BinaryReader iRecords) : fRecords{std::move(iRecords)} {}
+
+  void decode(Handler const &iHandler, std::vector<std::string> *oPropertyPaths, size_t *oBatchCount) const;
+
+  BinaryReader fRecords; // positioned on the first record
+  size_t fBatchCount{};
+  std::vector<std::string> fPropertyPaths{};
+};
+
+}
+
+#endif //__Pongasoft_re_mock_input_recording_h__
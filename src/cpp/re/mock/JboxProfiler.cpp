@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "JboxProfiler.h"
+#include "Errors.h"
+#include "fmt.h"
+#include <algorithm>
+
+namespace re::mock {
+
+//------------------------------------------------------------------------
+// JboxProfiler::getFunctionName
+//------------------------------------------------------------------------
+char const *JboxProfiler::getFunctionName(Function iFunction)
+{
+  switch(iFunction)
+  {
+    case Function::kGetMotherboardObjectRef: return "JBox_GetMotherboardObjectRef";
+    case Function::kGetPropertyTag: return "JBox_GetPropertyTag";
+    case Function::kFindPropertyByTag: return "JBox_FindPropertyByTag";
+    case Function::kLoadMOMProperty: return "JBox_LoadMOMProperty";
+    case Function::kLoadMOMPropertyByTag: return "JBox_LoadMOMPropertyByTag";
+    case Function::kLoadMOMPropertyAsNumber: return "JBox_LoadMOMPropertyAsNumber";
+    case Function::kStoreMOMProperty: return "JBox_StoreMOMProperty";
+    case Function::kStoreMOMPropertyByTag: return "JBox_StoreMOMPropertyByTag";
+    case Function::kStoreMOMPropertyAsNumber: return "JBox_StoreMOMPropertyAsNumber";
+    case Function::kGetDSPBufferData: return "JBox_GetDSPBufferData";
+    case Function::kGetDSPBufferInfo: return "JBox_GetDSPBufferInfo";
+    case Function::kSetDSPBufferData: return "JBox_SetDSPBufferData";
+    case Function::kTrace: return "JBox_Trace";
+    case Function::kTraceValues: return "JBox_TraceValues";
+    case Function::kGetStringLength: return "JBox_GetStringLength";
+    case Function::kGetSubstring: return "JBox_GetSubstring";
+    case Function::kGetNativeObjectRO: return "JBox_GetNativeObjectRO";
+    case Function::kGetNativeObjectRW: return "JBox_GetNativeObjectRW";
+    case Function::kGetSampleInfo: return "JBox_GetSampleInfo";
+    case Function::kGetSampleMetaData: return "JBox_GetSampleMetaData";
+    case Function::kGetSampleData: return "JBox_GetSampleData";
+    case Function::kGetBLOBInfo: return "JBox_GetBLOBInfo";
+    case Function::kGetBLOBData: return "JBox_GetBLOBData";
+    case Function::kSetRTStringData: return "JBox_SetRTStringData";
+    case Function::kOutputNoteEvent: return "JBox_OutputNoteEvent";
+    case Function::kAsNoteEvent: return "JBox_AsNoteEvent";
+    default:
+      RE_MOCK_ASSERT(false, "unknown function %d", static_cast<int>(iFunction));
+      return "";
+  }
+}
+
+//------------------------------------------------------------------------
+// JboxProfiler::Snapshot::toString
+//------------------------------------------------------------------------
+std::string JboxProfiler::Snapshot::toString() const
+{
+  std::vector<size_t> functions{};
+  for(size_t i = 0; i < kFunctionCount; i++)
+  {
+    if(fCounters[i].fCallCount > 0)
+      functions.emplace_back(i);
+  }
+
+  // most expensive first
+  std::stable_sort(functions.begin(), functions.end(), [this](auto const &l, auto const &r) {
+    return fCounters[l].fDuration > fCounters[r].fDuration;
+  });
+
+  auto batchCount = static_cast<double>(std::max<size_t>(fBatchCount, 1));
+
+  std::string res = fmt::printf("%-30s %12s %12s %12s %16s %12s\n",
+                                "JBox api", "calls", "calls/batch", "time (us)", "time/batch (us)", "bytes/batch");
+
+  for(auto i: functions)
+  {
+    auto const &counter = fCounters[i];
+    auto us = std::chrono::duration<double, std::micro>(counter.fDuration).count();
+    res += fmt::printf("%-30s %12ld %12.1f %12.1f %16.3f %12.0f\n",
+                       getFunctionName(static_cast<Function>(i)),
+                       counter.fCallCount,
+                       counter.fCallCount / batchCount,
+                       us,
+                       us / batchCount,
+                       counter.fByteCount / batchCount);
+  }
+
+  res += fmt::printf("(%ld batches)\n", fBatchCount);
+
+  return res;
+}
+
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_jbox_profiler_h__
+#define __Pongasoft_re_mock_jbox_profiler_h__
+
+#include <JukeboxTypes.h>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace re::mock {
+
+/**
+ * Opt-in instrumentation of the `JBox_xxx` api: counts the calls, the accumulated time and the amount of data
+ * transferred (for the apis copying data, like `JBox_GetSampleData`) per function. There is one profiler per
+ * device (motherboard) which is only allocated when enabled (see `rack::Extension::enableJboxProfiler()`).
+ *
+ * Only the apis which go through the motherboard are profiled (pure value manipulation apis like
+ * `JBox_MakeNumber` or `JBox_GetNumber` are not). */
+class JboxProfiler
+{
+public:
+  enum class Function : int
+  {
+    kGetMotherboardObjectRef,
+    kGetPropertyTag,
+    kFindPropertyByTag,
+    kLoadMOMProperty,
+    kLoadMOMPropertyByTag,
+    kLoadMOMPropertyAsNumber,
+    kStoreMOMProperty,
+    kStoreMOMPropertyByTag,
+    kStoreMOMPropertyAsNumber,
+    kGetDSPBufferData,
+    kGetDSPBufferInfo,
+    kSetDSPBufferData,
+    kTrace,
+    kTraceValues,
+    kGetStringLength,
+    kGetSubstring,
+    kGetNativeObjectRO,
+    kGetNativeObjectRW,
+    kGetSampleInfo,
+    kGetSampleMetaData,
+    kGetSampleData,
+    kGetBLOBInfo,
+    kGetBLOBData,
+    kSetRTStringData,
+    kOutputNoteEvent,
+    kAsNoteEvent,
+    kCount // number of entries (must be last)
+  };
+
+  constexpr static auto kFunctionCount = static_cast<size_t>(Function::kCount);
+
+  //! Returns the name of the JBox api (ex: `JBox_LoadMOMPropertyByTag`)
+  static char const *getFunctionName(Function iFunction);
+
+  struct Counter
+  {
+    size_t fCallCount{};
+    std::chrono::nanoseconds fDuration{};
+    size_t fByteCount{};
+  };
+
+  struct Snapshot
+  {
+    size_t fBatchCount{};
+    std::array<Counter, kFunctionCount> fCounters{};
+
+    Counter const &get(Function iFunction) const { return fCounters[static_cast<size_t>(iFunction)]; }
+
+    /**
+     * Returns a report (one line per api called, sorted by total time), for example:
+     *
+     * ```
+     * JBox api                          calls  calls/batch    time (us)  time/batch (us)  bytes/batch
+     * JBox_LoadMOMPropertyByTag        400000       4000.0      12000.0            120.0            0
+     * ```
+     */
+    std::string toString() const;
+  };
+
+  /**
+   * RAII class measuring one call (does nothing when the profiler is `nullptr`, which is the case when profiling
+   * is disabled) */
+  class Scope
+  {
+  public:
+    Scope(JboxProfiler *iProfiler, Function iFunction, size_t iByteCount = 0) :
+      fProfiler{iProfiler},
+      fFunction{iFunction},
+      fByteCount{iByteCount},
+      fStart{iProfiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}}
+    {}
+
+    ~Scope()
+    {
+      if(fProfiler)
+        fProfiler->record(fFunction, std::chrono::steady_clock::now() - fStart, fByteCount);
+    }
+
+  private:
+    JboxProfiler *fProfiler;
+    Function fFunction;
+    size_t fByteCount;
+    std::chrono::steady_clock::time_point fStart;
+  };
+
+public:
+  void record(Function iFunction, std::chrono::nanoseconds iDuration, size_t iByteCount)
+  {
+    auto &counter = fSnapshot.fCounters[static_cast<size_t>(iFunction)];
+    counter.fCallCount++;
+    counter.fDuration += iDuration;
+    counter.fByteCount += iByteCount;
+  }
+
+  void nextBatch() { fSnapshot.fBatchCount++; }
+
+  Snapshot const &getSnapshot() const { return fSnapshot; }
+
+  void reset() { fSnapshot = {}; }
+
+private:
+  Snapshot fSnapshot{};
+};
+
+}
+
+// unique (per line) names for the variables declared by the macros below
+#define RE_MOCK_JBOX_PROFILE_CONCAT_IMPL(a, b) a##b
+#define RE_MOCK_JBOX_PROFILE_CONCAT(a, b) RE_MOCK_JBOX_PROFILE_CONCAT_IMPL(a, b)
+#define RE_MOCK_JBOX_PROFILE_VAR(name) RE_MOCK_JBOX_PROFILE_CONCAT(reMockJbox##name##_, __LINE__)
+
+//! Profiles the current JBox api call (`function` is the name without the `JBox_` prefix)
+#define RE_MOCK_JBOX_PROFILE(motherboard, function) \
+  re::mock::JboxProfiler::Scope RE_MOCK_JBOX_PROFILE_VAR(ProfilerScope){(motherboard).getJboxProfiler(), re::mock::JboxProfiler::Function::k##function}
+
+//! Profiles the current JBox api call and the number of bytes it transfers (only evaluated when profiling)
+#define RE_MOCK_JBOX_PROFILE_BYTES(motherboard, function, bytes) \
+  auto RE_MOCK_JBOX_PROFILE_VAR(Profiler) = (motherboard).getJboxProfiler(); \
+  re::mock::JboxProfiler::Scope RE_MOCK_JBOX_PROFILE_VAR(ProfilerScope){RE_MOCK_JBOX_PROFILE_VAR(Profiler), \
+                                                                       re::mock::JboxProfiler::Function::k##function, \
+                                                                       RE_MOCK_JBOX_PROFILE_VAR(Profiler) ? static_cast<size_t>(bytes) : 0}
+
+#endif //__Pongasoft_re_mock_jbox_profiler_h__
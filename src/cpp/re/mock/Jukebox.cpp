@@ -22,6 +22,7 @@
 #include "MockJukebox.h"
 #include "Rack.h"
 #include "fft.h"
+#include "JboxProfiler.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -71,17 +72,23 @@ TJBox_PropertyRef JBox_MakePropertyRef(TJBox_ObjectRef iObject, const TJBox_Prop
 
 TJBox_ObjectRef JBox_GetMotherboardObjectRef(const TJBox_ObjectName iMOMPath)
 {
-  return re::mock::Rack::currentMotherboard().getObjectRef(iMOMPath);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetMotherboardObjectRef);
+  return motherboard.getObjectRef(iMOMPath);
 }
 
 TJBox_Tag JBox_GetPropertyTag(TJBox_PropertyRef iProperty)
 {
-  return re::mock::Rack::currentMotherboard().getPropertyTag(iProperty);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetPropertyTag);
+  return motherboard.getPropertyTag(iProperty);
 }
 
 TJBox_PropertyRef JBox_FindPropertyByTag(TJBox_ObjectRef iObject, TJBox_Tag iTag)
 {
-  return re::mock::Rack::currentMotherboard().getPropertyRef(iObject, iTag);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, FindPropertyByTag);
+  return motherboard.getPropertyRef(iObject, iTag);
 }
 
 TJBox_Bool JBox_IsReferencingSameProperty(TJBox_PropertyRef iProperty1, TJBox_PropertyRef iProperty2)
@@ -92,43 +99,59 @@ TJBox_Bool JBox_IsReferencingSameProperty(TJBox_PropertyRef iProperty1, TJBox_Pr
 
 TJBox_Value JBox_LoadMOMProperty(TJBox_PropertyRef iProperty)
 {
-  return re::mock::Rack::currentMotherboard().loadProperty(iProperty);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, LoadMOMProperty);
+  return motherboard.loadProperty(iProperty);
 }
 
 TJBox_Value JBox_LoadMOMPropertyByTag(TJBox_ObjectRef iObject, TJBox_Tag iTag)
 {
-  return re::mock::Rack::currentMotherboard().loadProperty(iObject, iTag);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, LoadMOMPropertyByTag);
+  return motherboard.loadProperty(iObject, iTag);
 }
 
 TJBox_Float64 JBox_LoadMOMPropertyAsNumber(TJBox_ObjectRef iObject, TJBox_Tag iTag)
 {
-  return JBox_GetNumber(JBox_LoadMOMPropertyByTag(iObject, iTag));
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, LoadMOMPropertyAsNumber);
+  return JBox_GetNumber(motherboard.loadProperty(iObject, iTag));
 }
 
 void JBox_StoreMOMProperty(TJBox_PropertyRef iProperty, TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().storeProperty(iProperty, iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, StoreMOMProperty);
+  return motherboard.storeProperty(iProperty, iValue);
 }
 
 void JBox_StoreMOMPropertyByTag(TJBox_ObjectRef iObject, TJBox_Tag iTag, TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().storeProperty(iObject, iTag, iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, StoreMOMPropertyByTag);
+  return motherboard.storeProperty(iObject, iTag, iValue);
 }
 
 void JBox_StoreMOMPropertyAsNumber(TJBox_ObjectRef iObject, TJBox_Tag iTag,TJBox_Float64 iValue)
 {
-  JBox_StoreMOMPropertyByTag(iObject, iTag, JBox_MakeNumber(iValue));
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, StoreMOMPropertyAsNumber);
+  motherboard.storeProperty(iObject, iTag, JBox_MakeNumber(iValue));
 }
 
 void JBox_GetDSPBufferData(TJBox_Value iValue, TJBox_AudioFramePos iStartFrame, TJBox_AudioFramePos iEndFrame,
                            TJBox_AudioSample oAudio[])
 {
-  return re::mock::Rack::currentMotherboard().getDSPBufferData(iValue, iStartFrame, iEndFrame, oAudio);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE_BYTES(motherboard, GetDSPBufferData, (iEndFrame - iStartFrame) * sizeof(TJBox_AudioSample));
+  return motherboard.getDSPBufferData(iValue, iStartFrame, iEndFrame, oAudio);
 }
 
 TJBox_DSPBufferInfo JBox_GetDSPBufferInfo(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getDSPBufferInfo(iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetDSPBufferInfo);
+  return motherboard.getDSPBufferInfo(iValue);
 }
 
 void JBox_SetDSPBufferData(TJBox_Value iValue,
@@ -136,7 +159,9 @@ void JBox_SetDSPBufferData(TJBox_Value iValue,
                            TJBox_AudioFramePos iEndFrame,
                            const TJBox_AudioSample iAudio[])
 {
-  return re::mock::Rack::currentMotherboard().setDSPBufferData(iValue, iStartFrame, iEndFrame, iAudio);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE_BYTES(motherboard, SetDSPBufferData, (iEndFrame - iStartFrame) * sizeof(TJBox_AudioSample));
+  return motherboard.setDSPBufferData(iValue, iStartFrame, iEndFrame, iAudio);
 }
 
 void JBox_Assert(const char iFile[], TJBox_Int32 iLine, const char iFailedExpression[], const char iMessage[])
@@ -150,7 +175,9 @@ void JBox_Trace(
   TJBox_Int32 iLine,
   const char iMessage[])
 {
-  return re::mock::Rack::currentMotherboard().trace(iFile, iLine, iMessage);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, Trace);
+  return motherboard.trace(iFile, iLine, iMessage);
 }
 
 void JBox_TraceValues(
@@ -160,19 +187,16 @@ void JBox_TraceValues(
   const TJBox_Value iValues[],
   TJBox_Int32 iValueCount)
 {
-  std::vector<std::string> values{};
-  auto const &motherboard = re::mock::Rack::currentMotherboard();
-  values.reserve(iValueCount);
-  for(int i = 0; i < iValueCount; i++)
-    values.emplace_back(motherboard.toString(iValues[i]));
-  std::string buf{};
-  re::mock::fmt::impl::printf(iTemplate, values, std::back_inserter(buf));
-  JBox_Trace(iFile, iLine, buf.c_str());
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, TraceValues);
+  motherboard.traceValues(iFile, iLine, iTemplate, iValues, iValueCount);
 }
 
 TJBox_UInt32 JBox_GetStringLength(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getStringLength(iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetStringLength);
+  return motherboard.getStringLength(iValue);
 }
 
 void JBox_GetSubstring(
@@ -181,28 +205,38 @@ void JBox_GetSubstring(
   TJBox_SizeT iEnd,
   char oString[])
 {
-  return re::mock::Rack::currentMotherboard().getSubstring(iValue, iStart, iEnd, oString);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE_BYTES(motherboard, GetSubstring, iEnd - iStart);
+  return motherboard.getSubstring(iValue, iStart, iEnd, oString);
 }
 
 
 const void *JBox_GetNativeObjectRO(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getNativeObjectRO(iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetNativeObjectRO);
+  return motherboard.getNativeObjectRO(iValue);
 }
 
 void *JBox_GetNativeObjectRW(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getNativeObjectRW(iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetNativeObjectRW);
+  return motherboard.getNativeObjectRW(iValue);
 }
 
 TJBox_SampleInfo JBox_GetSampleInfo(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getSampleInfo(iValue);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetSampleInfo);
+  return motherboard.getSampleInfo(iValue);
 }
 
 TJBox_SampleMetaData JBox_GetSampleMetaData(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getSampleMetadata(iValue).fMain;
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetSampleMetaData);
+  return motherboard.getSampleMetadata(iValue).fMain;
 }
 
 void JBox_GetSampleData(
@@ -211,12 +245,20 @@ void JBox_GetSampleData(
   TJBox_AudioFramePos iEndFrame,
   TJBox_AudioSample oAudio[])
 {
-  return re::mock::Rack::currentMotherboard().getSampleData(iValue, iStartFrame, iEndFrame, oAudio);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  // the sample is resolved before the call is timed (only when profiling) since the byte count depends on its channels
+  RE_MOCK_JBOX_PROFILE_BYTES(motherboard, GetSampleData,
+                             iEndFrame > iStartFrame ?
+                             (iEndFrame - iStartFrame) * motherboard.getSampleInfo(iValue).fChannels * sizeof(TJBox_AudioSample) :
+                             0);
+  return motherboard.getSampleData(iValue, iStartFrame, iEndFrame, oAudio);
 }
 
 TJBox_BLOBInfo JBox_GetBLOBInfo(TJBox_Value iValue)
 {
-  return re::mock::Rack::currentMotherboard().getBLOBInfo(iValue).to_TJBox_BLOBInfo();
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, GetBLOBInfo);
+  return motherboard.getBLOBInfo(iValue).to_TJBox_BLOBInfo();
 }
 
 void JBox_GetBLOBData(
@@ -225,22 +267,30 @@ void JBox_GetBLOBData(
   TJBox_SizeT iEnd,
   TJBox_UInt8 oData[])
 {
-  return re::mock::Rack::currentMotherboard().getBLOBData(iValue, iStart, iEnd, oData);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE_BYTES(motherboard, GetBLOBData, (iEnd - iStart) * sizeof(TJBox_UInt8));
+  return motherboard.getBLOBData(iValue, iStart, iEnd, oData);
 }
 
 void JBox_SetRTStringData(TJBox_PropertyRef iProperty, TJBox_SizeT iSize, const TJBox_UInt8 iData[])
 {
-  return re::mock::Rack::currentMotherboard().setRTStringData(iProperty, iSize, iData);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE_BYTES(motherboard, SetRTStringData, iSize);
+  return motherboard.setRTStringData(iProperty, iSize, iData);
 }
 
 void JBox_OutputNoteEvent(TJBox_NoteEvent iNoteEvent)
 {
-  return re::mock::Rack::currentMotherboard().outputNoteEvent(iNoteEvent);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, OutputNoteEvent);
+  return motherboard.outputNoteEvent(iNoteEvent);
 }
 
 TJBox_NoteEvent JBox_AsNoteEvent(const TJBox_PropertyDiff &iPropertyDiff)
 {
-  return re::mock::Rack::currentMotherboard().asNoteEvent(iPropertyDiff);
+  auto &motherboard = re::mock::Rack::currentMotherboard();
+  RE_MOCK_JBOX_PROFILE(motherboard, AsNoteEvent);
+  return motherboard.asNoteEvent(iPropertyDiff);
 }
 
 TJBox_Int32 JBox_GetOptimalFFTAlignment()
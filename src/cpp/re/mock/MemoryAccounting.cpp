@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "MemoryAccounting.h"
+#include "Errors.h"
+#include "fmt.h"
+#include <sstream>
+
+namespace re::mock {
+
+//------------------------------------------------------------------------
+// MemoryCounter::allocate
+//------------------------------------------------------------------------
+void MemoryCounter::allocate(std::size_t iBytes) noexcept
+{
+  auto const bytes = fBytes.fetch_add(iBytes, std::memory_order_relaxed) + iBytes;
+  fAllocationCount.fetch_add(1, std::memory_order_relaxed);
+  auto peak = fPeakBytes.load(std::memory_order_relaxed);
+  while(bytes > peak && !fPeakBytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+}
+
+//------------------------------------------------------------------------
+// MemoryCharge::MemoryCharge
+//------------------------------------------------------------------------
+MemoryCharge::MemoryCharge(std::shared_ptr<MemoryCounter> iCounter, std::size_t iBytes) noexcept :
+  fCounter{std::move(iCounter)}
+{
+  update(iBytes);
+}
+
+//------------------------------------------------------------------------
+// MemoryCharge::MemoryCharge (move)
+//------------------------------------------------------------------------
+MemoryCharge::MemoryCharge(MemoryCharge &&iOther) noexcept :
+  fCounter{std::move(iOther.fCounter)},
+  fBytes{iOther.fBytes}
+{
+  iOther.fBytes = 0;
+}
+
+//------------------------------------------------------------------------
+// MemoryCharge::operator=
+//------------------------------------------------------------------------
+MemoryCharge &MemoryCharge::operator=(MemoryCharge &&iOther) noexcept
+{
+  if(this != &iOther)
+  {
+    update(0);
+    fCounter = std::move(iOther.fCounter);
+    fBytes = iOther.fBytes;
+    iOther.fBytes = 0;
+  }
+  return *this;
+}
+
+//------------------------------------------------------------------------
+// MemoryCharge::update
+//------------------------------------------------------------------------
+void MemoryCharge::update(std::size_t iBytes) noexcept
+{
+  if(fCounter)
+  {
+    if(iBytes > fBytes)
+      fCounter->allocate(iBytes - fBytes);
+    else
+      fCounter->deallocate(fBytes - iBytes);
+  }
+  fBytes = iBytes;
+}
+
+//------------------------------------------------------------------------
+// MemoryReport::Entry::operator+=
+//------------------------------------------------------------------------
+MemoryReport::Entry &MemoryReport::Entry::operator+=(Entry const &iOther)
+{
+  fBytes += iOther.fBytes;
+  fPeakBytes += iOther.fPeakBytes;
+  fAllocationCount += iOther.fAllocationCount;
+  return *this;
+}
+
+//------------------------------------------------------------------------
+// MemoryReport::getTotalBytes
+//------------------------------------------------------------------------
+std::size_t MemoryReport::getTotalBytes() const
+{
+  std::size_t res{};
+  for(auto const &entry: fEntries)
+    res += entry.fBytes;
+  return res;
+}
+
+//------------------------------------------------------------------------
+// MemoryReport::operator+=
+//------------------------------------------------------------------------
+MemoryReport &MemoryReport::operator+=(MemoryReport const &iOther)
+{
+  for(std::size_t i = 0; i < kSubsystemCount; i++)
+    fEntries[i] += iOther.fEntries[i];
+  return *this;
+}
+
+//------------------------------------------------------------------------
+// MemoryReport::getSubsystemName
+//------------------------------------------------------------------------
+char const *MemoryReport::getSubsystemName(Subsystem iSubsystem)
+{
+  switch(iSubsystem)
+  {
+    case Subsystem::kPropertyStore:
+      return "property_store";
+    case Subsystem::kJboxValues:
+      return "jbox_values";
+    case Subsystem::kDSPBuffers:
+      return "dsp_buffers";
+    case Subsystem::kSampleData:
+      return "sample_data";
+    case Subsystem::kBlobData:
+      return "blob_data";
+    case Subsystem::kLuaHeap:
+      return "lua_heap";
+    case Subsystem::kSequencerEvents:
+      return "sequencer_events";
+    case Subsystem::kTimelineEvents:
+      return "timeline_events";
+    case Subsystem::kCapturedSamples:
+      return "captured_samples";
+  }
+  RE_MOCK_FAIL("Unknown subsystem [%d]", static_cast<int>(iSubsystem));
+}
+
+//------------------------------------------------------------------------
+// MemoryReport::toString
+//------------------------------------------------------------------------
+std::string MemoryReport::toString() const
+{
+  std::ostringstream s{};
+  for(std::size_t i = 0; i < kSubsystemCount; i++)
+  {
+    auto const &entry = fEntries[i];
+    s << fmt::printf("%-16s %10ld bytes (peak %10ld, %8ld allocations)\n",
+                     getSubsystemName(static_cast<Subsystem>(i)),
+                     static_cast<long>(entry.fBytes),
+                     static_cast<long>(entry.fPeakBytes),
+                     static_cast<long>(entry.fAllocationCount));
+  }
+  s << fmt::printf("%-16s %10ld bytes", "total", static_cast<long>(getTotalBytes()));
+  return s.str();
+}
+
+//------------------------------------------------------------------------
+// MemoryAccounting::MemoryAccounting
+//------------------------------------------------------------------------
+MemoryAccounting::MemoryAccounting()
+{
+  for(auto &counter: fCounters)
+    counter = std::make_shared<MemoryCounter>();
+}
+
+//------------------------------------------------------------------------
+// MemoryAccounting::report
+//------------------------------------------------------------------------
+MemoryReport MemoryAccounting::report() const
+{
+  MemoryReport res{};
+  for(std::size_t i = 0; i < MemoryReport::kSubsystemCount; i++)
+  {
+    auto const &counter = *fCounters[i];
+    res.fEntries[i] = {
+      /* .fBytes = */           counter.getBytes(),
+      /* .fPeakBytes = */       counter.getPeakBytes(),
+      /* .fAllocationCount = */ counter.getAllocationCount()
+    };
+  }
+  return res;
+}
+
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_memory_accounting_h__
+#define __Pongasoft_re_mock_memory_accounting_h__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace re::mock {
+
+/**
+ * Keeps track of the memory allocated through a `CountingAllocator` (or charged with a `MemoryCharge`). The counter
+ * can be shared by many allocators (and threads since racks can be built concurrently). */
+class MemoryCounter
+{
+public:
+  void allocate(std::size_t iBytes) noexcept;
+  void deallocate(std::size_t iBytes) noexcept { fBytes.fetch_sub(iBytes, std::memory_order_relaxed); }
+
+  //! Number of bytes currently allocated
+  std::size_t getBytes() const noexcept { return fBytes.load(std::memory_order_relaxed); }
+
+  //! Maximum number of bytes allocated at any given time
+  std::size_t getPeakBytes() const noexcept { return fPeakBytes.load(std::memory_order_relaxed); }
+
+  //! Number of allocations (or reallocations) since the counter was created
+  std::size_t getAllocationCount() const noexcept { return fAllocationCount.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<std::size_t> fBytes{};
+  std::atomic<std::size_t> fPeakBytes{};
+  std::atomic<std::size_t> fAllocationCount{};
+};
+
+/**
+ * Allocator (usable with any standard container) which delegates to `Base` and reports every allocation to a (shared)
+ * `MemoryCounter`. A default constructed allocator (no counter) does not count anything.
+ *
+ * The allocator stays with the container on copy/move assignment so that the memory is always reported to the owner
+ * of the container (ex: a sequencer track assigned from a snapshot). */
+template<typename T, typename Base = std::allocator<T>>
+class CountingAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::false_type;
+  using propagate_on_container_swap = std::true_type; // swapping storage requires swapping the allocators
+
+  template<typename U>
+  struct rebind { using other = CountingAllocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>>; };
+
+  CountingAllocator() noexcept = default;
+
+  explicit CountingAllocator(std::shared_ptr<MemoryCounter> iCounter, Base const &iBase = {}) noexcept :
+    fBase{iBase}, fCounter{std::move(iCounter)} {}
+
+  template<typename U, typename UBase>
+  CountingAllocator(CountingAllocator<U, UBase> const &iOther) noexcept :
+    fBase{iOther.getBase()}, fCounter{iOther.getCounter()} {}
+
+  T *allocate(std::size_t n)
+  {
+    auto res = std::allocator_traits<Base>::allocate(fBase, n);
+    if(fCounter)
+      fCounter->allocate(n * sizeof(T));
+    return res;
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept
+  {
+    if(fCounter)
+      fCounter->deallocate(n * sizeof(T));
+    std::allocator_traits<Base>::deallocate(fBase, p, n);
+  }
+
+  Base const &getBase() const noexcept { return fBase; }
+  std::shared_ptr<MemoryCounter> const &getCounter() const noexcept { return fCounter; }
+
+  template<typename U, typename UBase>
+  bool operator==(CountingAllocator<U, UBase> const &iOther) const noexcept
+  {
+    return fCounter == iOther.getCounter() && fBase == iOther.getBase();
+  }
+
+  template<typename U, typename UBase>
+  bool operator!=(CountingAllocator<U, UBase> const &iOther) const noexcept { return !(*this == iOther); }
+
+private:
+  Base fBase{};
+  std::shared_ptr<MemoryCounter> fCounter{};
+};
+
+//! `std::vector` whose storage is reported to a `MemoryCounter`
+template<typename T>
+using counted_vector = std::vector<T, CountingAllocator<T>>;
+
+//! Deleter of the objects created by `allocate_unique()`
+template<typename T>
+struct CountingDeleter
+{
+  std::shared_ptr<MemoryCounter> fCounter{};
+
+  void operator()(T *iPtr) const noexcept
+  {
+    CountingAllocator<T> allocator{fCounter};
+    std::allocator_traits<CountingAllocator<T>>::destroy(allocator, iPtr);
+    std::allocator_traits<CountingAllocator<T>>::deallocate(allocator, iPtr, 1);
+  }
+};
+
+//! `std::unique_ptr` whose storage is reported to a `MemoryCounter`
+template<typename T>
+using counted_unique_ptr = std::unique_ptr<T, CountingDeleter<T>>;
+
+//! Equivalent of `std::make_unique` where the storage is reported to `iCounter`
+template<typename T, typename... Args>
+counted_unique_ptr<T> allocate_unique(std::shared_ptr<MemoryCounter> const &iCounter, Args &&... iArgs)
+{
+  CountingAllocator<T> allocator{iCounter};
+  auto ptr = std::allocator_traits<CountingAllocator<T>>::allocate(allocator, 1);
+  try
+  {
+    std::allocator_traits<CountingAllocator<T>>::construct(allocator, ptr, std::forward<Args>(iArgs)...);
+  }
+  catch(...)
+  {
+    std::allocator_traits<CountingAllocator<T>>::deallocate(allocator, ptr, 1);
+    throw;
+  }
+  return counted_unique_ptr<T>{ptr, CountingDeleter<T>{iCounter}};
+}
+
+/**
+ * Memory which is allocated elsewhere (ex: sample data loaded from a file) and then handed over to a device cannot go
+ * through a `CountingAllocator`: instead it is "charged" to the counter for as long as this object lives. */
+class MemoryCharge
+{
+public:
+  MemoryCharge() noexcept = default;
+  explicit MemoryCharge(std::shared_ptr<MemoryCounter> iCounter, std::size_t iBytes = 0) noexcept;
+  MemoryCharge(MemoryCharge &&iOther) noexcept;
+  MemoryCharge(MemoryCharge const &) = delete;
+  ~MemoryCharge() { update(0); }
+
+  MemoryCharge &operator=(MemoryCharge &&iOther) noexcept;
+  MemoryCharge &operator=(MemoryCharge const &) = delete;
+
+  //! Changes the amount of memory charged to the counter (a growth counts as an allocation)
+  void update(std::size_t iBytes) noexcept;
+
+  std::size_t getBytes() const noexcept { return fBytes; }
+
+private:
+  std::shared_ptr<MemoryCounter> fCounter{};
+  std::size_t fBytes{};
+};
+
+/**
+ * Breakdown (by subsystem) of the memory used by a device, as measured by the counting allocators (see
+ * `Motherboard::memoryReport()`). */
+struct MemoryReport
+{
+  enum class Subsystem : int
+  {
+    kPropertyStore,     // objects, property definitions and (materialised) properties
+    kJboxValues,        // values (numbers, strings, native objects...) stored in the properties
+    kDSPBuffers,        // audio socket buffers
+    kSampleData,        // frames of the samples loaded by the device
+    kBlobData,          // bytes of the blobs loaded by the device
+    kLuaHeap,           // lua heap of the realtime controller (and motherboard definition while being loaded)
+    kSequencerEvents,   // events, notes and automation of the sequencer track
+    kTimelineEvents,    // events of the tester timelines
+    kCapturedSamples    // samples captured by `MAUDst`
+  };
+
+  constexpr static std::size_t kSubsystemCount = 9;
+
+  struct Entry
+  {
+    std::size_t fBytes{};
+    std::size_t fPeakBytes{};
+    std::size_t fAllocationCount{};
+
+    Entry &operator+=(Entry const &iOther);
+  };
+
+  Entry &operator[](Subsystem iSubsystem) { return fEntries[static_cast<std::size_t>(iSubsystem)]; }
+  Entry const &operator[](Subsystem iSubsystem) const { return fEntries[static_cast<std::size_t>(iSubsystem)]; }
+
+  //! Total (of all subsystems) number of bytes currently allocated
+  std::size_t getTotalBytes() const;
+
+  //! Adds the entries of `iOther` to this report (for example to compute the total for a rack)
+  MemoryReport &operator+=(MemoryReport const &iOther);
+
+  std::string toString() const;
+
+  static char const *getSubsystemName(Subsystem iSubsystem);
+
+  std::array<Entry, kSubsystemCount> fEntries{};
+};
+
+/**
+ * One `MemoryCounter` per subsystem (see `MemoryReport::Subsystem`) */
+class MemoryAccounting
+{
+public:
+  MemoryAccounting();
+
+  std::shared_ptr<MemoryCounter> const &getCounter(MemoryReport::Subsystem iSubsystem) const
+  {
+    return fCounters[static_cast<std::size_t>(iSubsystem)];
+  }
+
+  //! Allocator reporting to the counter of the subsystem
+  template<typename T, typename Base = std::allocator<T>>
+  CountingAllocator<T, Base> getAllocator(MemoryReport::Subsystem iSubsystem) const
+  {
+    return CountingAllocator<T, Base>{getCounter(iSubsystem)};
+  }
+
+  MemoryReport report() const;
+
+private:
+  std::array<std::shared_ptr<MemoryCounter>, MemoryReport::kSubsystemCount> fCounters{};
+};
+
+}
+
+#endif //__Pongasoft_re_mock_memory_accounting_h__
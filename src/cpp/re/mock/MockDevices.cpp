@@ -315,7 +315,9 @@ const DeviceConfig<MAUDst> MAUDst::CONFIG =
 // MAUDst::MAUDst
 //------------------------------------------------------------------------
 MAUDst::MAUDst(int iSampleRate) :
-  MockAudioDevice(iSampleRate), fInSocket{StereoSocket::input()}
+  MockAudioDevice(iSampleRate),
+  fInSocket{StereoSocket::input()},
+  fSampleCharge{Rack::currentMotherboard().getMemoryCounter(MemoryReport::Subsystem::kCapturedSamples)}
 {
 }
 
@@ -327,7 +329,10 @@ void MAUDst::renderBatch(const TJBox_PropertyDiff *, TJBox_UInt32)
   fBuffer.fill(0, 0);
 
   if(copyBuffer(fInSocket, fBuffer) && fSample)
+  {
     fSample->append(fBuffer);
+    fSampleCharge.update(fSample->fData.capacity() * sizeof(TJBox_AudioSample));
+  }
 }
 
 //------------------------------------------------------------------------
@@ -336,6 +341,7 @@ void MAUDst::renderBatch(const TJBox_PropertyDiff *, TJBox_UInt32)
 void MAUDst::produceSample(TJBox_UInt32 iChannels, TJBox_UInt32 iSampleRate)
 {
   fSample = std::make_unique<Sample>(Sample{}.channels(iChannels).sample_rate(fSampleRate));
+  fSampleCharge.update(0);
 }
 
 //------------------------------------------------------------------------
@@ -343,6 +349,7 @@ void MAUDst::produceSample(TJBox_UInt32 iChannels, TJBox_UInt32 iSampleRate)
 //------------------------------------------------------------------------
 std::unique_ptr<MockAudioDevice::Sample> MAUDst::getSample()
 {
+  fSampleCharge.update(0);
   return std::move(fSample);
 }
 
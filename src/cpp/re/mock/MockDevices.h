@@ -148,13 +148,13 @@ public:
   {
     TJBox_UInt32 fChannels{1};
     TJBox_UInt32 fSampleRate{1};
-    std::vector<TJBox_AudioSample> fData{};
+    SampleData fData{}; // aligned (see kAudioAlignment)
 
     Sample &channels(TJBox_UInt32 c) { fChannels = c; return *this; }
     Sample &mono() { return channels(1); }
     Sample &stereo() { return channels(2); }
     Sample &sample_rate(TJBox_UInt32 s) { fSampleRate = s; return *this; }
-    Sample &data(std::vector<TJBox_AudioSample> d) { fData = std::move(d); return *this; }
+    Sample &data(std::vector<TJBox_AudioSample> const &d) { fData.assign(d.begin(), d.end()); return *this; }
 
     //! Return a copy of this object
     Sample clone() const { return *this; }
@@ -202,7 +202,10 @@ public:
     TJBox_UInt32 getSampleRate() const { return fSampleRate; }
 
     //! Return the vector containing the (interleaved) audio samples
-    std::vector<TJBox_AudioSample> const &getData() const { return fData; }
+    SampleData const &getData() const { return fData; }
+
+    //! Return a copy of the (interleaved) audio samples as a `std::vector` (for code written against the previous api)
+    std::vector<TJBox_AudioSample> getDataAsVector() const { return {fData.begin(), fData.end()}; }
 
     //! Return the number of samples total
     TJBox_AudioFramePos getSampleCount() const { return static_cast<TJBox_AudioFramePos>(fData.size()); }
@@ -263,7 +266,7 @@ public:
 
   private:
     MockAudioDevice::Sample const &fSample;
-    decltype(std::vector<TJBox_AudioSample>{}.cbegin()) fPtr;
+    SampleData::const_iterator fPtr;
   };
 
   //! Create a stereo buffer and fill the left channel with `iLeftSample` (resp. right with `iRightSample`)
@@ -479,7 +482,8 @@ public:
 
   /**
    * @return the sample generated and effectively stops producing in subsequent `renderBatch` calls
-   *         (until `produceSample` is called again) */
+   *         (until `produceSample` is called again). The sample is no longer charged to the device
+   *         (see `MemoryReport::Subsystem::kCapturedSamples`) */
   std::unique_ptr<Sample> getSample();
 
   /**
@@ -489,6 +493,7 @@ public:
 protected:
   StereoSocket fInSocket{};
   std::unique_ptr<Sample> fSample{};
+  MemoryCharge fSampleCharge; // fSample data charged to the device
 };
 
 /**
@@ -823,6 +828,15 @@ void MockCVDevice::wire(Rack &iRack,
   iRack.wire(iFromSocket, iToExtension.getCVInSocket(SOCKET));
 }
 
+//! `MAUDst` only captures what other devices produce
+template<> struct rack::is_observer<MAUDst> : std::true_type {};
+
+//! `MCVDst` only captures what other devices produce
+template<> struct rack::is_observer<MCVDst> : std::true_type {};
+
+//! `MNPDst` only captures what other devices produce
+template<> struct rack::is_observer<MNPDst> : std::true_type {};
+
 }
 
 #endif //__Pongasoft_re_mock_mock_devices_h__
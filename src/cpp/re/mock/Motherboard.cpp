@@ -21,6 +21,7 @@
 #include "stl.h"
 #include <Jukebox.h>
 #include <algorithm>
+#include <cstring>
 
 //------------------------------------------------------------------------
 // TJBox_NoteEvent::operator==
@@ -110,7 +111,13 @@ Motherboard::Motherboard(int iInstanceId, int iSampleRate, Config const &iConfig
                               PropertyOwner::kHostOwner,
                               makeNumber(0),
                               static_cast<TJBox_Tag>(i));
+      fNoteVelocityValues[i] = makeNumber(i);
     }
+    fRTCNotifyDiffs.reserve(NOTE_EVENTS_CAPACITY);
+    fBatchDiffs.reserve(NOTE_EVENTS_CAPACITY);
+    fBatchRTDiffs.reserve(NOTE_EVENTS_CAPACITY);
+    if(iConfig.info().fDeviceType == DeviceType::kNotePlayer)
+      fNoteOutEvents.reserve(NOTE_EVENTS_CAPACITY);
   }
 
   // transport
@@ -175,6 +182,28 @@ std::string Motherboard::getPropertyPath(TJBox_PropertyRef const &iPropertyRef)
   return getObject(iPropertyRef.fObject)->getProperty(iPropertyRef.fKey)->fInfo.fPropertyPath;
 }
 
+//------------------------------------------------------------------------
+// Motherboard::getPropertyCount
+//------------------------------------------------------------------------
+size_t Motherboard::getPropertyCount() const
+{
+  size_t res = 0;
+  for(auto const &[id, o]: fJboxObjects)
+    res += o->getPropertyCount();
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::getMaterializedPropertyCount
+//------------------------------------------------------------------------
+size_t Motherboard::getMaterializedPropertyCount() const
+{
+  size_t res = 0;
+  for(auto const &[id, o]: fJboxObjects)
+    res += o->getMaterializedPropertyCount();
+  return res;
+}
+
 //------------------------------------------------------------------------
 // Motherboard::getObjectInfos
 //------------------------------------------------------------------------
@@ -236,14 +265,24 @@ std::shared_ptr<JboxValue> Motherboard::getJboxValue(std::string const &iPropert
 //------------------------------------------------------------------------
 void *Motherboard::findInstance() const
 {
-  auto ref = getObjectRef("/custom_properties");
-  auto &customProperties = fJboxObjects.get(ref);
-  auto instance = customProperties->findValue("instance");
+  // no path lookup (called on every batch)
+  auto instance = fJboxObjects.get(fCustomPropertiesRef)->findValue("instance");
   if(!instance || instance->isNil())
     return nullptr;
   return instance->getNativeObject().fNativeObject;
 }
 
+//------------------------------------------------------------------------
+// Motherboard::isNotePlayerBypassed
+//------------------------------------------------------------------------
+bool Motherboard::isNotePlayerBypassed() const
+{
+  // no path lookup (called for every note wire on every batch)
+  auto bypassed = fJboxObjects.get(fEnvironmentRef)->findValue("player_bypassed");
+  RE_MOCK_ASSERT(bypassed != nullptr, "Device [%s] is not a note player", getDeviceInfo().fProductId);
+  return bypassed->getBoolean();
+}
+
 //------------------------------------------------------------------------
 // Motherboard::to_TJBox_Value
 //------------------------------------------------------------------------
@@ -263,6 +302,17 @@ TJBox_Value Motherboard::to_TJBox_Value(std::shared_ptr<const JboxValue> const &
     case kJBox_Incompatible:
       return impl::jbox_make_value(kJBox_Incompatible, 0);
 
+    case kJBox_DSPBuffer:
+    {
+      // there are only a handful of sockets so a linear search is fine (and happens once per load)
+      for(TJBox_UInt32 i = 0; i < fDSPBufferTable.size(); i++)
+      {
+        if(fDSPBufferTable[i].fValue == iValue)
+          return impl::jbox_make_value(kJBox_DSPBuffer, impl::DSPBufferHandle{i, fBatchId});
+      }
+      RE_MOCK_FAIL("DSP buffer not registered");
+    }
+
     default:
     {
       fCurrentValues[iValue->getUniqueId()] = iValue;
@@ -291,6 +341,14 @@ std::shared_ptr<const JboxValue> Motherboard::from_TJBox_Value(TJBox_Value const
     case kJBox_Incompatible:
       return makeIncompatible();
 
+    case kJBox_DSPBuffer:
+    {
+      auto handle = impl::jbox_get_value<impl::DSPBufferHandle>(kJBox_DSPBuffer, iValue);
+      RE_MOCK_ASSERT(handle.fBatchId == fBatchId && handle.fIndex < fDSPBufferTable.size(),
+                     "Could not find current value of type %d", getValueType(iValue));
+      return fDSPBufferTable[handle.fIndex].fValue;
+    }
+
     default:
     {
       auto uniqueId = impl::jbox_get_value<TJBox_UInt64>(getValueType(iValue), iValue);
@@ -322,10 +380,7 @@ TJBox_Value Motherboard::loadProperty(TJBox_ObjectRef iObject, TJBox_Tag iTag) c
 //------------------------------------------------------------------------
 void Motherboard::storeProperty(TJBox_PropertyRef const &iProperty, std::shared_ptr<const JboxValue> const &iValue, TJBox_UInt16 iAtFrameIndex)
 {
-  auto property = fJboxObjects.get(iProperty.fObject)->getProperty(iProperty.fKey);
-  auto diff = property->storeValue(std::const_pointer_cast<JboxValue>(iValue));
-  diff.fAtFrameIndex = iAtFrameIndex;
-  handlePropertyDiff(diff, property->isWatched());
+  storeProperty(fJboxObjects.get(iProperty.fObject)->getProperty(iProperty.fKey), iValue, iAtFrameIndex);
 }
 
 //------------------------------------------------------------------------
@@ -333,9 +388,48 @@ void Motherboard::storeProperty(TJBox_PropertyRef const &iProperty, std::shared_
 //------------------------------------------------------------------------
 void Motherboard::storeProperty(TJBox_ObjectRef iObject, TJBox_Tag iTag, std::shared_ptr<const JboxValue> const &iValue, TJBox_UInt16 iAtFrameIndex)
 {
-  auto property = getObject(iObject)->getProperty(iTag);
-  auto diff = property->storeValue(std::const_pointer_cast<JboxValue>(iValue));
+  storeProperty(getObject(iObject)->getProperty(iTag), iValue, iAtFrameIndex);
+}
+
+//------------------------------------------------------------------------
+// Motherboard::storeProperty
+//------------------------------------------------------------------------
+void Motherboard::storeProperty(impl::JboxProperty *iProperty, std::shared_ptr<const JboxValue> const &iValue, TJBox_UInt16 iAtFrameIndex)
+{
+  auto diff = iProperty->storeValue(std::const_pointer_cast<JboxValue>(iValue), fRenderValidationEnabled || !fRendering);
   diff.fAtFrameIndex = iAtFrameIndex;
+
+  if(fInputRecorder && !fRendering)
+    fInputRecorder->store(*iProperty, *iValue, iAtFrameIndex);
+
+  // keep track of which notes are on
+  if(iProperty->fInfo.fPropertyRef.fObject == fNoteStatesRef)
+    fActiveNotes.set(iProperty->fInfo.fTag, iValue->getNumber() != 0);
+
+  // keep track of which patch properties changed
+  if(iProperty->fInfo.fPersistence == lua::EPersistence::kPatch && !iProperty->fPatchDirty)
+  {
+    iProperty->fPatchDirty = true;
+    fDirtyPatchProperties.emplace_back(iProperty);
+  }
+
+  handlePropertyDiff(diff, iProperty->isWatched());
+}
+
+//------------------------------------------------------------------------
+// Motherboard::storeNoteState
+//------------------------------------------------------------------------
+void Motherboard::storeNoteState(TJBox_UInt8 iNoteNumber, TJBox_UInt8 iVelocity, TJBox_UInt16 iAtFrameIndex)
+{
+  // note states are host owned, never persisted: no need to go through the generic (patch tracking) path
+  auto property = fNoteStateProperties[iNoteNumber];
+  if(!property)
+    property = fNoteStateProperties[iNoteNumber] = getObject(fNoteStatesRef)->getProperty(static_cast<TJBox_Tag>(iNoteNumber));
+  auto diff = property->storeValue(fNoteVelocityValues[iVelocity]);
+  diff.fAtFrameIndex = iAtFrameIndex;
+  fActiveNotes.set(iNoteNumber, iVelocity != 0);
+  if(fInputRecorder && !fRendering)
+    fInputRecorder->store(*property, *fNoteVelocityValues[iVelocity], iAtFrameIndex);
   handlePropertyDiff(diff, property->isWatched());
 }
 
@@ -400,10 +494,7 @@ void Motherboard::addPatterns(int iPatternCount)
                          kJBox_TransportPatternIndex,
                          iPatternCount,
                          lua::EPersistence::kPatch,
-                         [iPatternCount](auto const &iValue) {
-                           auto index = iValue.getNumber();
-                           return index == kJBox_NoPatternIndex || (index >= 0 && index <= iPatternCount - 1);
-                         });
+                         impl::JboxValueConstraint::integerRange(kJBox_NoPatternIndex, iPatternCount - 1));
   transport->addProperty("pattern_start_pos", PropertyOwner::kDocOwner, makeNumber(0), kJBox_TransportPatternStartPos, 0, lua::EPersistence::kPatch);
 
   for(int i = 0; i < iPatternCount; i++)
@@ -419,7 +510,7 @@ void Motherboard::addPatterns(int iPatternCount)
 void Motherboard::init()
 {
   // lua::MotherboardDef
-  lua::MotherboardDef def{};
+  lua::MotherboardDef def{getMemoryCounter(MemoryReport::Subsystem::kLuaHeap)};
   MockJBoxVisitor defVisitor{def};
   for(auto &v: fConfig.fMotherboardDefs)
     std::visit(defVisitor, v);
@@ -432,7 +523,7 @@ void Motherboard::init()
   }
 
   // lua::RealtimeController
-  fRealtimeController = std::make_unique<lua::RealtimeController>();
+  fRealtimeController = std::make_unique<lua::RealtimeController>(getMemoryCounter(MemoryReport::Subsystem::kLuaHeap));
   MockJBoxVisitor rtcVisitor{*fRealtimeController};
   for(auto &v: fConfig.fRealtimeControllers)
     std::visit(rtcVisitor, v);
@@ -541,7 +632,16 @@ void Motherboard::init()
       break;
   }
 
-  fDefaultValuesPatch = generatePatch();
+  // index of the properties persisted in patches (does not materialise them)
+  for(auto const &[id, o]: fJboxObjects)
+  {
+    for(size_t i = 0; i < o->fPropertyDefs.size(); i++)
+    {
+      auto const &def = o->fPropertyDefs[i];
+      if(def.fPersistence == lua::EPersistence::kPatch)
+        fPatchProperties.emplace_back(PatchPropertyEntry{o.get(), i, fmt::printf("%s/%s", o->fInfo.fObjectPath, def.fName)});
+    }
+  }
 
   // load the default patch if there is one
   if(fConfig.info().fSupportPatches)
@@ -565,6 +665,9 @@ void Motherboard::init()
       fRealtimeController->invokeBinding(this, bindingKey, getPropertyPath(diff.fPropertyRef), diff.fCurrentValue);
     }
   }
+
+  // the initial state is the reference for generatePatchDelta
+  generatePatchDelta();
 }
 
 //------------------------------------------------------------------------
@@ -590,13 +693,13 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
   struct DefaultValueVisitor
   {
     // lua::jbox_boolean_property
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_boolean_property>& o) const { return fMotherboard->makeBoolean(o->fDefaultValue); }
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_boolean_property>& o) const { return fMotherboard->makeBoolean(o->fDefaultValue); }
 
     // lua::jbox_number_property
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_number_property>& o) const { return fMotherboard->makeNumber(o->fDefaultValue); }
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_number_property>& o) const { return fMotherboard->makeNumber(o->fDefaultValue); }
 
     // lua::jbox_performance_property
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_performance_property>& o) const {
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_performance_property>& o) const {
       RE_MOCK_ASSERT(o->fType != lua::jbox_performance_property::Type::UNKNOWN);
       TJBox_Float64 defaultValue = 0;
       if(o->fType == lua::jbox_performance_property::Type::PITCH_BEND)
@@ -605,7 +708,7 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
     }
 
     // lua::jbox_native_object
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_native_object>& o) const {
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_native_object>& o) const {
       if(!o->fDefaultValue.operation.empty())
       {
         struct JboxValueVisitor {
@@ -628,7 +731,7 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
     }
 
     // lua::jbox_string_property
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_string_property>& o) const {
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_string_property>& o) const {
       switch(fOwner)
       {
         case PropertyOwner::kRTOwner:
@@ -642,7 +745,7 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
     }
 
     // lua::jbox_blob_property
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_blob_property>& o) const {
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_blob_property>& o) const {
       RE_MOCK_ASSERT(fOwner == PropertyOwner::kRTCOwner, "Blob must be owned by RTC");
       if(o->fDefaultValue)
         return fMotherboard->loadBlobAsync(*o->fDefaultValue);
@@ -651,7 +754,7 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
     }
 
     // lua::jbox_sample_property
-    std::unique_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_sample_property>& o) const {
+    std::shared_ptr<JboxValue> operator()(const std::shared_ptr<lua::jbox_sample_property>& o) const {
       RE_MOCK_ASSERT(fOwner == PropertyOwner::kRTCOwner, "Sample must be owned by RTC");
       if(o->fDefaultValue)
         return fMotherboard->loadSampleAsync(*o->fDefaultValue);
@@ -680,6 +783,11 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
   auto valueType = std::visit([](auto &p) { return p->value_type(); }, iProperty);
   auto stepCount = std::visit(StepCountVisitor{}, iProperty);
 
+  // rt strings cannot grow past their max size
+  auto constraint = defaultValue->getValueType() == kJBox_String && defaultValue->getString().isRTString() ?
+                    impl::JboxValueConstraint::rtStringMaxSize(defaultValue->getString().fMaxSize) :
+                    impl::JboxValueConstraint::none();
+
   o->addProperty(iPropertyName,
                  iOwner,
                  valueType,
@@ -687,7 +795,7 @@ void Motherboard::addProperty(TJBox_ObjectRef iParentObject,
                  propertyTag,
                  stepCount,
                  *persistence,
-                 {});
+                 constraint);
 }
 
 namespace impl {
@@ -731,7 +839,7 @@ void Motherboard::addUserSample(int iSampleIndex, std::shared_ptr<lua::jbox_user
                           0,
                           *iProperty->fPersistence);
 
-  fUserSamplePropertyPaths.emplace_back(userSample->getProperty("item")->fInfo.fPropertyPath);
+  fUserSamplePropertyPaths.emplace_back(fmt::printf("%s/item", objectName));
 
   for(auto &sampleParameter: iProperty->fSampleParameters)
   {
@@ -795,6 +903,7 @@ void Motherboard::addAudioInput(std::string const &iSocketName)
   std::shared_ptr<JboxValue> buffer = makeDSPBuffer();
   o->addProperty("buffer", PropertyOwner::kHostOwner, buffer, kJBox_AudioInputBuffer);
   fInputDSPBuffers.emplace_back(buffer);
+  addDSPBuffer(buffer);
 }
 
 //------------------------------------------------------------------------
@@ -808,6 +917,15 @@ void Motherboard::addAudioOutput(std::string const &iSocketName)
   std::shared_ptr<JboxValue> buffer = makeDSPBuffer();
   o->addProperty("buffer", PropertyOwner::kHostOwner, buffer, kJBox_AudioOutputBuffer);
   fOutputDSPBuffers.emplace_back(buffer);
+  addDSPBuffer(buffer);
+}
+
+//------------------------------------------------------------------------
+// Motherboard::addDSPBuffer
+//------------------------------------------------------------------------
+void Motherboard::addDSPBuffer(std::shared_ptr<JboxValue> const &iBuffer)
+{
+  fDSPBufferTable.emplace_back(DSPBufferEntry{iBuffer, &iBuffer->getDSPBuffer()});
 }
 
 //------------------------------------------------------------------------
@@ -853,8 +971,9 @@ impl::JboxProperty *Motherboard::getProperty(std::string const &iPropertyPath) c
 //------------------------------------------------------------------------
 impl::JboxObject *Motherboard::addObject(JboxObjectType iType, std::string const &iObjectPath)
 {
-  auto id = fJboxObjects.add([iType, &iObjectPath](auto id) -> auto {
-    return std::make_unique<impl::JboxObject>(iType, iObjectPath, id);
+  auto const &counter = getMemoryCounter(MemoryReport::Subsystem::kPropertyStore);
+  auto id = fJboxObjects.add([iType, &iObjectPath, &counter](auto id) -> auto {
+    return allocate_unique<impl::JboxObject>(counter, iType, iObjectPath, id, counter);
   });
   fJboxObjectRefs[iObjectPath] = id;
   return fJboxObjects.get(id).get();
@@ -865,6 +984,9 @@ impl::JboxObject *Motherboard::addObject(JboxObjectType iType, std::string const
 //------------------------------------------------------------------------
 void Motherboard::nextBatch()
 {
+  if(fJboxProfiler)
+    fJboxProfiler->nextBatch();
+
   // clearing note out events
   fNoteOutEvents.clear();
 
@@ -872,8 +994,10 @@ void Motherboard::nextBatch()
   for(auto buffer: fOutputDSPBuffers)
     buffer->getDSPBuffer().fill(0);
 
-  // first we handle rtc bindings
-  auto diffs = std::move(fRTCBindingsDiffs);
+  // first we handle rtc bindings (swapping with a reused vector so that no allocation happens once warmed up)
+  auto &diffs = fBatchDiffs;
+  diffs.clear();
+  std::swap(diffs, fRTCBindingsDiffs);
 
   for(auto &diff : diffs)
   {
@@ -887,8 +1011,13 @@ void Motherboard::nextBatch()
     }
   }
 
+  // everything the device receives for this batch has been stored
+  if(fInputRecorder)
+    fInputRecorder->nextBatch();
+
   // next we call render_realtime
-  diffs = std::move(fRTCNotifyDiffs);
+  diffs.clear();
+  std::swap(diffs, fRTCNotifyDiffs);
 
   auto const instance = findInstance();
 
@@ -907,7 +1036,8 @@ void Motherboard::nextBatch()
                 });
     }
 
-    std::vector<TJBox_PropertyDiff> rtDiffs{};
+    auto &rtDiffs = fBatchRTDiffs;
+    rtDiffs.clear();
     rtDiffs.reserve(diffs.size());
     for(auto const &diff: diffs)
     {
@@ -921,11 +1051,22 @@ void Motherboard::nextBatch()
       rtDiffs.emplace_back(d);
     }
 
+    struct RenderingScope
+    {
+      explicit RenderingScope(bool &iRendering) : fRendering{iRendering} { fRendering = true; }
+      ~RenderingScope() { fRendering = false; }
+      bool &fRendering;
+    } scope{fRendering};
+
     fRealtime.render_realtime(instance, rtDiffs.data(), static_cast<TJBox_UInt32>(rtDiffs.size()));
   }
 
+  // releasing the values held by the diffs (capacity is kept)
+  diffs.clear();
+
   // clearing current values
   fCurrentValues.clear();
+  fBatchId++;
 
   // clearing input buffers (consumed)
   for(auto buffer: fInputDSPBuffers)
@@ -973,8 +1114,8 @@ void Motherboard::getDSPBufferData(TJBox_Value const &iValue,
                                    TJBox_AudioSample *oAudio) const
 {
   RE_MOCK_ASSERT(iStartFrame >= 0 && iEndFrame >= 0 && iEndFrame <= DSP_BUFFER_SIZE && iStartFrame <= iEndFrame);
-  auto const &buffer = from_TJBox_Value(iValue)->getDSPBuffer();
-  std::copy(std::begin(buffer) + iStartFrame, std::begin(buffer) + iEndFrame, oAudio);
+  auto const &buffer = getDSPBufferFromValue(iValue);
+  std::memcpy(oAudio, buffer.data() + iStartFrame, (iEndFrame - iStartFrame) * sizeof(TJBox_AudioSample));
 }
 
 //------------------------------------------------------------------------
@@ -986,8 +1127,8 @@ void Motherboard::setDSPBufferData(TJBox_Value const &iValue,
                                    TJBox_AudioSample const *iAudio)
 {
   RE_MOCK_ASSERT(iStartFrame >= 0 && iEndFrame >= 0 && iEndFrame <= DSP_BUFFER_SIZE && iStartFrame <= iEndFrame);
-  auto &buffer = std::const_pointer_cast<JboxValue>(from_TJBox_Value(iValue))->getDSPBuffer();
-  std::copy(iAudio, iAudio + iEndFrame - iStartFrame, std::begin(buffer) + iStartFrame);
+  auto &buffer = getDSPBufferFromValue(iValue);
+  std::memcpy(buffer.data() + iStartFrame, iAudio, (iEndFrame - iStartFrame) * sizeof(TJBox_AudioSample));
 }
 
 //------------------------------------------------------------------------
@@ -995,14 +1136,14 @@ void Motherboard::setDSPBufferData(TJBox_Value const &iValue,
 //------------------------------------------------------------------------
 TJBox_DSPBufferInfo Motherboard::getDSPBufferInfo(TJBox_Value const &iValue) const
 {
-  auto const &buffer = from_TJBox_Value(iValue)->getDSPBuffer();
+  auto const &buffer = getDSPBufferFromValue(iValue);
   return {/* .fSampleCount = */ static_cast<TJBox_Int64>(buffer.size()) };
 }
 
 //------------------------------------------------------------------------
 // Motherboard::makeNativeObject
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeNativeObject(std::string const &iOperation,
+std::shared_ptr<JboxValue> Motherboard::makeNativeObject(std::string const &iOperation,
                                                          std::vector<std::shared_ptr<const JboxValue>> const &iParams,
                                                          impl::NativeObject::AccessMode iAccessMode)
 {
@@ -1014,14 +1155,14 @@ std::unique_ptr<JboxValue> Motherboard::makeNativeObject(std::string const &iOpe
     auto nativeObject = fRealtime.create_native_object(iOperation.c_str(), params.data(), static_cast<TJBox_UInt32>(params.size()));
     if(nativeObject)
     {
-      auto res = std::make_unique<JboxValue>();
+      auto res = newJboxValue();
       res->fValueType = kJBox_NativeObject;
-      res->fMotherboardValue = std::unique_ptr<impl::NativeObject>(new impl::NativeObject{
-        /* .fNativeObject = */ nativeObject,
-        /* .fOperation = */    iOperation,
-        /* .fDeleter = */      fRealtime.destroy_native_object,
-        /* .fAccessMode = */   iAccessMode
-      });
+      auto object = allocateShared<impl::NativeObject>(MemoryReport::Subsystem::kJboxValues);
+      object->fNativeObject = nativeObject;
+      object->fOperation = iOperation;
+      object->fDeleter = fRealtime.destroy_native_object;
+      object->fAccessMode = iAccessMode;
+      res->fMotherboardValue = std::move(object);
       return res;
     }
   }
@@ -1031,11 +1172,11 @@ std::unique_ptr<JboxValue> Motherboard::makeNativeObject(std::string const &iOpe
 //------------------------------------------------------------------------
 // Motherboard::loadBlobAsync
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::loadBlobAsync(std::string const &iBlobPath)
+std::shared_ptr<JboxValue> Motherboard::loadBlobAsync(std::string const &iBlobPath)
 {
   RE_MOCK_ASSERT(stl::starts_with(iBlobPath, "/Private/"), "loadBlobAsync path must start with /Private [%s]", iBlobPath);
 
-  auto b = std::make_unique<impl::Blob>();
+  auto b = allocateShared<impl::Blob>(MemoryReport::Subsystem::kJboxValues);
   b->fBlobPath = iBlobPath;
   auto blobResource = fConfig.findBlobResource(iBlobPath);
 
@@ -1052,10 +1193,13 @@ std::unique_ptr<JboxValue> Motherboard::loadBlobAsync(std::string const &iBlobPa
       b->fLoadingContext = resource::LoadingContext{resource::LoadStatus::kResident, blobResource->fData.size() };
 
     if(b->fLoadingContext.isLoadOk())
+    {
       b->fData = std::move(blobResource->fData);
+      b->fDataCharge = MemoryCharge{getMemoryCounter(MemoryReport::Subsystem::kBlobData), b->fData.capacity()};
+    }
   }
 
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_BLOB;
   res->fMotherboardValue = std::move(b);
   return res;
@@ -1071,7 +1215,7 @@ bool Motherboard::loadMoreBlob(std::string const &iPropertyPath, long iCount)
 
   RE_MOCK_ASSERT(blobValue->fValueType == kJBox_BLOB, "[%s] is not a blob", iPropertyPath);
 
-  auto &blob = blobValue->getBlob();
+  auto const &blob = blobValue->getBlob();
 
   RE_MOCK_ASSERT(blob.fLoadingContext.isLoadOk(), "loadMoreBlob: Invalid status [%s]", blob.fLoadingContext.getStatusAsString());
 
@@ -1087,9 +1231,12 @@ bool Motherboard::loadMoreBlob(std::string const &iPropertyPath, long iCount)
 
     if(residentSize != newResidentSize)
     {
+      // values are immutable (the current one may be shared with a snapshot or a pending diff) => copy
       auto newBlobValue = makeEmptyBlob();
       auto &newBlob = newBlobValue->getBlob();
-      newBlob = std::move(blob);
+      newBlob.fData = blob.fData;
+      newBlob.fDataCharge = MemoryCharge{getMemoryCounter(MemoryReport::Subsystem::kBlobData), newBlob.fData.capacity()};
+      newBlob.fBlobPath = blob.fBlobPath;
       newBlob.fLoadingContext = {status, static_cast<size_t>(newResidentSize) };
 
       // this will trigger a notify/diff if being watched
@@ -1132,36 +1279,34 @@ void Motherboard::getBLOBData(TJBox_Value const &iValue, TJBox_SizeT iStart, TJB
 //------------------------------------------------------------------------
 // Motherboard::makeString
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeString(std::string iValue) const
+std::shared_ptr<JboxValue> Motherboard::makeString(std::string iValue) const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_String;
-  res->fMotherboardValue = std::unique_ptr<impl::String>(new impl::String{
-    /* .fMaxSize */ 0,
-    /* .fValue */ std::move(iValue)
-  });
+  auto string = allocateShared<impl::String>(MemoryReport::Subsystem::kJboxValues);
+  string->fValue = std::move(iValue);
+  res->fMotherboardValue = std::move(string);
   return res;
 }
 
 //------------------------------------------------------------------------
 // Motherboard::makeRTString
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeRTString(int iMaxSize) const
+std::shared_ptr<JboxValue> Motherboard::makeRTString(int iMaxSize) const
 {
   RE_MOCK_ASSERT(iMaxSize > 0 && iMaxSize <= 2048, "RTString invalid max_size [%d]", iMaxSize);
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_String;
-  res->fMotherboardValue = std::unique_ptr<impl::String>(new impl::String{
-    /* .fMaxSize */ iMaxSize,
-    /* .fValue */ {}
-  });
+  auto string = allocateShared<impl::String>(MemoryReport::Subsystem::kJboxValues);
+  string->fMaxSize = iMaxSize;
+  res->fMotherboardValue = std::move(string);
   return res;
 }
 
 //------------------------------------------------------------------------
 // Motherboard::makeNativeObjectRO
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeNativeObjectRO(std::string const &iOperation,
+std::shared_ptr<JboxValue> Motherboard::makeNativeObjectRO(std::string const &iOperation,
                                                            std::vector<std::shared_ptr<const JboxValue>> const &iParams)
 {
   return makeNativeObject(iOperation, iParams, impl::NativeObject::kReadOnly);
@@ -1170,7 +1315,7 @@ std::unique_ptr<JboxValue> Motherboard::makeNativeObjectRO(std::string const &iO
 //------------------------------------------------------------------------
 // Motherboard::makeNativeObjectRW
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeNativeObjectRW(std::string const &iOperation,
+std::shared_ptr<JboxValue> Motherboard::makeNativeObjectRW(std::string const &iOperation,
                                                            std::vector<std::shared_ptr<const JboxValue>> const &iParams)
 {
   return makeNativeObject(iOperation, iParams, impl::NativeObject::kReadWrite);
@@ -1216,7 +1361,7 @@ void Motherboard::setRTStringData(TJBox_PropertyRef const &iProperty,
   RE_MOCK_ASSERT(iSize >= 0 && iSize <= rtString.fMaxSize);
   auto newRTString = makeRTString(rtString.fMaxSize);
   std::copy(iData, iData + iSize, std::back_inserter(newRTString->getString().fValue));
-  property->storeValue(std::move(newRTString));
+  property->storeValue(std::move(newRTString), fRenderValidationEnabled || !fRendering);
 }
 
 //------------------------------------------------------------------------
@@ -1227,17 +1372,37 @@ void Motherboard::setNoteInEvent(TJBox_UInt8 iNoteNumber, TJBox_UInt8 iVelocity,
   RE_MOCK_ASSERT(iNoteNumber >= FIRST_MIDI_NOTE && iNoteNumber <= LAST_MIDI_NOTE);
   RE_MOCK_ASSERT(iVelocity >= 0 && iVelocity <= 127);
   RE_MOCK_ASSERT(iAtFrameIndex >= 0 && iAtFrameIndex <= 63);
-  auto const &ref = getPropertyRef(fmt::printf("/note_states/%d", iNoteNumber));
-  storeProperty(ref, makeNumber(iVelocity), iAtFrameIndex);
+  RE_MOCK_ASSERT(fNoteStatesRef > 0, "Device does not accept notes (/note_states)");
+  storeNoteState(iNoteNumber, iVelocity, iAtFrameIndex);
 }
 
 //------------------------------------------------------------------------
 // Motherboard::setNoteInEvents
 //------------------------------------------------------------------------
-void Motherboard::setNoteInEvents(Motherboard::NoteEvents const &iNoteEvents)
+void Motherboard::setNoteInEvents(TJBox_NoteEvent const *iNoteEvents, std::size_t iCount)
 {
-  for(auto &event: iNoteEvents)
-    setNoteInEvent(event);
+  if(iCount == 0)
+    return;
+
+  RE_MOCK_ASSERT(fNoteStatesRef > 0, "Device does not accept notes (/note_states)");
+
+  for(std::size_t i = 0; i < iCount; i++)
+  {
+    auto const &event = iNoteEvents[i];
+    RE_MOCK_ASSERT(event.fNoteNumber >= FIRST_MIDI_NOTE && event.fNoteNumber <= LAST_MIDI_NOTE);
+    RE_MOCK_ASSERT(event.fVelocity >= 0 && event.fVelocity <= 127);
+    RE_MOCK_ASSERT(event.fAtFrameIndex >= 0 && event.fAtFrameIndex <= 63);
+  }
+
+  // at most one diff per event
+  if(fRTCNotifyEnabled)
+    fRTCNotifyDiffs.reserve(fRTCNotifyDiffs.size() + iCount);
+
+  for(std::size_t i = 0; i < iCount; i++)
+  {
+    auto const &event = iNoteEvents[i];
+    storeNoteState(event.fNoteNumber, event.fVelocity, event.fAtFrameIndex);
+  }
 }
 
 //------------------------------------------------------------------------
@@ -1272,6 +1437,26 @@ void Motherboard::setCVSocketValue(TJBox_ObjectRef iCVSocket, TJBox_Float64 iVal
   storeProperty(JBox_MakePropertyRef(iCVSocket, "value"), makeNumber(iValue));
 }
 
+//------------------------------------------------------------------------
+// Motherboard::getCVSocketValueProperty
+//------------------------------------------------------------------------
+impl::JboxProperty *Motherboard::getCVSocketValueProperty(TJBox_ObjectRef iCVSocket) const
+{
+  return fJboxObjects.get(iCVSocket)->getProperty("value");
+}
+
+//------------------------------------------------------------------------
+// Motherboard::setCVSocketValue
+//------------------------------------------------------------------------
+void Motherboard::setCVSocketValue(impl::JboxProperty *iValueProperty, TJBox_Float64 iValue)
+{
+  // no change => no diff
+  if(iValueProperty->loadValue()->getNumber() == iValue)
+    return;
+
+  storeProperty(iValueProperty, makeNumber(iValue), 0);
+}
+
 //------------------------------------------------------------------------
 // Motherboard::isSameValue
 //------------------------------------------------------------------------
@@ -1300,6 +1485,34 @@ bool Motherboard::isSameValue(TJBox_Value const &lhs, TJBox_Value const &rhs) co
   }
 }
 
+//------------------------------------------------------------------------
+// Motherboard::isSameValue
+//------------------------------------------------------------------------
+bool Motherboard::isSameValue(JboxValue const &lhs, JboxValue const &rhs) const
+{
+  if(lhs.getValueType() != rhs.getValueType())
+    return false;
+
+  switch(lhs.getValueType())
+  {
+    case kJBox_Nil:
+    case kJBox_Incompatible:
+      return true;
+
+    case kJBox_Number:
+      return stl::almost_equal(lhs.getNumber(), rhs.getNumber());
+
+    case kJBox_String:
+      return lhs.getString().fValue == rhs.getString().fValue;
+
+    case kJBox_Boolean:
+      return lhs.getBoolean() == rhs.getBoolean();
+
+    default:
+      return &lhs == &rhs;
+  }
+}
+
 //------------------------------------------------------------------------
 // Motherboard::toString
 //------------------------------------------------------------------------
@@ -1497,8 +1710,9 @@ void Motherboard::stopAllNotes()
 {
   if(fNoteStatesRef > 0)
   {
+    // Reason sends a "note off" for every note (on or not)
     for(int i = FIRST_MIDI_NOTE; i <= LAST_MIDI_NOTE; i++)
-      storeProperty(fNoteStatesRef, static_cast<TJBox_Tag>(i), makeNumber(0));
+      storeNoteState(static_cast<TJBox_UInt8>(i), 0, 0);
   }
 }
 
@@ -1507,15 +1721,14 @@ void Motherboard::stopAllNotes()
 //------------------------------------------------------------------------
 void Motherboard::stopAllNotesOn()
 {
-  if(fNoteStatesRef > 0)
+  // nothing to do when no note is playing
+  if(fActiveNotes.none())
+    return;
+
+  for(int i = FIRST_MIDI_NOTE; i <= LAST_MIDI_NOTE; i++)
   {
-    auto notes = getObject(fNoteStatesRef);
-    for(int i = FIRST_MIDI_NOTE; i <= LAST_MIDI_NOTE; i++)
-    {
-      auto value = notes->loadValue(static_cast<TJBox_Tag>(i));
-      if(value->getNumber() != 0)
-        storeProperty(fNoteStatesRef, static_cast<TJBox_Tag>(i), makeNumber(0));
-    }
+    if(fActiveNotes.test(i))
+      storeNoteState(static_cast<TJBox_UInt8>(i), 0, 0);
   }
 }
 
@@ -1524,12 +1737,9 @@ void Motherboard::stopAllNotesOn()
 //------------------------------------------------------------------------
 void Motherboard::stopNoteIfOn(TJBox_UInt8 iNoteNumber)
 {
-  if(fNoteStatesRef > 0)
-  {
-    auto value = getObject(fNoteStatesRef)->loadValue(static_cast<TJBox_Tag>(iNoteNumber));
-    if(value->getNumber() != 0)
-      storeProperty(fNoteStatesRef, static_cast<TJBox_Tag>(iNoteNumber), makeNumber(0));
-  }
+  RE_MOCK_ASSERT(iNoteNumber >= FIRST_MIDI_NOTE && iNoteNumber <= LAST_MIDI_NOTE);
+  if(fActiveNotes.test(iNoteNumber))
+    storeNoteState(iNoteNumber, 0, 0);
 }
 
 
@@ -1562,7 +1772,7 @@ void Motherboard::loadPatch(std::string const &iPatchPath)
 //------------------------------------------------------------------------
 void Motherboard::loadPatch(resource::File const &iPatchFile)
 {
-  auto patchResource = PatchParser::from(iPatchFile);
+  auto patchResource = PatchParser::fromCache(iPatchFile);
   RE_MOCK_ASSERT(patchResource != nullptr, "loadPatch: Cannot find / Error with patch [%s]", iPatchFile.fFilePath.u8string());
   loadPatch(*patchResource);
 }
@@ -1582,9 +1792,22 @@ void Motherboard::loadPatch(resource::String const &iPatchString)
 //------------------------------------------------------------------------
 void Motherboard::loadPatch(resource::Patch const &iPatch)
 {
+  loadPatch(compilePatch(iPatch));
+}
+
+//------------------------------------------------------------------------
+// Motherboard::compilePatch
+//------------------------------------------------------------------------
+CompiledPatch Motherboard::compilePatch(resource::Patch const &iPatch) const
+{
+  CompiledPatch res{};
+  res.fMotherboard = this;
+  res.fEntries.reserve(iPatch.fProperties.size());
+
   for(auto const &[propertyPath, property]: iPatch.fProperties)
   {
-    auto const &info = getProperty(propertyPath)->fInfo;
+    auto p = getProperty(propertyPath);
+    auto const &info = p->fInfo;
 
 //    // it is a GUI property... ignored
 //    if(info.fOwner == PropertyOwner::kGUIOwner)
@@ -1593,97 +1816,627 @@ void Motherboard::loadPatch(resource::Patch const &iPatch)
     RE_MOCK_ASSERT(info.fPersistence == lua::EPersistence::kPatch,
                    "Property [%s] must have a persistence set to \"patch\"", propertyPath);
 
+    auto valueType = p->loadValue()->getValueType();
+
     struct visitor
     {
-      std::string fPropertyPath{};
-      Motherboard *fMotherboard{};
-
-      void operator()(resource::Patch::boolean_property const &o) {
-        if(fMotherboard->getBool(fPropertyPath) != o.fValue)
-          fMotherboard->setBool(fPropertyPath, o.fValue);
+      Motherboard const *fMotherboard;
+      impl::JboxProperty *fProperty;
+      TJBox_ValueType fValueType;
+      std::string const &fPropertyPath;
+
+      CompiledPatch::Entry operator()(resource::Patch::boolean_property const &o) {
+        RE_MOCK_ASSERT(fValueType == kJBox_Boolean, "Property [%s] is not a boolean", fPropertyPath);
+        return { fProperty, fMotherboard->makeBoolean(o.fValue) };
       }
-      void operator()(resource::Patch::number_property const &o) {
-        if(!stl::almost_equal(fMotherboard->getNum(fPropertyPath), o.fValue))
-          fMotherboard->setNum(fPropertyPath, o.fValue);
+      CompiledPatch::Entry operator()(resource::Patch::number_property const &o) {
+        RE_MOCK_ASSERT(fValueType == kJBox_Number, "Property [%s] is not a number", fPropertyPath);
+        return { fProperty, fMotherboard->makeNumber(o.fValue) };
       }
-      void operator()(resource::Patch::string_property const &o) {
-        if(fMotherboard->getString(fPropertyPath) != o.fValue)
-          fMotherboard->setString(fPropertyPath, o.fValue);
+      CompiledPatch::Entry operator()(resource::Patch::string_property const &o) {
+        RE_MOCK_ASSERT(fValueType == kJBox_String, "Property [%s] is not a string", fPropertyPath);
+        RE_MOCK_ASSERT(fProperty->fInfo.fOwner != PropertyOwner::kRTOwner && !fProperty->loadValue()->getString().isRTString());
+        return { fProperty, fMotherboard->makeString(o.fValue) };
       }
-      void operator()(resource::Patch::sample_property const &o) {
-        auto p = fMotherboard->getProperty(fPropertyPath);
-        auto &sample = p->loadValue()->getSample();
-        if(sample.fSamplePath != o.fValue)
-        {
-          auto newSample = o.fValue.empty() ? fMotherboard->makeEmptySample() : fMotherboard->loadSampleAsync(o.fValue);
-          newSample->getSample().fSampleItem = sample.fSampleItem;
-          fMotherboard->storeProperty(p->fInfo.fPropertyRef, std::move(newSample));
-        }
+      CompiledPatch::Entry operator()(resource::Patch::sample_property const &o) {
+        RE_MOCK_ASSERT(fValueType == kJBox_Sample, "Property [%s] is not a sample", fPropertyPath);
+        return { fProperty, nullptr, o.fValue };
       }
     };
 
-    std::visit(visitor{propertyPath, this}, property);
+    res.fEntries.emplace_back(std::visit(visitor{this, p, valueType, propertyPath}, property));
   }
+
+  return res;
 }
 
 //------------------------------------------------------------------------
-// Motherboard::generatePatch
+// Motherboard::loadPatch
 //------------------------------------------------------------------------
-resource::Patch Motherboard::generatePatch() const
+void Motherboard::loadPatch(CompiledPatch const &iPatch)
 {
-  resource::Patch patch{};
+  RE_MOCK_ASSERT(iPatch.fMotherboard == this, "Patch compiled for a different device");
+
+  for(auto const &entry: iPatch.fEntries)
+  {
+    auto property = entry.fProperty;
+    auto const &current = *property->loadValue();
+
+    if(entry.fValue)
+    {
+      auto const &value = *entry.fValue;
+
+      bool changed;
+      switch(value.getValueType())
+      {
+        case kJBox_Boolean:
+          changed = current.getBoolean() != value.getBoolean();
+          break;
+
+        case kJBox_Number:
+          changed = !stl::almost_equal(current.getNumber(), value.getNumber());
+          break;
+
+        default: // kJBox_String
+          changed = current.getString().fValue != value.getString().fValue;
+          break;
+      }
+
+      if(changed)
+        storeProperty(property, entry.fValue, 0);
+    }
+    else
+    {
+      // sample
+      auto const &sample = current.getSample();
+      if(sample.fSamplePath != entry.fSamplePath)
+      {
+        auto newSample = entry.fSamplePath.empty() ? makeEmptySample() : loadSampleAsync(entry.fSamplePath);
+        newSample->getSample().fSampleItem = sample.fSampleItem;
+        storeProperty(property, std::move(newSample), 0);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// Motherboard::reset
+//------------------------------------------------------------------------
+void Motherboard::reset()
+{
+  if(!fCompiledDefaultValuesPatch)
+    fCompiledDefaultValuesPatch = compilePatch(getDefaultValuesPatch());
+  loadPatch(*fCompiledDefaultValuesPatch);
+}
+
+//------------------------------------------------------------------------
+// Motherboard::snapshot
+//------------------------------------------------------------------------
+std::shared_ptr<const MotherboardSnapshot> Motherboard::snapshot() const
+{
+  auto res = std::make_shared<MotherboardSnapshot>();
+  res->fMotherboard = this;
+  for(auto &[id, o]: fJboxObjects)
+  {
+    for(auto p: o->getProperties())
+    {
+      auto value = p->loadValue();
+      if(value->getValueType() == kJBox_DSPBuffer)
+        continue; // socket buffers are rewritten every batch
+
+      if(value->getValueType() == kJBox_NativeObject &&
+         value->getNativeObject().fAccessMode == impl::NativeObject::kReadWrite)
+        value = cloneNativeObject(*value);
+
+      res->fEntries.emplace_back(MotherboardSnapshot::Entry{p, std::move(value), p->fPatchDirty});
+    }
+  }
+  res->fActiveNotes = fActiveNotes;
+  res->fRTCNotifyDiffs = fRTCNotifyDiffs;
+  res->fRTCBindingsDiffs = fRTCBindingsDiffs;
+  res->fNoteOutEvents = fNoteOutEvents;
+  res->fDirtyPatchProperties = fDirtyPatchProperties;
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::restore
+//------------------------------------------------------------------------
+void Motherboard::restore(MotherboardSnapshot const &iSnapshot)
+{
+  RE_MOCK_ASSERT(iSnapshot.fMotherboard == this, "The snapshot was taken by a different motherboard");
+
+  for(auto const &entry: iSnapshot.fEntries)
+  {
+    auto value = entry.fValue;
+    // the snapshot must remain intact so that it can be restored again => the device works on a copy
+    if(value->getValueType() == kJBox_NativeObject &&
+       value->getNativeObject().fAccessMode == impl::NativeObject::kReadWrite)
+      value = cloneNativeObject(*value);
+    entry.fProperty->restoreValue(std::move(value));
+    entry.fProperty->fPatchDirty = entry.fPatchDirty;
+  }
+  fActiveNotes = iSnapshot.fActiveNotes;
+  fRTCNotifyDiffs = iSnapshot.fRTCNotifyDiffs;
+  fRTCBindingsDiffs = iSnapshot.fRTCBindingsDiffs;
+  fNoteOutEvents = iSnapshot.fNoteOutEvents;
+  fDirtyPatchProperties = iSnapshot.fDirtyPatchProperties;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::saveState
+//------------------------------------------------------------------------
+void Motherboard::saveState(StateArchive::Writer &oWriter) const
+{
+  // the count is only known at the end (some values are skipped)
+  auto countOffset = oWriter.size();
+  TJBox_UInt32 count = 0;
+  oWriter.write(count);
+
   for(auto &[id, o]: fJboxObjects)
   {
-    for(auto &[name, p]: o->fProperties)
+    for(auto p: o->getProperties())
     {
-      // only properties that can be persisted
-      if(p->fInfo.fPersistence == lua::EPersistence::kPatch)
+      auto value = p->loadValue();
+      auto type = value->getValueType();
+
+      if(type == kJBox_DSPBuffer)
+        continue; // socket buffers are rewritten every batch
+
+      if(type == kJBox_NativeObject && !fRealtime.serialize_native_object)
+        continue;
+
+      oWriter.writeString(p->fInfo.fPropertyPath);
+      oWriter.write(static_cast<TJBox_UInt8>(p->fPatchDirty ? 1 : 0));
+      oWriter.write(static_cast<TJBox_UInt8>(type));
+
+      switch(type)
       {
-        auto v = p->loadValue();
-        switch(v->getValueType())
+        case kJBox_Number:
+          oWriter.write(value->getNumber());
+          break;
+
+        case kJBox_Boolean:
+          oWriter.write(static_cast<TJBox_UInt8>(value->getBoolean() ? 1 : 0));
+          break;
+
+        case kJBox_String:
+          oWriter.write(static_cast<TJBox_Int32>(value->getString().fMaxSize));
+          oWriter.writeString(value->getString().fValue);
+          break;
+
+        case kJBox_Sample:
+          oWriter.write(static_cast<TJBox_Int32>(value->getSample().fSampleItem));
+          oWriter.writeString(value->getSample().fSamplePath);
+          break;
+
+        case kJBox_BLOB:
+          oWriter.writeString(value->getBlob().fBlobPath);
+          break;
+
+        case kJBox_NativeObject:
+        {
+          auto const &nativeObject = value->getNativeObject();
+          oWriter.writeString(nativeObject.fOperation);
+          oWriter.write(static_cast<TJBox_UInt8>(nativeObject.fAccessMode));
+          oWriter.writeString(fRealtime.serialize_native_object(nativeObject.fOperation.c_str(), nativeObject.fNativeObject));
+          break;
+        }
+
+        default:
+          // nil / incompatible: no payload
+          break;
+      }
+
+      count++;
+    }
+  }
+
+  oWriter.overwrite(countOffset, count);
+}
+
+//------------------------------------------------------------------------
+// Motherboard::decodeState
+//------------------------------------------------------------------------
+std::unique_ptr<MotherboardSnapshot> Motherboard::decodeState(StateArchive::Reader &iReader)
+{
+  auto res = std::make_unique<MotherboardSnapshot>();
+  res->fMotherboard = this;
+
+  auto count = iReader.read<TJBox_UInt32>();
+
+  for(TJBox_UInt32 i = 0; i < count; i++)
+  {
+    auto path = iReader.readString();
+    auto property = getProperty(path);
+    auto patchDirty = iReader.read<TJBox_UInt8>() != 0;
+    auto type = static_cast<TJBox_ValueType>(iReader.read<TJBox_UInt8>());
+
+    std::shared_ptr<JboxValue> value{};
+    std::string resourcePath{};
+    TJBox_ObjectRef sampleItem{};
+    switch(type)
+    {
+      case kJBox_Nil:
+        value = makeNil();
+        break;
+
+      case kJBox_Incompatible:
+        value = makeIncompatible();
+        break;
+
+      case kJBox_Number:
+        value = makeNumber(iReader.read<TJBox_Float64>());
+        break;
+
+      case kJBox_Boolean:
+        value = makeBoolean(iReader.read<TJBox_UInt8>() != 0);
+        break;
+
+      case kJBox_String:
+      {
+        auto maxSize = iReader.read<TJBox_Int32>();
+        auto string = maxSize > 0 ? makeRTString(maxSize) : makeString("");
+        string->getString().fValue = iReader.readString();
+        value = std::move(string);
+        break;
+      }
+
+      case kJBox_Sample:
+      {
+        // the sample itself is only loaded by loadState (decoding has no side effect)
+        sampleItem = static_cast<TJBox_ObjectRef>(iReader.read<TJBox_Int32>());
+        resourcePath = iReader.readString();
+        RE_MOCK_ASSERT(resourcePath.empty() || stl::starts_with(resourcePath, "/"),
+                       "Invalid sample path [%s] for [%s] in state", resourcePath, path);
+        if(resourcePath.empty())
         {
-          case kJBox_Number:
-            patch.number(p->fInfo.fPropertyPath, v->getNumber());
-            break;
+          value = makeEmptySample();
+          value->getSample().fSampleItem = sampleItem;
+        }
+        break;
+      }
+
+      case kJBox_BLOB:
+      {
+        // the blob itself is only loaded by loadState (decoding has no side effect)
+        resourcePath = iReader.readString();
+        RE_MOCK_ASSERT(resourcePath.empty() || stl::starts_with(resourcePath, "/Private/"),
+                       "Invalid blob path [%s] for [%s] in state", resourcePath, path);
+        if(resourcePath.empty())
+          value = makeEmptyBlob();
+        break;
+      }
+
+      case kJBox_NativeObject:
+      {
+        auto operation = iReader.readString();
+        auto accessMode = static_cast<impl::NativeObject::AccessMode>(iReader.read<TJBox_UInt8>());
+        auto bytes = iReader.readString();
+        RE_MOCK_ASSERT(static_cast<bool>(fRealtime.deserialize_native_object),
+                       "Cannot load native object [%s] for [%s] (no Realtime::deserialize_native_object provided)",
+                       operation, path);
+        auto nativeObject = fRealtime.deserialize_native_object(operation.c_str(), bytes);
+        RE_MOCK_ASSERT(nativeObject != nullptr, "Realtime::deserialize_native_object returned nullptr for [%s]", operation);
+        value = newJboxValue();
+        value->fValueType = kJBox_NativeObject;
+        auto object = allocateShared<impl::NativeObject>(MemoryReport::Subsystem::kJboxValues);
+        object->fNativeObject = nativeObject;
+        object->fOperation = operation;
+        object->fDeleter = fRealtime.destroy_native_object;
+        object->fAccessMode = accessMode;
+        value->fMotherboardValue = std::move(object);
+        break;
+      }
+
+      default:
+        RE_MOCK_FAIL("Invalid value type [%d] for [%s] in state", type, path);
+    }
+
+    RE_MOCK_ASSERT(type == kJBox_Nil || type == toJBoxValueType(property->fInfo.fValueType),
+                   "Invalid value type [%d] for [%s] in state", type, path);
+    RE_MOCK_ASSERT(!value || property->getConstraint().accept(*value),
+                   "Value failed validation for property [%s] in state", path);
+
+    // derived state
+    if(property->fInfo.fPropertyRef.fObject == fNoteStatesRef)
+      res->fActiveNotes.set(property->fInfo.fTag, value->getValueType() == kJBox_Number && value->getNumber() != 0);
+    if(patchDirty)
+      res->fDirtyPatchProperties.emplace_back(property);
+
+    res->fEntries.emplace_back(MotherboardSnapshot::Entry{property, std::move(value), patchDirty,
+                                                          std::move(resourcePath), sampleItem});
+  }
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::loadState
+//------------------------------------------------------------------------
+void Motherboard::loadState(std::unique_ptr<MotherboardSnapshot> iState)
+{
+  RE_MOCK_INTERNAL_ASSERT(iState && iState->fMotherboard == this);
+
+  // the state is only applied once => its values (including native objects) are handed over as-is
+  for(auto &entry: iState->fEntries)
+  {
+    auto value = std::move(entry.fValue);
+    if(!value)
+    {
+      // sample / blob (see decodeState)
+      if(entry.fProperty->fInfo.fValueType == JboxPropertyType::kSample)
+      {
+        value = loadSampleAsync(entry.fResourcePath);
+        value->getSample().fSampleItem = entry.fSampleItem;
+      }
+      else
+        value = loadBlobAsync(entry.fResourcePath);
+    }
+
+    auto diff = entry.fProperty->storeValue(std::move(value), false);
+    entry.fProperty->fPatchDirty = entry.fPatchDirty;
+
+    // the device has never seen this state => same as a property being stored (but not recorded). An unchanged
+    // value is skipped (ex: a diff on /environment/system_sample_rate would re-create the device instance)
+    if(!isSameValue(*diff.fPreviousValue, *diff.fCurrentValue))
+      handlePropertyDiff(diff, entry.fProperty->isWatched());
+  }
+  fActiveNotes = iState->fActiveNotes;
+  fDirtyPatchProperties = std::move(iState->fDirtyPatchProperties);
 
-          case kJBox_Boolean:
-            patch.boolean(p->fInfo.fPropertyPath, v->getBoolean());
-            break;
+  // produced by the device for the (previous) state
+  fNoteOutEvents.clear();
+}
 
-          case kJBox_String:
-            patch.string(p->fInfo.fPropertyPath, v->getString().fValue);
-            break;
+//------------------------------------------------------------------------
+// Motherboard::startInputRecording
+//------------------------------------------------------------------------
+void Motherboard::startInputRecording(std::string const &iFilePath)
+{
+  fInputRecorder = nullptr; // completes the previous recording (if any)
 
-          case kJBox_Sample:
-            patch.sample(p->fInfo.fPropertyPath, v->getSample().fSamplePath);
-            break;
+  auto recorder = std::make_unique<InputRecording::Writer>(iFilePath);
+  for(auto &[id, o]: fJboxObjects)
+  {
+    for(auto p: o->getProperties())
+    {
+      // the properties owned by the device are its state, not its inputs
+      if(p->fInfo.fOwner == PropertyOwner::kRTOwner)
+        continue;
 
-          default:
-            RE_MOCK_INTERNAL_ASSERT(false, "should not be reached");
-            break;
+      if(o->fInfo.fType == JboxObjectType::kAudioInput && p->loadValue()->getValueType() == kJBox_DSPBuffer)
+        recorder->addAudioInput(p);
+      else
+        recorder->state(*p);
+    }
+  }
+  fInputRecorder = std::move(recorder);
+}
+
+//------------------------------------------------------------------------
+// Motherboard::stopInputRecording
+//------------------------------------------------------------------------
+size_t Motherboard::stopInputRecording()
+{
+  if(!fInputRecorder)
+    return 0;
+
+  auto res = fInputRecorder->getBatchCount();
+  fInputRecorder = nullptr;
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::replayInputs
+//------------------------------------------------------------------------
+size_t Motherboard::replayInputs(InputRecording const &iRecording)
+{
+  RE_MOCK_ASSERT(!fInputRecorder, "Cannot replay a recording while recording");
+
+  // resolving the properties once
+  std::vector<impl::JboxProperty *> properties{};
+  for(auto const &path: iRecording.getPropertyPaths())
+  {
+    auto ref = getPropertyRef(path);
+    properties.emplace_back(fJboxObjects.get(ref.fObject)->getProperty(ref.fKey));
+  }
+
+  auto toJboxValue = [this](InputRecording::Value const &iValue) -> std::shared_ptr<JboxValue> {
+    switch(iValue.fType)
+    {
+      case kJBox_Number:
+        return makeNumber(iValue.fNumber);
+
+      case kJBox_Boolean:
+        return makeBoolean(iValue.fBoolean);
+
+      case kJBox_String:
+      {
+        if(iValue.fMaxSize > 0)
+        {
+          auto res = makeRTString(iValue.fMaxSize);
+          res->getString().fValue = iValue.fString;
+          return res;
         }
+        return makeString(iValue.fString);
       }
+
+      case kJBox_Incompatible:
+        return makeIncompatible();
+
+      default:
+        return makeNil();
     }
+  };
+
+  auto isSameValue = [](JboxValue const &iValue, InputRecording::Value const &iRecordedValue) {
+    if(iValue.getValueType() != iRecordedValue.fType)
+      return false;
+    switch(iRecordedValue.fType)
+    {
+      case kJBox_Number:
+        return iValue.getNumber() == iRecordedValue.fNumber;
+      case kJBox_Boolean:
+        return iValue.getBoolean() == iRecordedValue.fBoolean;
+      case kJBox_String:
+        return iValue.getString().fValue == iRecordedValue.fString;
+      default:
+        return true;
+    }
+  };
+
+  size_t batchCount = 0;
+
+  InputRecording::Handler handler{};
+  handler.fOnStore = [&](TJBox_UInt32 iPropertyId, InputRecording::Value const &iValue, TJBox_UInt16 iAtFrameIndex, bool iState) {
+    auto property = properties[iPropertyId];
+    // a fresh device already has its default values: only the ones which differ matter
+    if(iState && isSameValue(*property->loadValue(), iValue))
+      return;
+    storeProperty(property, toJboxValue(iValue), iAtFrameIndex);
+  };
+  handler.fOnAudio = [&properties](TJBox_UInt32 iPropertyId, impl::DSPBuffer const &iBuffer) {
+    properties[iPropertyId]->loadValue()->getDSPBuffer() = iBuffer;
+  };
+  handler.fOnBatch = [this, &batchCount]() {
+    nextBatch();
+    batchCount++;
+  };
+
+  // what the bindings stored is part of the recording
+  auto bindingsEnabled = fRTCBindingsEnabled;
+  fRTCBindingsEnabled = false;
+  fRTCBindingsDiffs.clear();
+  iRecording.replay(handler);
+  fRTCBindingsEnabled = bindingsEnabled;
+
+  return batchCount;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::cloneNativeObject
+//------------------------------------------------------------------------
+std::shared_ptr<JboxValue> Motherboard::cloneNativeObject(JboxValue const &iValue) const
+{
+  auto const &nativeObject = iValue.getNativeObject();
+  RE_MOCK_ASSERT(static_cast<bool>(fRealtime.clone_native_object),
+                 "Cannot snapshot read/write native object [%s] (no Realtime::clone_native_object provided)",
+                 nativeObject.fOperation);
+  auto clone = fRealtime.clone_native_object(nativeObject.fOperation.c_str(), nativeObject.fNativeObject);
+  RE_MOCK_ASSERT(clone != nullptr, "Realtime::clone_native_object returned nullptr for [%s]", nativeObject.fOperation);
+  auto res = newJboxValue();
+  res->fValueType = kJBox_NativeObject;
+  auto object = allocateShared<impl::NativeObject>(MemoryReport::Subsystem::kJboxValues);
+  object->fNativeObject = clone;
+  object->fOperation = nativeObject.fOperation;
+  object->fDeleter = nativeObject.fDeleter;
+  object->fAccessMode = nativeObject.fAccessMode;
+  res->fMotherboardValue = std::move(object);
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::generatePatch
+//------------------------------------------------------------------------
+resource::Patch Motherboard::generatePatch() const
+{
+  resource::Patch patch{};
+  for(auto const &entry: fPatchProperties)
+    addToPatch(patch, entry.fPropertyPath, *entry.fObject->peekValue(entry.fDefIndex));
+  return patch;
+}
+
+//------------------------------------------------------------------------
+// Motherboard::getDefaultValuesPatch
+//------------------------------------------------------------------------
+resource::Patch const &Motherboard::getDefaultValuesPatch() const
+{
+  if(!fDefaultValuesPatch)
+  {
+    resource::Patch patch{};
+    for(auto const &entry: fPatchProperties)
+      addToPatch(patch, entry.fPropertyPath, *entry.fObject->fPropertyDefs[entry.fDefIndex].fInitialValue);
+    fDefaultValuesPatch = std::move(patch);
   }
+  return *fDefaultValuesPatch;
+}
 
+//------------------------------------------------------------------------
+// Motherboard::generatePatchDelta
+//------------------------------------------------------------------------
+resource::Patch Motherboard::generatePatchDelta()
+{
+  resource::Patch patch{};
+  for(auto p: fDirtyPatchProperties)
+  {
+    addToPatch(patch, p);
+    p->fPatchDirty = false;
+  }
+  fDirtyPatchProperties.clear();
   return patch;
 }
 
+//------------------------------------------------------------------------
+// Motherboard::addToPatch
+//------------------------------------------------------------------------
+void Motherboard::addToPatch(resource::Patch &oPatch, impl::JboxProperty const *iProperty)
+{
+  addToPatch(oPatch, iProperty->fInfo.fPropertyPath, *iProperty->loadValue());
+}
+
+//------------------------------------------------------------------------
+// Motherboard::addToPatch
+//------------------------------------------------------------------------
+void Motherboard::addToPatch(resource::Patch &oPatch, std::string const &iPropertyPath, JboxValue const &iValue)
+{
+  switch(iValue.getValueType())
+  {
+    case kJBox_Number:
+      oPatch.number(iPropertyPath, iValue.getNumber());
+      break;
+
+    case kJBox_Boolean:
+      oPatch.boolean(iPropertyPath, iValue.getBoolean());
+      break;
+
+    case kJBox_String:
+      oPatch.string(iPropertyPath, iValue.getString().fValue);
+      break;
+
+    case kJBox_Sample:
+      oPatch.sample(iPropertyPath, iValue.getSample().fSamplePath);
+      break;
+
+    default:
+      RE_MOCK_INTERNAL_ASSERT(false, "should not be reached");
+      break;
+  }
+}
+
+
+//------------------------------------------------------------------------
+// Motherboard::newJboxValue
+//------------------------------------------------------------------------
+std::shared_ptr<JboxValue> Motherboard::newJboxValue() const
+{
+  return allocateShared<JboxValue>(MemoryReport::Subsystem::kJboxValues);
+}
 
 //------------------------------------------------------------------------
 // Motherboard::makeNil
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeNil() const
+std::shared_ptr<JboxValue> Motherboard::makeNil() const
 {
-  return std::make_unique<JboxValue>();
+  return newJboxValue();
 }
 
 //------------------------------------------------------------------------
 // Motherboard::makeIncompatible
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeIncompatible() const
+std::shared_ptr<JboxValue> Motherboard::makeIncompatible() const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_Incompatible;
   res->fMotherboardValue = JboxValue::incompatible_t{};
   return res;
@@ -1692,9 +2445,9 @@ std::unique_ptr<JboxValue> Motherboard::makeIncompatible() const
 //------------------------------------------------------------------------
 // Motherboard::makeNumber
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeNumber(TJBox_Float64 iValue) const
+std::shared_ptr<JboxValue> Motherboard::makeNumber(TJBox_Float64 iValue) const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_Number;
   res->fMotherboardValue = iValue;
   return res;
@@ -1703,9 +2456,9 @@ std::unique_ptr<JboxValue> Motherboard::makeNumber(TJBox_Float64 iValue) const
 //------------------------------------------------------------------------
 // Motherboard::makeBoolean
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeBoolean(bool iValue) const
+std::shared_ptr<JboxValue> Motherboard::makeBoolean(bool iValue) const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_Boolean;
   res->fMotherboardValue = iValue;
   return res;
@@ -1714,33 +2467,33 @@ std::unique_ptr<JboxValue> Motherboard::makeBoolean(bool iValue) const
 //------------------------------------------------------------------------
 // Motherboard::makeDSPBuffer
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeDSPBuffer() const
+std::shared_ptr<JboxValue> Motherboard::makeDSPBuffer() const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_DSPBuffer;
-  res->fMotherboardValue = std::make_unique<DSPBuffer>();
+  res->fMotherboardValue = allocateShared<impl::AlignedDSPBuffer, AlignedAllocator<impl::AlignedDSPBuffer>>(MemoryReport::Subsystem::kDSPBuffers);
   return res;
 }
 
 //------------------------------------------------------------------------
 // Motherboard::makeEmptyBlob
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeEmptyBlob() const
+std::shared_ptr<JboxValue> Motherboard::makeEmptyBlob() const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_BLOB;
-  res->fMotherboardValue = std::make_unique<impl::Blob>();
+  res->fMotherboardValue = allocateShared<impl::Blob>(MemoryReport::Subsystem::kJboxValues);
   return res;
 }
 
 //------------------------------------------------------------------------
 // Motherboard::makeEmptySample
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::makeEmptySample(TJBox_ObjectRef iSampleItem) const
+std::shared_ptr<JboxValue> Motherboard::makeEmptySample(TJBox_ObjectRef iSampleItem) const
 {
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_Sample;
-  res->fMotherboardValue = std::make_unique<impl::Sample>();
+  res->fMotherboardValue = allocateShared<impl::Sample>(MemoryReport::Subsystem::kJboxValues);
   res->getSample().fSampleItem = iSampleItem;
   return res;
 }
@@ -1758,7 +2511,7 @@ TJBox_SampleInfo Motherboard::getSampleInfo(JboxValue const &iValue) const
 //------------------------------------------------------------------------
 impl::Sample::Metadata Motherboard::getSampleMetadata(JboxValue const &iValue) const
 {
-  auto sample = iValue.getSample();
+  auto const &sample = iValue.getSample();
 
   impl::Sample::Metadata res;
   auto &md = res.fMain;
@@ -1836,11 +2589,11 @@ impl::Sample::Metadata Motherboard::getSampleMetadata(JboxValue const &iValue) c
 //------------------------------------------------------------------------
 // Motherboard::loadSampleAsync
 //------------------------------------------------------------------------
-std::unique_ptr<JboxValue> Motherboard::loadSampleAsync(std::string const &iSamplePath)
+std::shared_ptr<JboxValue> Motherboard::loadSampleAsync(std::string const &iSamplePath)
 {
   RE_MOCK_ASSERT(stl::starts_with(iSamplePath, "/"), "loadSampleAsync path must start with / [%s]", iSamplePath);
 
-  auto sample =  std::make_unique<impl::Sample>();
+  auto sample = allocateShared<impl::Sample>(MemoryReport::Subsystem::kJboxValues);
   sample->fSamplePath = iSamplePath;
   auto sampleResource = fConfig.findSampleResource(iSamplePath);
 
@@ -1863,10 +2616,12 @@ std::unique_ptr<JboxValue> Motherboard::loadSampleAsync(std::string const &iSamp
       sample->fSampleRate = sampleResource->fSampleRate;
       sample->fChannels = sampleResource->fChannels;
       sample->fData = std::move(sampleResource->fData);
+      sample->fDataCharge = MemoryCharge{getMemoryCounter(MemoryReport::Subsystem::kSampleData),
+                                         sample->fData.capacity() * sizeof(TJBox_AudioSample)};
     }
   }
 
-  auto res = std::make_unique<JboxValue>();
+  auto res = newJboxValue();
   res->fValueType = kJBox_Sample;
   res->fMotherboardValue = std::move(sample);
   return res;
@@ -1882,7 +2637,7 @@ bool Motherboard::loadMoreSample(std::string const &iPropertyPath, long iFrameCo
 
   RE_MOCK_ASSERT(sampleValue->fValueType == kJBox_Sample, "[%s] is not a sample", iPropertyPath);
 
-  auto &sample = sampleValue->getSample();
+  auto const &sample = sampleValue->getSample();
 
   RE_MOCK_ASSERT(sample.fLoadingContext.isLoadOk(), "loadMoreSample: Invalid status [%s]", sample.fLoadingContext.getStatusAsString());
 
@@ -1900,9 +2655,15 @@ bool Motherboard::loadMoreSample(std::string const &iPropertyPath, long iFrameCo
 
     if(residentFrameCount != newResidentFrameCount)
     {
+      // values are immutable (the current one may be shared with a snapshot or a pending diff) => copy
       auto newSampleValue = makeEmptySample(sample.fSampleItem);
       auto &newSample = newSampleValue->getSample();
-      newSample = std::move(sample);
+      newSample.fChannels = sample.fChannels;
+      newSample.fSampleRate = sample.fSampleRate;
+      newSample.fData = sample.fData;
+      newSample.fDataCharge = MemoryCharge{getMemoryCounter(MemoryReport::Subsystem::kSampleData),
+                                           newSample.fData.capacity() * sizeof(TJBox_AudioSample)};
+      newSample.fSamplePath = sample.fSamplePath;
       newSample.fLoadingContext = {status, static_cast<size_t>(newResidentFrameCount) };
 
       // this will trigger a notify/diff if being watched
@@ -1965,7 +2726,78 @@ void Motherboard::getSampleData(TJBox_Value iValue,
 void Motherboard::trace(const char *iFile, TJBox_Int32 iLine, const char *iMessage) const
 {
   if(fConfig.traceEnabled())
-    RE_MOCK_LOG_JUKEBOX_INFO("%s:%d | %s", iFile, iLine, iMessage);
+  {
+    if(!fTraceRing)
+      fTraceRing = std::make_unique<TraceRing>(fConfig.traceBufferSize());
+    fTraceRing->trace(iFile, iLine, iMessage);
+  }
+}
+
+//------------------------------------------------------------------------
+// Motherboard::traceValues
+//------------------------------------------------------------------------
+void Motherboard::traceValues(const char *iFile,
+                              TJBox_Int32 iLine,
+                              const char *iTemplate,
+                              const TJBox_Value iValues[],
+                              TJBox_Int32 iValueCount) const
+{
+  if(!fConfig.traceEnabled())
+    return;
+
+  // only primitive values survive the batch and can be formatted later
+  auto raw = iValueCount <= TraceRing::kMaxValueCount;
+  for(int i = 0; raw && i < iValueCount; i++)
+  {
+    auto type = getValueType(iValues[i]);
+    raw = type == kJBox_Nil || type == kJBox_Number || type == kJBox_Boolean;
+  }
+
+  if(raw)
+  {
+    if(!fTraceRing)
+      fTraceRing = std::make_unique<TraceRing>(fConfig.traceBufferSize());
+    fTraceRing->traceValues(iFile, iLine, iTemplate, iValues, iValueCount);
+  }
+  else
+  {
+    std::vector<std::string> values{};
+    values.reserve(iValueCount);
+    for(int i = 0; i < iValueCount; i++)
+      values.emplace_back(toString(iValues[i]));
+    std::string buf{};
+    fmt::impl::printf(iTemplate, values, std::back_inserter(buf));
+    trace(iFile, iLine, buf.c_str());
+  }
+}
+
+//------------------------------------------------------------------------
+// Motherboard::flushTraces
+//------------------------------------------------------------------------
+size_t Motherboard::flushTraces(std::ostream &oStream)
+{
+  if(!fTraceRing)
+    return 0;
+
+  auto count = fTraceRing->drain([this](TJBox_Value const &iValue) { return toString(iValue); },
+                                 [&oStream](std::string_view iFile, TJBox_Int32 iLine, std::string_view iMessage) {
+                                   oStream << iFile << ":" << iLine << " | " << iMessage << '\n';
+                                 });
+
+  auto droppedCount = fTraceRing->getDroppedCount();
+  if(droppedCount != fReportedTraceDroppedCount)
+  {
+    oStream << fmt::printf("%s | %ld trace(s) dropped (trace buffer size is %ld)\n",
+                           getDeviceInfo().fProductId,
+                           droppedCount - fReportedTraceDroppedCount,
+                           fTraceRing->getCapacity());
+    fReportedTraceDroppedCount = droppedCount;
+  }
+
+  if(count > 0)
+    oStream.flush();
+
+  return count;
 }
 
 //------------------------------------------------------------------------
@@ -1998,15 +2830,82 @@ void Motherboard::enableRTCBindings()
 //------------------------------------------------------------------------
 void Motherboard::disableRTCBindings()
 {
-  fRTCNotifyEnabled = false;
-  fRTCNotifyDiffs.clear();
+  fRTCBindingsEnabled = false;
+  fRTCBindingsDiffs.clear();
 }
 
 //------------------------------------------------------------------------
 // JboxObject::JboxObject
 //------------------------------------------------------------------------
-impl::JboxObject::JboxObject(JboxObjectType iType, std::string const &iObjectPath, TJBox_ObjectRef iObjectRef) :
-  fInfo{iType, iObjectPath, iObjectRef} {}
+impl::JboxObject::JboxObject(JboxObjectType iType,
+                             std::string const &iObjectPath,
+                             TJBox_ObjectRef iObjectRef,
+                             std::shared_ptr<MemoryCounter> const &iCounter) :
+  fInfo{iType, iObjectPath, iObjectRef},
+  fPropertyDefs{CountingAllocator<PropertyDef>{iCounter}},
+  fSortedPropertyDefs{CountingAllocator<TJBox_UInt32>{iCounter}},
+  fProperties{CountingAllocator<counted_unique_ptr<JboxProperty>>{iCounter}}
+{}
+
+//------------------------------------------------------------------------
+// JboxObject::findPropertyIndex
+//------------------------------------------------------------------------
+int impl::JboxObject::findPropertyIndex(std::string const &iPropertyName) const
+{
+  auto iter = std::lower_bound(fSortedPropertyDefs.begin(),
+                               fSortedPropertyDefs.end(),
+                               iPropertyName,
+                               [this](auto i, auto const &name) { return fPropertyDefs[i].fName < name; });
+  if(iter == fSortedPropertyDefs.end() || fPropertyDefs[*iter].fName != iPropertyName)
+    return -1;
+  else
+    return static_cast<int>(*iter);
+}
+
+//------------------------------------------------------------------------
+// JboxObject::findPropertyIndex
+//------------------------------------------------------------------------
+int impl::JboxObject::findPropertyIndex(TJBox_Tag iPropertyTag) const
+{
+  // (in name order like the lookup by name)
+  auto iter = std::find_if(fSortedPropertyDefs.begin(),
+                           fSortedPropertyDefs.end(),
+                           [this, iPropertyTag](auto i) { return fPropertyDefs[i].fTag == iPropertyTag; } );
+  return iter == fSortedPropertyDefs.end() ? -1 : static_cast<int>(*iter);
+}
+
+//------------------------------------------------------------------------
+// JboxObject::materializeProperty
+//------------------------------------------------------------------------
+impl::JboxProperty *impl::JboxObject::materializeProperty(size_t iIndex) const
+{
+  auto &property = fProperties[iIndex];
+  if(!property)
+  {
+    auto &def = fPropertyDefs[iIndex];
+    // the initial value of a property persisted in patches is also its default value (see getDefaultValuesPatch)
+    auto initialValue = def.fPersistence == lua::EPersistence::kPatch ? def.fInitialValue : std::move(def.fInitialValue);
+    property = allocate_unique<JboxProperty>(fProperties.get_allocator().getCounter(),
+                                             JBox_MakePropertyRef(fInfo.fObjectRef, def.fName.c_str()),
+                                             fmt::printf("%s/%s", fInfo.fObjectPath, def.fName),
+                                             def.fValueType,
+                                             def.fStepCount,
+                                             def.fOwner,
+                                             std::move(initialValue),
+                                             def.fTag,
+                                             def.fConstraint,
+                                             def.fPersistence);
+  }
+  return property.get();
+}
+
+//------------------------------------------------------------------------
+// JboxObject::getMaterializedPropertyCount
+//------------------------------------------------------------------------
+size_t impl::JboxObject::getMaterializedPropertyCount() const
+{
+  return std::count_if(fProperties.begin(), fProperties.end(), [](auto const &p) { return p != nullptr; });
+}
 
 //------------------------------------------------------------------------
 // JboxObject::getProperty
@@ -2023,14 +2922,8 @@ impl::JboxProperty *impl::JboxObject::getProperty(std::string const &iPropertyNa
 //------------------------------------------------------------------------
 impl::JboxProperty *impl::JboxObject::findProperty(std::string const &iPropertyName) const
 {
-  auto iter = fProperties.find(iPropertyName);
-  if(iter == fProperties.end())
-    return nullptr;
-  else
-  {
-    auto &prop = iter->second;
-    return prop.get();
-  }
+  auto index = findPropertyIndex(iPropertyName);
+  return index < 0 ? nullptr : materializeProperty(index);
 }
 
 //------------------------------------------------------------------------
@@ -2038,11 +2931,30 @@ impl::JboxProperty *impl::JboxObject::findProperty(std::string const &iPropertyN
 //------------------------------------------------------------------------
 impl::JboxProperty *impl::JboxObject::getProperty(TJBox_Tag iPropertyTag) const
 {
-  auto iter = std::find_if(fProperties.begin(),
-                           fProperties.end(),
-                           [iPropertyTag](auto const &p) { return p.second->fInfo.fTag == iPropertyTag; } );
-  RE_MOCK_ASSERT(iter != fProperties.end(), "missing property tag [%d] for object [%s]", iPropertyTag, fInfo.fObjectPath);
-  return iter->second.get();
+  auto index = findPropertyIndex(iPropertyTag);
+  RE_MOCK_ASSERT(index >= 0, "missing property tag [%d] for object [%s]", iPropertyTag, fInfo.fObjectPath);
+  return materializeProperty(index);
+}
+
+//------------------------------------------------------------------------
+// JboxObject::getProperties
+//------------------------------------------------------------------------
+std::vector<impl::JboxProperty *> impl::JboxObject::getProperties() const
+{
+  std::vector<JboxProperty *> res{};
+  res.reserve(fSortedPropertyDefs.size());
+  for(auto i: fSortedPropertyDefs)
+    res.emplace_back(materializeProperty(i));
+  return res;
+}
+
+//------------------------------------------------------------------------
+// JboxObject::peekValue
+//------------------------------------------------------------------------
+std::shared_ptr<const JboxValue> impl::JboxObject::peekValue(size_t iIndex) const
+{
+  auto const &property = fProperties[iIndex];
+  return property ? property->loadValue() : fPropertyDefs[iIndex].fInitialValue;
 }
 
 //------------------------------------------------------------------------
@@ -2051,9 +2963,20 @@ impl::JboxProperty *impl::JboxObject::getProperty(TJBox_Tag iPropertyTag) const
 std::vector<JboxPropertyInfo> impl::JboxObject::getPropertyInfos() const
 {
   std::vector<JboxPropertyInfo> res{};
-  res.reserve(fProperties.size());
-  for(auto const &[name, p]: fProperties)
-    res.emplace_back(p->getInfo());
+  res.reserve(fSortedPropertyDefs.size());
+  for(auto i: fSortedPropertyDefs)
+  {
+    auto const &def = fPropertyDefs[i];
+    res.emplace_back(JboxPropertyInfo{
+      /* .fPropertyRef = */  JBox_MakePropertyRef(fInfo.fObjectRef, def.fName.c_str()),
+      /* .fPropertyPath = */ fmt::printf("%s/%s", fInfo.fObjectPath, def.fName),
+      /* .fValueType = */    toJboxPropertyType(def.fValueType),
+      /* .fStepCount = */    def.fStepCount,
+      /* .fOwner = */        def.fOwner,
+      /* .fTag = */          def.fTag,
+      /* .fPersistence = */  def.fPersistence
+    });
+  }
   return res;
 }
 
@@ -2062,9 +2985,7 @@ std::vector<JboxPropertyInfo> impl::JboxObject::getPropertyInfos() const
 //------------------------------------------------------------------------
 bool impl::JboxObject::hasProperty(TJBox_Tag iPropertyTag) const
 {
-  return std::find_if(fProperties.begin(),
-                      fProperties.end(),
-                      [iPropertyTag](auto const &p) { return p.second->fInfo.fTag == iPropertyTag; } ) != fProperties.end();
+  return findPropertyIndex(iPropertyTag) >= 0;
 }
 
 //------------------------------------------------------------------------
@@ -2133,7 +3054,7 @@ void impl::JboxObject::addProperty(const std::string &iPropertyName,
                                    TJBox_Tag iPropertyTag,
                                    int iStepCount,
                                    lua::EPersistence iPersistence,
-                                   value_validator_t iValueValidator)
+                                   JboxValueConstraint iConstraint)
 {
   auto valueType = iInitialValue->getValueType();
   addProperty(iPropertyName,
@@ -2143,7 +3064,7 @@ void impl::JboxObject::addProperty(const std::string &iPropertyName,
               iPropertyTag,
               iStepCount,
               iPersistence,
-              std::move(iValueValidator));
+              iConstraint);
 }
 
 //------------------------------------------------------------------------
@@ -2156,44 +3077,37 @@ void impl::JboxObject::addProperty(const std::string &iPropertyName,
                                    TJBox_Tag iPropertyTag,
                                    int iStepCount,
                                    lua::EPersistence iPersistence,
-                                   value_validator_t iValueValidator)
-{
-  RE_MOCK_ASSERT(fProperties.find(iPropertyName) == fProperties.end(), "duplicate property [%s] for object [%s]", iPropertyName, fInfo.fObjectPath);
-  // create a validator that checks the step count (if none provided)
-  if(iStepCount > 0 && !iValueValidator)
-  {
-    iValueValidator = [iStepCount](auto const &iValue) {
-      if(iValue.getValueType() == kJBox_Nil)
-        return true;
-      switch(iValue.getValueType())
-      {
-        case kJBox_Nil:
-          return true;
-
-        case kJBox_Number:
-        {
-          auto step = static_cast<int>(iValue.getNumber());
-          return step >= 0 && step < iStepCount;
-        }
-
-        case kJBox_Boolean:
-          return iStepCount == 2;
-
-        default:
-          return false;
-      }
-    };
-  }
-  fProperties[iPropertyName] =
-    std::make_unique<JboxProperty>(JBox_MakePropertyRef(fInfo.fObjectRef, iPropertyName.c_str()),
-                                   fmt::printf("%s/%s", fInfo.fObjectPath, iPropertyName),
-                                   iValueType,
-                                   iStepCount,
-                                   iOwner,
-                                   iInitialValue,
-                                   iPropertyTag,
-                                   std::move(iValueValidator),
-                                   iPersistence);
+                                   JboxValueConstraint iConstraint)
+{
+  auto iter = std::lower_bound(fSortedPropertyDefs.begin(),
+                               fSortedPropertyDefs.end(),
+                               iPropertyName,
+                               [this](auto i, auto const &name) { return fPropertyDefs[i].fName < name; });
+  RE_MOCK_ASSERT(iter == fSortedPropertyDefs.end() || fPropertyDefs[*iter].fName != iPropertyName,
+                 "duplicate property [%s] for object [%s]", iPropertyName, fInfo.fObjectPath);
+
+  // constrain the step count (if no other constraint provided)
+  if(iStepCount > 0 && iConstraint.isNone())
+    iConstraint = JboxValueConstraint::stepCount(iStepCount);
+
+  // the initial value is validated now (and not when the property is materialised) so that errors are reported early
+  RE_MOCK_ASSERT(iInitialValue->getValueType() == toJBoxValueType(toJboxPropertyType(iValueType)) ||
+                 iInitialValue->getValueType() == TJBox_ValueType::kJBox_Nil,
+                 "invalid property type for [%s/%s]", fInfo.fObjectPath, iPropertyName);
+  RE_MOCK_ASSERT(iConstraint.accept(*iInitialValue), "Value failed validation for property [%s/%s]", fInfo.fObjectPath, iPropertyName);
+
+  fSortedPropertyDefs.insert(iter, static_cast<TJBox_UInt32>(fPropertyDefs.size()));
+  fPropertyDefs.emplace_back(PropertyDef{
+    /* .fName = */         iPropertyName,
+    /* .fInitialValue = */ std::move(iInitialValue),
+    /* .fConstraint = */   iConstraint,
+    /* .fTag = */          iPropertyTag,
+    /* .fStepCount = */    iStepCount,
+    /* .fOwner = */        iOwner,
+    /* .fValueType = */    iValueType,
+    /* .fPersistence = */  iPersistence
+  });
+  fProperties.emplace_back(nullptr);
 }
 
 //------------------------------------------------------------------------
@@ -2201,8 +3115,7 @@ void impl::JboxObject::addProperty(const std::string &iPropertyName,
 //------------------------------------------------------------------------
 impl::JboxPropertyDiff impl::JboxObject::watchPropertyForChange(std::string const &iPropertyName)
 {
-  RE_MOCK_ASSERT(fProperties.find(iPropertyName) != fProperties.end(), "missing property [%s] for object [%s]", iPropertyName, fInfo.fObjectPath);
-  return fProperties[iPropertyName]->watchForChange();
+  return getProperty(iPropertyName)->watchForChange();
 }
 
 //------------------------------------------------------------------------
@@ -2212,7 +3125,7 @@ std::vector<impl::JboxPropertyDiff> impl::JboxObject::watchAllPropertiesForChang
 {
   std::vector<impl::JboxPropertyDiff> res{};
 
-  for(auto &[k, property] : fProperties)
+  for(auto property: getProperties())
     res.emplace_back(property->watchForChange());
 
   return res;
@@ -2228,7 +3141,7 @@ impl::JboxProperty::JboxProperty(TJBox_PropertyRef const &iPropertyRef,
                                  PropertyOwner iOwner,
                                  std::shared_ptr<JboxValue> iInitialValue,
                                  TJBox_Tag iTag,
-                                 value_validator_t iValueValidator,
+                                 JboxValueConstraint iConstraint,
                                  lua::EPersistence iPersistence) :
 fInfo{iPropertyRef,
       std::move(iPropertyPath),
@@ -2239,17 +3152,18 @@ fInfo{iPropertyRef,
       iPersistence},
   fInitialValue{iInitialValue},
   fValue{iInitialValue},
-  fValueValidator{std::move(iValueValidator)}
+  fConstraint{iConstraint}
 {
-  validateValue(iInitialValue);
+  // the initial value has already been validated (see JboxObject::addProperty)
 }
 
 //------------------------------------------------------------------------
 // JboxProperty::storeValue
 //------------------------------------------------------------------------
-impl::JboxPropertyDiff impl::JboxProperty::storeValue(std::shared_ptr<JboxValue> iValue)
+impl::JboxPropertyDiff impl::JboxProperty::storeValue(std::shared_ptr<JboxValue> iValue, bool iValidate)
 {
-  validateValue(iValue);
+  if(iValidate)
+    validateValue(*iValue);
 
   auto previousValue = fValue;
   fValue = std::move(iValue);
@@ -2281,19 +3195,6 @@ impl::JboxPropertyDiff impl::JboxProperty::watchForChange()
   };
 }
 
-//------------------------------------------------------------------------
-// JboxProperty::validateValue
-//------------------------------------------------------------------------
-void impl::JboxProperty::validateValue(std::shared_ptr<JboxValue> const &iValue)
-{
-  RE_MOCK_ASSERT(iValue->getValueType() == toJBoxValueType(fInfo.fValueType) ||
-                 iValue->getValueType() == TJBox_ValueType::kJBox_Nil,
-                 "invalid property type for [%s]", fInfo.fPropertyPath);
-
-  if(fValueValidator)
-    RE_MOCK_ASSERT(fValueValidator(*iValue.get()), "Value failed validation for property [%s]", fInfo.fPropertyPath);
-}
-
 //------------------------------------------------------------------------
 // impl::Blob::getBlobInfo
 //------------------------------------------------------------------------
@@ -29,6 +29,8 @@
 #include <vector>
 #include <set>
 #include <array>
+#include <bitset>
+#include <optional>
 #include <ostream>
 #include "fmt.h"
 #include "Constants.h"
@@ -38,6 +40,11 @@
 #include "lua/MotherboardDef.h"
 #include "lua/RealtimeController.h"
 #include "PatchParser.h"
+#include "TraceRing.h"
+#include "JboxProfiler.h"
+#include "InputRecording.h"
+#include "StateArchive.h"
+#include "MemoryAccounting.h"
 
 bool operator==(TJBox_NoteEvent const &lhs, TJBox_NoteEvent const &rhs);
 bool operator!=(TJBox_NoteEvent const &lhs, TJBox_NoteEvent const &rhs);
@@ -47,15 +54,74 @@ bool compare(TJBox_NoteEvent const &l, TJBox_NoteEvent const &r);
 namespace re::mock { class Rack; }
 namespace re::mock::rack { class Extension; }
 namespace re::mock::lua { class RealtimeController; }
+namespace re::mock::sequencer { class Track; }
 
 namespace re::mock {
 
+/**
+ * A patch resolved against a given motherboard (see `Motherboard::compilePatch()`): each property has been looked up
+ * and validated once and each value has been pre-built, so that applying it (`Motherboard::loadPatch()`) is a simple
+ * loop which does no path resolution. A compiled patch can be applied any number of times, but only to the
+ * motherboard that compiled it. */
+class CompiledPatch
+{
+public:
+  inline size_t size() const { return fEntries.size(); }
+
+  friend class Motherboard;
+
+private:
+  struct Entry
+  {
+    impl::JboxProperty *fProperty;
+    std::shared_ptr<JboxValue> fValue; // immutable once compiled (nullptr for samples)
+    std::string fSamplePath{};         // only for samples
+  };
+
+  Motherboard const *fMotherboard{};
+  std::vector<Entry> fEntries{};
+};
+
+/**
+ * The state of a motherboard captured by `Motherboard::snapshot()`. Since property values are immutable (storing a
+ * property replaces its value), they are shared with the motherboard rather than copied. The exceptions are read/write
+ * native objects (cloned with `Realtime::clone_native_object`) and socket buffers (not captured since they are
+ * rewritten every batch). A snapshot can be restored any number of times, but only in the motherboard that took it. */
+class MotherboardSnapshot
+{
+public:
+  inline size_t size() const { return fEntries.size(); }
+
+  friend class Motherboard;
+
+private:
+  struct Entry
+  {
+    impl::JboxProperty *fProperty;
+    std::shared_ptr<JboxValue> fValue;
+    bool fPatchDirty;
+    //! sample/blob decoded by `Motherboard::decodeState()` (`fValue` is only loaded when applied)
+    std::string fResourcePath{};
+    TJBox_ObjectRef fSampleItem{};
+  };
+
+  Motherboard const *fMotherboard{};
+  std::vector<Entry> fEntries{};
+  std::bitset<128> fActiveNotes{};
+  std::vector<impl::JboxPropertyDiff> fRTCNotifyDiffs{};
+  std::vector<impl::JboxPropertyDiff> fRTCBindingsDiffs{};
+  std::vector<TJBox_NoteEvent> fNoteOutEvents{};
+  std::vector<impl::JboxProperty *> fDirtyPatchProperties{};
+};
+
 class Motherboard
 {
 public:
   constexpr static size_t DSP_BUFFER_SIZE = constants::kBatchSize;
   constexpr static int FIRST_MIDI_NOTE = 0;
   constexpr static int LAST_MIDI_NOTE = 127;
+  //! Note event buffers are preallocated with this capacity per batch (they only grow past it if needed)
+  constexpr static size_t NOTE_EVENTS_CAPACITY = 256;
   using DSPBuffer = std::array<TJBox_AudioSample, DSP_BUFFER_SIZE>;
   using NoteEvents = std::vector<TJBox_NoteEvent>;
 
@@ -103,12 +169,17 @@ public: // used by regular code
   TJBox_OnOffBypassStates getEffectBypassState() const { return static_cast<TJBox_OnOffBypassStates>(getNum<int>("/custom_properties/builtin_onoffbypass")); }
   void setEffectBypassState(TJBox_OnOffBypassStates iState) { setNum("/custom_properties/builtin_onoffbypass", static_cast<int>(iState)); }
 
-  bool isNotePlayerBypassed() const { return getBool("/environment/player_bypassed"); }
+  bool isNotePlayerBypassed() const;
   void setNotePlayerBypassed(bool iBypassed) { setBool("/environment/player_bypassed", iBypassed); }
 
   void setNoteInEvent(TJBox_UInt8 iNoteNumber, TJBox_UInt8 iVelocity, TJBox_UInt16 iAtFrameIndex = 0);
   inline void setNoteInEvent(TJBox_NoteEvent const &iNoteEvent) { setNoteInEvent(iNoteEvent.fNoteNumber, iNoteEvent.fVelocity, iNoteEvent.fAtFrameIndex); };
-  void setNoteInEvents(NoteEvents const &iNoteEvents);
+  inline void setNoteInEvents(NoteEvents const &iNoteEvents) { setNoteInEvents(iNoteEvents.data(), iNoteEvents.size()); }
+
+  /**
+   * Sets all the note events at once: the events are validated up front and then stored directly in their
+   * `/note_states` slot, so either all events are applied or none is. */
+  void setNoteInEvents(TJBox_NoteEvent const *iNoteEvents, std::size_t iCount);
 
   void setDSPBuffer(std::string const &iAudioSocketPath, DSPBuffer iBuffer);
   DSPBuffer getDSPBuffer(std::string const &iAudioSocketPath) const;
@@ -122,6 +193,9 @@ public: // used by regular code
 
   void stopNoteIfOn(TJBox_UInt8 iNoteNumber);
 
+  //! Returns the notes currently on (kept in sync with `/note_states`)
+  std::bitset<128> const &getActiveNotes() const { return fActiveNotes; }
+
   template<typename T>
   inline T *getNativeObjectRW(std::string const &iPropertyPath) const {
     return reinterpret_cast<T *>(getNativeObjectRW(getValue(iPropertyPath)));
@@ -139,12 +213,64 @@ public: // used by regular code
   void loadPatch(resource::String const &iPatchString);
   void loadPatch(resource::File const &iPatchFile);
   void loadPatch(resource::Patch const &iPatch);
+  void loadPatch(CompiledPatch const &iPatch);
 
-  resource::Patch generatePatch() const;
+  /**
+   * Resolves and validates the patch against this motherboard (throws if a property does not exist, is not persisted
+   * in patches or if the type of the value is not the type of the property) */
+  CompiledPatch compilePatch(resource::Patch const &iPatch) const;
 
-  resource::Patch const &getDefaultValuesPatch() const { return fDefaultValuesPatch; }
+  resource::Patch generatePatch() const;
 
-  void reset() { loadPatch(fDefaultValuesPatch); }
+  /**
+   * Generates a patch containing only the properties (persisted in patches) which have been stored since the
+   * previous call (or since the device was created). Unlike `generatePatch()`, the cost of this call is proportional
+   * to the number of changes, not the number of properties.
+   *
+   * @note a property that was set and then set back to its previous value is still part of the delta */
+  resource::Patch generatePatchDelta();
+
+  //! The patch containing the default value of every property persisted in patches (generated on first call)
+  resource::Patch const &getDefaultValuesPatch() const;
+
+  /**
+   * Captures the state of all the properties (as well as the diffs not yet delivered to the device) so that it can
+   * be restored later with `restore()`.
+   *
+   * @note throws if the device uses a read/write native object and `Realtime::clone_native_object` is not set */
+  std::shared_ptr<const MotherboardSnapshot> snapshot() const;
+
+  /**
+   * Restores the state captured by `snapshot()`: the values are put back as-is, without generating any diff (the
+   * device sees the state it had when the snapshot was taken)
+   *
+   * @note the Lua state of the realtime controller (globals set by the rtc bindings) is not rewound */
+  void restore(MotherboardSnapshot const &iSnapshot);
+
+  /**
+   * Writes the full state of the motherboard in binary form (see `StateArchive`): every property value (socket
+   * buffers excepted since they are rewritten every batch), samples and blobs as references to their resource, and
+   * native objects when `Realtime::serialize_native_object` is provided (skipped otherwise). */
+  void saveState(StateArchive::Writer &oWriter) const;
+
+  /**
+   * Decodes (and validates against the property definitions) the state written by `saveState()` without changing the
+   * motherboard, so that a state which cannot be read leaves the motherboard untouched. The result is applied with
+   * `loadState()`.
+   *
+   * @throw Exception if the state does not match this motherboard (created from a different config) */
+  std::unique_ptr<MotherboardSnapshot> decodeState(StateArchive::Reader &iReader);
+
+  /**
+   * Applies a state decoded by `decodeState()` (cannot fail). Unlike `restore()`, the device did not see this state
+   * before: every watched property (`rt_input_setup.notify`, rtc bindings) whose value changes gets a diff delivered
+   * on the next batch, after the ones still pending. Samples and blobs are only loaded at this point. */
+  void loadState(std::unique_ptr<MotherboardSnapshot> iState);
+
+  //! Decodes the state written by `saveState()` then applies it
+  void loadState(StateArchive::Reader &iReader) { loadState(decodeState(iReader)); }
+
+  void reset();
 
   inline void selectCurrentUserSample(int iUserSampleIndex) { setNum<int>("/device_host/sample_context", iUserSampleIndex); }
 
@@ -184,6 +310,8 @@ public: // used by regular code
   void clearResourceLoadingContext(std::string const &iResourcePath) { fResourceLoadingContexts.erase(iResourcePath); }
 
   bool isSameValue(TJBox_Value const &lhs, TJBox_Value const &rhs) const;
+  //! Same as above without going through `TJBox_Value` (samples, blobs... are only the same when they are the same value)
+  bool isSameValue(JboxValue const &lhs, JboxValue const &rhs) const;
   inline std::string toString(TJBox_Value const &iValue, char const *iFormat = nullptr) const {
     return toString(*from_TJBox_Value(iValue), iFormat); }
   std::string toString(std::string const &iPropertyPath, char const *iFormat = nullptr) const { return toString(getValue(iPropertyPath), iFormat); }
@@ -193,6 +321,25 @@ public: // used by regular code
   JboxPropertyInfo const &getPropertyInfo(std::string const &iPropertyPath) const { return getProperty(iPropertyPath)->fInfo; }
   std::vector<JboxPropertyInfo> getPropertyInfos() const;
   std::vector<JboxObjectInfo> getObjectInfos() const;
+
+  //! Number of properties defined by the device (including the built-in ones: transport, note states...)
+  size_t getPropertyCount() const;
+
+  //! Number of properties materialised so far (a property is only materialised on first access)
+  size_t getMaterializedPropertyCount() const;
+
+  /**
+   * Memory used by this device broken down by subsystem. Every number is measured by the counting allocators (see
+   * `MemoryAccounting`) and not estimated, so it can be used to enforce memory budgets in tests. Besides the
+   * motherboard itself, the report includes the memory charged to the device by its sequencer track, the tester
+   * timelines and `MAUDst` (captured samples). */
+  MemoryReport memoryReport() const { return fMemoryAccounting.report(); }
+
+  //! Counter for the subsystem (memory owned outside the motherboard can be charged to this device)
+  std::shared_ptr<MemoryCounter> const &getMemoryCounter(MemoryReport::Subsystem iSubsystem) const
+  {
+    return fMemoryAccounting.getCounter(iSubsystem);
+  }
   Info const &getDeviceInfo() const { return fConfig.info(); }
 
   void enableRTCNotify();
@@ -200,6 +347,14 @@ public: // used by regular code
   void enableRTCBindings();
   void disableRTCBindings();
 
+  /**
+   * Values stored by the device while rendering are validated (type / step count / range...) by default. Disabling
+   * render validation skips these checks (the values stored via the api, outside of rendering, are always
+   * validated) which is meant for long renders of a device already known to be well-behaved. */
+  void enableRenderValidation() { fRenderValidationEnabled = true; }
+  void disableRenderValidation() { fRenderValidationEnabled = false; }
+  bool isRenderValidationEnabled() const { return fRenderValidationEnabled; }
+
 public: // used by Jukebox.cpp (need to be public)
   TJBox_ObjectRef getObjectRef(std::string const &iObjectPath) const;
   TJBox_Tag getPropertyTag(TJBox_PropertyRef const &iPropertyRef) const;
@@ -215,8 +370,8 @@ public: // used by Jukebox.cpp (need to be public)
   void getDSPBufferData(TJBox_Value const &iValue, TJBox_AudioFramePos iStartFrame, TJBox_AudioFramePos iEndFrame, TJBox_AudioSample oAudio[]) const;
   void setDSPBufferData(TJBox_Value const &iValue, TJBox_AudioFramePos iStartFrame, TJBox_AudioFramePos iEndFrame, const TJBox_AudioSample iAudio[]);
   TJBox_DSPBufferInfo getDSPBufferInfo(TJBox_Value const &iValue) const;
-  std::unique_ptr<JboxValue> makeNativeObjectRW(std::string const &iOperation, std::vector<std::shared_ptr<const JboxValue>> const &iParams);
-  std::unique_ptr<JboxValue> makeNativeObjectRO(std::string const &iOperation, std::vector<std::shared_ptr<const JboxValue>> const &iParams);
+  std::shared_ptr<JboxValue> makeNativeObjectRW(std::string const &iOperation, std::vector<std::shared_ptr<const JboxValue>> const &iParams);
+  std::shared_ptr<JboxValue> makeNativeObjectRO(std::string const &iOperation, std::vector<std::shared_ptr<const JboxValue>> const &iParams);
   const void *getNativeObjectRO(TJBox_Value const &iValue) const;
   void *getNativeObjectRW(TJBox_Value const &iValue) const;
   void setRTStringData(TJBox_PropertyRef const &iProperty, TJBox_SizeT iSize, const TJBox_UInt8 iData[]);
@@ -224,8 +379,8 @@ public: // used by Jukebox.cpp (need to be public)
   void getSubstring(TJBox_Value iValue, TJBox_SizeT iStart, TJBox_SizeT iEnd, char oString[]) const;
   TJBox_NoteEvent asNoteEvent(const TJBox_PropertyDiff &iPropertyDiff);
   void outputNoteEvent(TJBox_NoteEvent const &iNoteEvent);
-  NoteEvents getNoteOutEvents() const { return fNoteOutEvents; }
-  std::unique_ptr<JboxValue> loadBlobAsync(std::string const &iBlobPath);
+  NoteEvents const &getNoteOutEvents() const { return fNoteOutEvents; }
+  std::shared_ptr<JboxValue> loadBlobAsync(std::string const &iBlobPath);
   impl::Blob::Info getBLOBInfo(JboxValue const &iValue) const;
   inline impl::Blob::Info getBLOBInfo(TJBox_Value const &iValue) const { return getBLOBInfo(*from_TJBox_Value(iValue)); }
   void getBLOBData(TJBox_Value const &iValue, TJBox_SizeT iStart, TJBox_SizeT iEnd, TJBox_UInt8 oData[]) const;
@@ -235,9 +390,54 @@ public: // used by Jukebox.cpp (need to be public)
   inline impl::Sample::Metadata getSampleMetadata(TJBox_Value const &iValue) const { return getSampleMetadata(*from_TJBox_Value(iValue)); }
   void getSampleData(TJBox_Value iValue, TJBox_AudioFramePos iStartFrame, TJBox_AudioFramePos iEndFrame, TJBox_AudioSample oAudio[]) const;
 
-  std::unique_ptr<JboxValue> loadSampleAsync(std::string const &iSamplePath);
+  std::shared_ptr<JboxValue> loadSampleAsync(std::string const &iSamplePath);
 
   void trace(const char *iFile, TJBox_Int32 iLine, const char *iMessage) const;
+  void traceValues(const char *iFile, TJBox_Int32 iLine, const char *iTemplate, const TJBox_Value iValues[], TJBox_Int32 iValueCount) const;
+
+  /**
+   * Traces are recorded in a ring buffer (no formatting / output during `JBOX_TRACE`). This call formats and
+   * outputs them (and reports if any was dropped since the last call).
+   *
+   * @return the number of traces flushed */
+  size_t flushTraces(std::ostream &oStream);
+
+  TraceRing::Stats getTraceStats() const { return fTraceRing ? fTraceRing->getStats() : TraceRing::Stats{}; }
+
+  //! Enables profiling of the `JBox_xxx` api calls (no-op if already enabled)
+  void enableJboxProfiler() { if(!fJboxProfiler) fJboxProfiler = std::make_unique<JboxProfiler>(); }
+
+  //! Disables profiling of the `JBox_xxx` api calls (discards the counters)
+  void disableJboxProfiler() { fJboxProfiler = nullptr; }
+
+  //! Resets the counters (no-op if not enabled)
+  void resetJboxProfiler() { if(fJboxProfiler) fJboxProfiler->reset(); }
+
+  //! Returns a copy of the counters (empty if not enabled)
+  JboxProfiler::Snapshot getJboxProfilerSnapshot() const { return fJboxProfiler ? fJboxProfiler->getSnapshot() : JboxProfiler::Snapshot{}; }
+
+  //! Returns `nullptr` when profiling is disabled
+  inline JboxProfiler *getJboxProfiler() const { return fJboxProfiler.get(); }
+
+  /**
+   * Starts recording the inputs of this device into `iFilePath` (see `InputRecording`): the current value of the
+   * properties first, then every batch, the properties stored by the host and the content of the audio inputs.
+   * Restarts the recording if already recording. */
+  void startInputRecording(std::string const &iFilePath);
+
+  //! Stops recording (the file is complete) and returns the number of batches recorded (0 if not recording)
+  size_t stopInputRecording();
+
+  bool isRecordingInputs() const { return fInputRecorder != nullptr; }
+
+  /**
+   * Replays a recording made with `startInputRecording()`: this motherboard should be a fresh instance of the
+   * recorded device. The rtc bindings are disabled while replaying since their effect is part of the recording. The
+   * recorded state (`InputRecording::Record::kState`) is stored like any other value, so it reaches the device as
+   * diffs on the first replayed batch (unlike during the recording).
+   *
+   * @return the number of batches replayed */
+  size_t replayInputs(InputRecording const &iRecording);
 
   Motherboard(Motherboard const &iOther) = delete;
   Motherboard &operator=(Motherboard const &iOther) = delete;
@@ -248,6 +448,7 @@ public: // used by Jukebox.cpp (need to be public)
   friend class re::mock::Rack;
   friend class re::mock::rack::Extension;
   friend class re::mock::lua::RealtimeController;
+  friend class re::mock::sequencer::Track;
 
 protected:
 
@@ -265,6 +466,11 @@ protected:
 
   void storeProperty(TJBox_PropertyRef const &iProperty, std::shared_ptr<const JboxValue> const &iValue, TJBox_UInt16 iAtFrameIndex = 0);
   void storeProperty(TJBox_ObjectRef iObject, TJBox_Tag iTag, std::shared_ptr<const JboxValue> const &iValue, TJBox_UInt16 iAtFrameIndex = 0);
+  void storeProperty(impl::JboxProperty *iProperty, std::shared_ptr<const JboxValue> const &iValue, TJBox_UInt16 iAtFrameIndex);
+  void storeNoteState(TJBox_UInt8 iNoteNumber, TJBox_UInt8 iVelocity, TJBox_UInt16 iAtFrameIndex);
+
+  static void addToPatch(resource::Patch &oPatch, impl::JboxProperty const *iProperty);
+  static void addToPatch(resource::Patch &oPatch, std::string const &iPropertyPath, JboxValue const &iValue);
 
   inline void setValue(std::string const &iPropertyPath, std::shared_ptr<const JboxValue> const &iValue) {
     storeProperty(getPropertyRef(iPropertyPath), iValue);
@@ -289,15 +495,23 @@ protected:
   impl::JboxPropertyDiff registerRTCBinding(std::string const &iPropertyPath, std::string const &iBindingName);
   void handlePropertyDiff(impl::JboxPropertyDiff const &iPropertyDiff, bool iWatched);
 
-  std::unique_ptr<JboxValue> makeDSPBuffer() const;
-  std::unique_ptr<JboxValue> makeRTString(int iMaxSize) const;
-  std::unique_ptr<JboxValue> makeString(std::string iValue) const;
-  std::unique_ptr<JboxValue> makeNil() const;
-  std::unique_ptr<JboxValue> makeIncompatible() const;
-  std::unique_ptr<JboxValue> makeNumber(TJBox_Float64 iValue) const;
-  std::unique_ptr<JboxValue> makeBoolean(bool iValue) const;
-  std::unique_ptr<JboxValue> makeEmptySample(TJBox_ObjectRef iSampleItem = 0) const;
-  std::unique_ptr<JboxValue> makeEmptyBlob() const;
+  //! Allocates a `T` whose memory is reported to the counter of the subsystem (see `memoryReport()`)
+  template<typename T, typename Base = std::allocator<T>>
+  std::shared_ptr<T> allocateShared(MemoryReport::Subsystem iSubsystem) const
+  {
+    return std::allocate_shared<T>(fMemoryAccounting.getAllocator<T, Base>(iSubsystem));
+  }
+
+  std::shared_ptr<JboxValue> newJboxValue() const;
+  std::shared_ptr<JboxValue> makeDSPBuffer() const;
+  std::shared_ptr<JboxValue> makeRTString(int iMaxSize) const;
+  std::shared_ptr<JboxValue> makeString(std::string iValue) const;
+  std::shared_ptr<JboxValue> makeNil() const;
+  std::shared_ptr<JboxValue> makeIncompatible() const;
+  std::shared_ptr<JboxValue> makeNumber(TJBox_Float64 iValue) const;
+  std::shared_ptr<JboxValue> makeBoolean(bool iValue) const;
+  std::shared_ptr<JboxValue> makeEmptySample(TJBox_ObjectRef iSampleItem = 0) const;
+  std::shared_ptr<JboxValue> makeEmptyBlob() const;
 
   TJBox_PropertyRef getPropertyRef(std::string const &iPropertyPath) const;
 
@@ -309,8 +523,12 @@ protected:
 
   TJBox_Float64 getCVSocketValue(TJBox_ObjectRef iCVSocket) const;
   void setCVSocketValue(TJBox_ObjectRef iCVSocket, TJBox_Float64 iValue);
+  //! Returns the `value` property of the cv socket (resolved once per wire by the rack)
+  impl::JboxProperty *getCVSocketValueProperty(TJBox_ObjectRef iCVSocket) const;
+  //! Stores the value directly in the (resolved) property: nothing happens if the value has not changed
+  void setCVSocketValue(impl::JboxProperty *iValueProperty, TJBox_Float64 iValue);
 
-  std::unique_ptr<JboxValue> makeNativeObject(std::string const &iOperation,
+  std::shared_ptr<JboxValue> makeNativeObject(std::string const &iOperation,
                                               std::vector<std::shared_ptr<const JboxValue>> const &iParams,
                                               impl::NativeObject::AccessMode iAccessMode);
 
@@ -321,6 +539,18 @@ protected:
   TJBox_Value to_TJBox_Value(std::shared_ptr<const JboxValue> const &iValue) const;
   std::shared_ptr<const JboxValue> from_TJBox_Value(TJBox_Value const &iValue) const;
 
+  //! Direct access to the socket buffer encoded in `iValue` (no lookup)
+  inline impl::DSPBuffer &getDSPBufferFromValue(TJBox_Value const &iValue) const
+  {
+    auto handle = impl::jbox_get_value<impl::DSPBufferHandle>(kJBox_DSPBuffer, iValue);
+    RE_MOCK_ASSERT(handle.fBatchId == fBatchId && handle.fIndex < fDSPBufferTable.size(),
+                   "DSP buffer value is not valid anymore (values must not be kept across batches)");
+    return *fDSPBufferTable[handle.fIndex].fBuffer;
+  }
+
+  void addDSPBuffer(std::shared_ptr<JboxValue> const &iBuffer);
+  std::shared_ptr<JboxValue> cloneNativeObject(JboxValue const &iValue) const;
+
 protected:
 
   static bool compare(TJBox_PropertyRef const &l, TJBox_PropertyRef const &r)
@@ -334,17 +564,35 @@ protected:
   using ComparePropertyRef = decltype(&compare);
 
 protected:
+  MemoryAccounting fMemoryAccounting{}; // first so that it outlives all the memory it accounts for
   Config fConfig;
-  resource::Patch fDefaultValuesPatch{};
+  mutable std::optional<resource::Patch> fDefaultValuesPatch{}; // generated on first use
+  struct PatchPropertyEntry
+  {
+    impl::JboxObject const *fObject;
+    size_t fDefIndex; // index in fObject->fPropertyDefs
+    std::string fPropertyPath;
+  };
+  std::vector<PatchPropertyEntry> fPatchProperties{}; // properties persisted in patches (computed in init)
   std::map<std::string, resource::LoadingContext> fResourceLoadingContexts{};
-  ObjectManager<std::unique_ptr<impl::JboxObject>> fJboxObjects{};
+  SlotObjectManager<counted_unique_ptr<impl::JboxObject>> fJboxObjects{};
   std::map<std::string, TJBox_ObjectRef> fJboxObjectRefs{};
   TJBox_ObjectRef fCustomPropertiesRef{};
   TJBox_ObjectRef fEnvironmentRef{};
   TJBox_ObjectRef fNoteStatesRef{};
+  std::array<impl::JboxProperty *, 128> fNoteStateProperties{}; // direct access (resolved on first store)
+  std::array<std::shared_ptr<JboxValue>, 128> fNoteVelocityValues{}; // immutable so shared by all stores (no allocation)
+  std::bitset<128> fActiveNotes{};
   mutable std::map<TJBox_UInt64, std::shared_ptr<const JboxValue>> fCurrentValues{};
   std::vector<std::shared_ptr<JboxValue>> fInputDSPBuffers{};
   std::vector<std::shared_ptr<JboxValue>> fOutputDSPBuffers{};
+  struct DSPBufferEntry
+  {
+    std::shared_ptr<JboxValue> fValue;
+    impl::DSPBuffer *fBuffer; // never reallocated (setDSPBuffer copies into it)
+  };
+  std::vector<DSPBufferEntry> fDSPBufferTable{}; // all socket buffers (index encoded in the TJBox_Value)
+  TJBox_UInt32 fBatchId{}; // incremented when the current values are cleared
   std::unique_ptr<lua::RealtimeController> fRealtimeController{};
   Realtime fRealtime{};
   std::set<TJBox_PropertyRef, ComparePropertyRef> fRTCNotify{compare};
@@ -355,6 +603,16 @@ protected:
   bool fRTCBindingsEnabled{true};
   std::vector<std::string> fUserSamplePropertyPaths{};
   NoteEvents fNoteOutEvents{};
+  std::vector<impl::JboxPropertyDiff> fBatchDiffs{}; // reused by nextBatch (keeps its capacity)
+  std::vector<TJBox_PropertyDiff> fBatchRTDiffs{}; // reused by nextBatch (keeps its capacity)
+  mutable std::unique_ptr<TraceRing> fTraceRing{}; // allocated on first trace
+  size_t fReportedTraceDroppedCount{};
+  std::optional<CompiledPatch> fCompiledDefaultValuesPatch{}; // compiled on first reset
+  std::vector<impl::JboxProperty *> fDirtyPatchProperties{}; // stored since the last generatePatchDelta()
+  std::unique_ptr<JboxProfiler> fJboxProfiler{}; // only allocated when enabled
+  std::unique_ptr<InputRecording::Writer> fInputRecorder{}; // only allocated when recording
+  bool fRendering{}; // true while the device renders (its own stores are not inputs)
+  bool fRenderValidationEnabled{true};
 
 };
 
@@ -364,10 +622,7 @@ protected:
 template<typename T>
 T *Motherboard::getInstance() const
 {
-  auto instance = getJboxValue("/custom_properties/instance");
-  if(instance->isNil())
-    return nullptr;
-  return reinterpret_cast<T *>(instance->getNativeObject().fNativeObject);
+  return reinterpret_cast<T *>(findInstance());
 }
 
 namespace impl {
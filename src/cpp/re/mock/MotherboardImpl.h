@@ -21,6 +21,9 @@
 #define __Pongasoft_re_mock_motherboard_impl_h__
 
 #include "Errors.h"
+#include "AlignedAllocator.h"
+#include "MemoryAccounting.h"
+#include <cmath>
 
 namespace re::mock {
 
@@ -33,6 +36,8 @@ struct Blob;
 struct Sample;
 constexpr static size_t DSP_BUFFER_SIZE = 64;
 using DSPBuffer = std::array<TJBox_AudioSample, DSP_BUFFER_SIZE>;
+//! Actual storage for a socket buffer (aligned so that devices can use aligned SIMD loads/stores)
+struct alignas(kAudioAlignment) AlignedDSPBuffer : public DSPBuffer {};
 }
 
 class JboxValue
@@ -41,16 +46,20 @@ public:
 
   friend class Motherboard;
 
+  JboxValue() = default;
+  JboxValue(JboxValue const &) = delete; // payloads are never shared between values
+  JboxValue &operator=(JboxValue const &) = delete;
+
   TJBox_ValueType getValueType() const { return fValueType; }
   TJBox_UInt64 getUniqueId() const { return reinterpret_cast<TJBox_UInt64>(this); }
 
   TJBox_Float64 getNumber() const { return std::get<TJBox_Float64>(fMotherboardValue); }
   bool getBoolean() const { return std::get<bool>(fMotherboardValue); }
-  impl::String const &getString() const { return *std::get<std::unique_ptr<impl::String>>(fMotherboardValue); }
-  impl::NativeObject const &getNativeObject() const { return *std::get<std::unique_ptr<impl::NativeObject>>(fMotherboardValue); }
-  impl::Blob const &getBlob() const { return *std::get<std::unique_ptr<impl::Blob>>(fMotherboardValue); }
-  impl::Sample const &getSample() const { return *std::get<std::unique_ptr<impl::Sample>>(fMotherboardValue); }
-  impl::DSPBuffer const &getDSPBuffer() const { return *std::get<std::unique_ptr<impl::DSPBuffer>>(fMotherboardValue); }
+  impl::String const &getString() const { return *std::get<std::shared_ptr<impl::String>>(fMotherboardValue); }
+  impl::NativeObject const &getNativeObject() const { return *std::get<std::shared_ptr<impl::NativeObject>>(fMotherboardValue); }
+  impl::Blob const &getBlob() const { return *std::get<std::shared_ptr<impl::Blob>>(fMotherboardValue); }
+  impl::Sample const &getSample() const { return *std::get<std::shared_ptr<impl::Sample>>(fMotherboardValue); }
+  impl::DSPBuffer const &getDSPBuffer() const { return *std::get<std::shared_ptr<impl::AlignedDSPBuffer>>(fMotherboardValue); }
 
   bool isNil() const { return std::holds_alternative<nil_t>(fMotherboardValue); }
 
@@ -63,18 +72,18 @@ private:
     TJBox_Float64,
     bool,
     incompatible_t,
-    std::unique_ptr<impl::String>,
-    std::unique_ptr<impl::NativeObject>,
-    std::unique_ptr<impl::Blob>,
-    std::unique_ptr<impl::Sample>,
-    std::unique_ptr<impl::DSPBuffer>
+    std::shared_ptr<impl::String>,
+    std::shared_ptr<impl::NativeObject>,
+    std::shared_ptr<impl::Blob>,
+    std::shared_ptr<impl::Sample>,
+    std::shared_ptr<impl::AlignedDSPBuffer>
   >;
 
 private:
-  impl::DSPBuffer &getDSPBuffer() { return *std::get<std::unique_ptr<impl::DSPBuffer>>(fMotherboardValue); }
-  impl::Blob &getBlob() { return *std::get<std::unique_ptr<impl::Blob>>(fMotherboardValue); }
-  impl::Sample &getSample() { return *std::get<std::unique_ptr<impl::Sample>>(fMotherboardValue); }
-  impl::String &getString() { return *std::get<std::unique_ptr<impl::String>>(fMotherboardValue); }
+  impl::DSPBuffer &getDSPBuffer() { return *std::get<std::shared_ptr<impl::AlignedDSPBuffer>>(fMotherboardValue); }
+  impl::Blob &getBlob() { return *std::get<std::shared_ptr<impl::Blob>>(fMotherboardValue); }
+  impl::Sample &getSample() { return *std::get<std::shared_ptr<impl::Sample>>(fMotherboardValue); }
+  impl::String &getString() { return *std::get<std::shared_ptr<impl::String>>(fMotherboardValue); }
 
 private:
   TJBox_ValueType fValueType{kJBox_Nil};
@@ -130,6 +139,16 @@ T jbox_get_value(TJBox_ValueType iValueType, TJBox_Value const &iJboxValue)
   return secret.fValue;
 }
 
+/**
+ * What a `TJBox_Value` of type `kJBox_DSPBuffer` encodes: a direct index in the socket buffer table of the
+ * motherboard (so that `JBox_GetDSPBufferData` / `JBox_SetDSPBufferData` do not need any lookup) and the batch
+ * it was loaded in (a value is only valid for the duration of the batch). */
+struct DSPBufferHandle
+{
+  TJBox_UInt32 fIndex;
+  TJBox_UInt32 fBatchId;
+};
+
 struct JboxPropertyDiff
 {
   std::shared_ptr<JboxValue> fPreviousValue;
@@ -140,7 +159,31 @@ struct JboxPropertyDiff
   int fInsertIndex{};
 };
 
-using value_validator_t = std::function<bool(JboxValue const &)>;
+/**
+ * Constraint on the values a property accepts, checked on every store. It is plain data (as opposed to a closure) so
+ * that the check is a simple (inlined) switch. */
+struct JboxValueConstraint
+{
+  enum class Type : TJBox_UInt8
+  {
+    kNone,
+    kStepCount,      //!< number in [0, fMax) (booleans are 2 steps)
+    kIntegerRange,   //!< integer number in [fMin, fMax] (ex: an index)
+    kRTStringMaxSize //!< (rt) string of at most fMax characters
+  };
+
+  static JboxValueConstraint none() { return {}; }
+  static JboxValueConstraint stepCount(int iStepCount) { return {Type::kStepCount, 0, static_cast<TJBox_Float64>(iStepCount)}; }
+  static JboxValueConstraint integerRange(TJBox_Float64 iMin, TJBox_Float64 iMax) { return {Type::kIntegerRange, iMin, iMax}; }
+  static JboxValueConstraint rtStringMaxSize(int iMaxSize) { return {Type::kRTStringMaxSize, 0, static_cast<TJBox_Float64>(iMaxSize)}; }
+
+  inline bool isNone() const { return fType == Type::kNone; }
+  inline bool accept(JboxValue const &iValue) const;
+
+  Type fType{Type::kNone};
+  TJBox_Float64 fMin{};
+  TJBox_Float64 fMax{};
+};
 
 struct JboxProperty
 {
@@ -151,12 +194,15 @@ struct JboxProperty
                PropertyOwner iOwner,
                std::shared_ptr<JboxValue> iInitialValue,
                TJBox_Tag iTag,
-               value_validator_t iValueValidator,
+               JboxValueConstraint iConstraint,
                lua::EPersistence iPersistence);
 
   inline std::shared_ptr<const JboxValue> loadValue() const { return fValue; };
   inline std::shared_ptr<JboxValue> loadValue() { return fValue; };
-  JboxPropertyDiff storeValue(std::shared_ptr<JboxValue> iValue);
+  //! Stores the value (validated unless `iValidate` is `false`, see `Motherboard::disableRenderValidation()`)
+  JboxPropertyDiff storeValue(std::shared_ptr<JboxValue> iValue, bool iValidate = true);
+  //! Replaces the value without validation nor diff (see `Motherboard::restore()`)
+  inline void restoreValue(std::shared_ptr<JboxValue> iValue) { fValue = std::move(iValue); }
 
   JboxPropertyDiff watchForChange();
   bool isWatched() const { return fWatched; }
@@ -165,20 +211,34 @@ struct JboxProperty
 
   const JboxPropertyInfo fInfo;
 
+  //! Set when a property persisted in patches is stored (see `Motherboard::generatePatchDelta()`)
+  bool fPatchDirty{};
+
+  JboxValueConstraint const &getConstraint() const { return fConstraint; }
+
 protected:
-  void validateValue(std::shared_ptr<JboxValue> const &iValue);
+  inline void validateValue(JboxValue const &iValue) const;
 
 protected:
   std::shared_ptr<JboxValue> fInitialValue;
   std::shared_ptr<JboxValue> fValue;
-  value_validator_t fValueValidator;
+  JboxValueConstraint fConstraint;
   bool fWatched{};
 };
 
 
+/**
+ * An object (`/custom_properties`, `/note_states`, `/user_samples/0`...) and its properties. The properties are
+ * defined (`addProperty()`) in a compact table (`PropertyDef`) and only materialised (`JboxProperty`, with its path,
+ * ref, diff tracking...) on first access, since most tests only ever touch a handful of the (potentially thousands
+ * of) properties of a device. */
 struct JboxObject
 {
-  JboxObject(JboxObjectType iType, std::string const &iObjectPath, TJBox_ObjectRef iObjectRef);
+  //! The definitions and (materialised) properties are reported to `iCounter`
+  JboxObject(JboxObjectType iType,
+             std::string const &iObjectPath,
+             TJBox_ObjectRef iObjectRef,
+             std::shared_ptr<MemoryCounter> const &iCounter = {});
 
   ~JboxObject() = default;
 
@@ -193,6 +253,12 @@ struct JboxObject
   impl::JboxPropertyDiff watchPropertyForChange(std::string const &iPropertyName);
   bool hasProperty(TJBox_Tag iPropertyTag) const;
 
+  //! Number of properties defined for this object
+  size_t getPropertyCount() const { return fPropertyDefs.size(); }
+
+  //! Number of properties materialised so far (see `JboxObject`)
+  size_t getMaterializedPropertyCount() const;
+
   JboxObjectInfo const &getInfo() const { return fInfo; }
 
   const JboxObjectInfo fInfo;
@@ -200,6 +266,18 @@ struct JboxObject
   friend class re::mock::Motherboard;
 
 protected:
+  struct PropertyDef
+  {
+    std::string fName;
+    std::shared_ptr<JboxValue> fInitialValue; // handed over to the property when materialised (unless persisted in patches)
+    JboxValueConstraint fConstraint;
+    TJBox_Tag fTag;
+    int fStepCount;
+    PropertyOwner fOwner;
+    TJBox_ValueType fValueType;
+    lua::EPersistence fPersistence;
+  };
+
   void addProperty(const std::string &iPropertyName,
                    PropertyOwner iOwner,
                    TJBox_ValueType iValueType,
@@ -207,7 +285,7 @@ protected:
                    TJBox_Tag iPropertyTag,
                    int iStepCount,
                    lua::EPersistence iPersistence = lua::EPersistence::kNone,
-                   value_validator_t iValueValidator = {});
+                   JboxValueConstraint iConstraint = {});
 
   void addProperty(const std::string &iPropertyName,
                    PropertyOwner iOwner,
@@ -215,16 +293,32 @@ protected:
                    TJBox_Tag iPropertyTag,
                    int iStepCount = 0,
                    lua::EPersistence iPersistence = lua::EPersistence::kNone,
-                   value_validator_t iValueValidator = {});
+                   JboxValueConstraint iConstraint = {});
 
   JboxProperty *getProperty(std::string const &iPropertyName) const;
   JboxProperty *findProperty(std::string const &iPropertyName) const;
   JboxProperty *getProperty(TJBox_Tag iPropertyTag) const;
 
+  //! Materialises (if not done yet) and returns all the properties of this object (sorted by name)
+  std::vector<JboxProperty *> getProperties() const;
+
+  /**
+   * Returns the current value of the property at `iIndex` (in `fPropertyDefs`) without materialising it (a property
+   * which has not been materialised yet still has its initial value) */
+  std::shared_ptr<const JboxValue> peekValue(size_t iIndex) const;
+
   std::vector<JboxPropertyInfo> getPropertyInfos() const;
 
+  //! Index (in `fPropertyDefs`) of the property or `-1` if there is no such property
+  int findPropertyIndex(std::string const &iPropertyName) const;
+  int findPropertyIndex(TJBox_Tag iPropertyTag) const;
+
+  JboxProperty *materializeProperty(size_t iIndex) const;
+
 protected:
-  std::map<std::string, std::unique_ptr<JboxProperty>> fProperties{};
+  mutable counted_vector<PropertyDef> fPropertyDefs; // in definition order (mutable: see PropertyDef::fInitialValue)
+  counted_vector<TJBox_UInt32> fSortedPropertyDefs; // indices in fPropertyDefs sorted by name (lookup/iteration order)
+  mutable counted_vector<counted_unique_ptr<JboxProperty>> fProperties; // same index as fPropertyDefs, null until materialised
 };
 
 struct NativeObject
@@ -269,6 +363,7 @@ struct Blob
   TJBox_SizeT getResidentSize() const { return fLoadingContext.fResidentSize; }
 
   std::vector<char> fData{};
+  MemoryCharge fDataCharge{}; // fData charged to the device (see Motherboard::loadBlobAsync)
   resource::LoadingContext fLoadingContext{};
   std::string fBlobPath{};
 };
@@ -293,12 +388,67 @@ struct Sample
 
   TJBox_UInt32 fChannels{1};
   TJBox_UInt32 fSampleRate{1};
-  std::vector<TJBox_AudioSample> fData{};
+  SampleData fData{};
+  MemoryCharge fDataCharge{}; // fData charged to the device (see Motherboard::loadSampleAsync)
   resource::LoadingContext fLoadingContext{};
   TJBox_ObjectRef fSampleItem{};
   std::string fSamplePath{};
 };
 
+//------------------------------------------------------------------------
+// JboxValueConstraint::accept
+//------------------------------------------------------------------------
+inline bool JboxValueConstraint::accept(JboxValue const &iValue) const
+{
+  if(fType == Type::kNone || iValue.getValueType() == kJBox_Nil)
+    return true;
+
+  switch(fType)
+  {
+    case Type::kStepCount:
+      switch(iValue.getValueType())
+      {
+        case kJBox_Number:
+        {
+          auto step = static_cast<int>(iValue.getNumber());
+          return step >= 0 && step < fMax;
+        }
+
+        case kJBox_Boolean:
+          return fMax == 2;
+
+        default:
+          return false;
+      }
+
+    case Type::kIntegerRange:
+    {
+      if(iValue.getValueType() != kJBox_Number)
+        return false;
+      auto number = iValue.getNumber();
+      return number >= fMin && number <= fMax && std::trunc(number) == number;
+    }
+
+    case Type::kRTStringMaxSize:
+      return iValue.getValueType() == kJBox_String && iValue.getString().fValue.size() <= fMax;
+
+    default:
+      return true;
+  }
+}
+
+//------------------------------------------------------------------------
+// JboxProperty::validateValue
+//------------------------------------------------------------------------
+inline void JboxProperty::validateValue(JboxValue const &iValue) const
+{
+  RE_MOCK_ASSERT(iValue.getValueType() == toJBoxValueType(fInfo.fValueType) ||
+                 iValue.getValueType() == TJBox_ValueType::kJBox_Nil,
+                 "invalid property type for [%s]", fInfo.fPropertyPath);
+
+  RE_MOCK_ASSERT(fConstraint.accept(iValue), "Value failed validation for property [%s]", fInfo.fPropertyPath);
+}
+
 }
 }
 
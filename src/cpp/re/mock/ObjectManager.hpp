@@ -21,12 +21,19 @@
 #define __Pongasoft_re_mock_object_manager_h__
 
 #include <map>
+#include <vector>
+#include <limits>
 #include <atomic>
 #include <functional>
 #include "Errors.h"
 
 namespace re::mock {
 
+/**
+ * Manages objects by (generated) key. Keys are never reused.
+ *
+ * @note Thread safety: the key counter is atomic so `add` can be called from multiple threads, but the underlying
+ *       map is not synchronized (concurrent `add`/`remove`/`replace` must be externally synchronized) */
 template<typename O, typename K = int>
 class ObjectManager
 {
@@ -149,6 +156,242 @@ size_t ObjectManager<O, K>::size() const
   return fObjects.size();
 }
 
+/**
+ * Slot map variant of `ObjectManager` (same api) meant for hot lookups:
+ *
+ * - objects live in contiguous memory and iteration happens in insertion order
+ * - `get` is O(1) (no tree traversal): the key encodes the slot index (low `kIndexBits` bits) and the generation
+ *   of the slot (remaining bits)
+ * - a slot freed by `remove` is reused by a subsequent `add` with a new generation, so that a stale key is always
+ *   detected (`get` asserts) instead of returning the wrong object
+ * - `remove` is O(n) (in order to preserve insertion order), which is fine as removal is rare
+ *
+ * Since generation 0 is used for every new slot, keys are 1, 2, 3... as long as nothing is removed, exactly like
+ * `ObjectManager`.
+ *
+ * @note Thread safety: any number of threads can call the `const` methods (`get`, `size`, iteration) concurrently
+ *       as long as no thread modifies the slot map at the same time (`add`, `remove`, `replace`, `clear`, `reset`
+ *       must be externally synchronized with readers and with each other). Contrary to `ObjectManager`, the key
+ *       generation is not atomic (it depends on the free list). */
+template<typename O, typename K = int>
+class SlotObjectManager
+{
+public:
+  using object_type = O;
+  using key_type = K;
+  using value_type = std::pair<K, O>;
+
+  constexpr static int kIndexBits = 20;
+  constexpr static K kIndexMask = (static_cast<K>(1) << kIndexBits) - 1;
+  constexpr static K kMaxGeneration = std::numeric_limits<K>::max() >> kIndexBits;
+
+  K add(std::function<O(int)> iObjectFactory);
+  K add(O &&iObject);
+  void replace(K id, O &&iObject);
+  O const &get(K id) const;
+  O &get(K id);
+  void remove(K id);
+  void clear();
+  void reset();
+  size_t size() const { return fObjects.size(); }
+  bool contains(K id) const { return findIndex(id) >= 0; }
+
+  /**
+   * Two steps version of `add` for objects that are created later (for example on another thread): the key is
+   * reserved now (same key `add` would produce) and the object is invisible until `commit` is called (or the key is
+   * given back with `release` if the object could not be created). */
+  K reserve();
+  K commit(K id, O &&iObject);
+  void release(K id);
+  typename std::vector<value_type>::iterator begin() noexcept { return fObjects.begin(); }
+  typename std::vector<value_type>::iterator end() noexcept { return fObjects.end(); }
+  typename std::vector<value_type>::const_iterator begin() const noexcept { return fObjects.begin(); }
+  typename std::vector<value_type>::const_iterator end() const noexcept { return fObjects.end(); }
+  typename std::vector<value_type>::const_iterator cbegin() const noexcept { return begin(); }
+  typename std::vector<value_type>::const_iterator cend() const noexcept { return end(); }
+
+private:
+  struct Slot
+  {
+    K fGeneration{};
+    int fIndex{-1}; // index in fObjects (-1 when the slot is free)
+  };
+
+  int findIndex(K id) const;
+
+private:
+  std::vector<value_type> fObjects{}; // dense, in insertion order
+  std::vector<Slot> fSlots{};
+  std::vector<K> fFreeSlots{};
+};
+
+//------------------------------------------------------------------------
+// SlotObjectManager::reserve
+//------------------------------------------------------------------------
+template<typename O, typename K>
+K SlotObjectManager<O, K>::reserve()
+{
+  K slot;
+  if(!fFreeSlots.empty())
+  {
+    slot = fFreeSlots.back();
+    fFreeSlots.pop_back();
+  }
+  else
+  {
+    RE_MOCK_ASSERT(fSlots.size() < kIndexMask, "Too many objects (max %d)", kIndexMask);
+    slot = static_cast<K>(fSlots.size());
+    fSlots.emplace_back();
+  }
+
+  // + 1 so that a key is never 0
+  return (fSlots[slot].fGeneration << kIndexBits) | (slot + 1);
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::commit
+//------------------------------------------------------------------------
+template<typename O, typename K>
+K SlotObjectManager<O, K>::commit(K id, O &&iObject)
+{
+  // the slot is only bound after the object is created (the factory may add other objects)
+  fSlots[(id & kIndexMask) - 1].fIndex = static_cast<int>(fObjects.size());
+  fObjects.emplace_back(id, std::move(iObject));
+  return id;
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::release
+//------------------------------------------------------------------------
+template<typename O, typename K>
+void SlotObjectManager<O, K>::release(K id)
+{
+  RE_MOCK_INTERNAL_ASSERT(findIndex(id) == -1);
+  fFreeSlots.emplace_back((id & kIndexMask) - 1);
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::findIndex
+//------------------------------------------------------------------------
+template<typename O, typename K>
+int SlotObjectManager<O, K>::findIndex(K id) const
+{
+  auto slot = (id & kIndexMask) - 1;
+  if(slot < 0 || slot >= static_cast<K>(fSlots.size()))
+    return -1;
+  auto const &s = fSlots[slot];
+  if(s.fGeneration != (id >> kIndexBits))
+    return -1;
+  return s.fIndex;
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::add
+//------------------------------------------------------------------------
+template<typename O, typename K>
+K SlotObjectManager<O, K>::add(O &&iObject)
+{
+  return commit(reserve(), std::move(iObject));
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::add
+//------------------------------------------------------------------------
+template<typename O, typename K>
+K SlotObjectManager<O, K>::add(std::function<O(int)> iObjectFactory)
+{
+  auto id = reserve();
+  try
+  {
+    return commit(id, iObjectFactory(id));
+  }
+  catch(...)
+  {
+    // the factory failed => release the slot
+    release(id);
+    throw;
+  }
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::get
+//------------------------------------------------------------------------
+template<typename O, typename K>
+O const &SlotObjectManager<O, K>::get(K id) const
+{
+  auto index = findIndex(id);
+  RE_MOCK_ASSERT(index >= 0, "Missing object for key [%d]", id);
+  return fObjects[index].second;
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::get
+//------------------------------------------------------------------------
+template<typename O, typename K>
+O &SlotObjectManager<O, K>::get(K id)
+{
+  auto index = findIndex(id);
+  RE_MOCK_ASSERT(index >= 0, "Missing object for key [%d]", id);
+  return fObjects[index].second;
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::remove
+//------------------------------------------------------------------------
+template<typename O, typename K>
+void SlotObjectManager<O, K>::remove(K id)
+{
+  auto index = findIndex(id);
+  if(index < 0)
+    return;
+
+  fObjects.erase(fObjects.begin() + index);
+
+  // objects after the removed one have shifted
+  for(auto i = static_cast<size_t>(index); i < fObjects.size(); i++)
+    fSlots[(fObjects[i].first & kIndexMask) - 1].fIndex--;
+
+  auto slot = (id & kIndexMask) - 1;
+  auto &s = fSlots[slot];
+  s.fIndex = -1;
+  // wraps around after kMaxGeneration
+  s.fGeneration = s.fGeneration == kMaxGeneration ? 0 : s.fGeneration + 1;
+  fFreeSlots.emplace_back(slot);
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::replace
+//------------------------------------------------------------------------
+template<typename O, typename K>
+void SlotObjectManager<O, K>::replace(K id, O &&iObject)
+{
+  auto index = findIndex(id);
+  RE_MOCK_ASSERT(index >= 0, "Missing object for key [%d]", id);
+  fObjects[index].second = std::move(iObject);
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::clear
+//------------------------------------------------------------------------
+template<typename O, typename K>
+void SlotObjectManager<O, K>::clear()
+{
+  // removing in reverse order avoids shifting objects
+  while(!fObjects.empty())
+    remove(fObjects.back().first);
+}
+
+//------------------------------------------------------------------------
+// SlotObjectManager::reset
+//------------------------------------------------------------------------
+template<typename O, typename K>
+void SlotObjectManager<O, K>::reset()
+{
+  fObjects.clear();
+  fSlots.clear();
+  fFreeSlots.clear();
+}
+
 }
 
 #endif
\ No newline at end of file
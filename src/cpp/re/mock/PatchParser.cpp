@@ -17,9 +17,13 @@
  */
 
 #include "PatchParser.h"
+#include "FileManager.h"
 #include "stl.h"
 #include "fmt.h"
 #include <tinyxml2.h>
+#include <algorithm>
+#include <list>
+#include <mutex>
 
 using namespace tinyxml2;
 
@@ -57,22 +61,51 @@ std::string getAttributeValue(XMLElement const *iElement, char const *iAttribute
 //------------------------------------------------------------------------
 // findElement
 //------------------------------------------------------------------------
-XMLElement const *findElement(XMLElement const *iElement, char const *iSubPath)
+XMLElement const *findElement(XMLElement const *iElement, std::initializer_list<char const *> iSubPath)
 {
-  RE_MOCK_ASSERT(iSubPath != nullptr);
-
   auto e = iElement;
 
-  auto elts = fmt::split(iSubPath, '/');
-  for(auto elt: elts)
+  for(auto elt: iSubPath)
   {
     if(e)
-      e = e->FirstChildElement(elt.c_str());
+      e = e->FirstChildElement(elt);
   }
 
   return e;
 }
 
+//------------------------------------------------------------------------
+// hexDigit
+//------------------------------------------------------------------------
+inline int hexDigit(char c)
+{
+  if(c >= '0' && c <= '9')
+    return c - '0';
+  if(c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if(c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+//------------------------------------------------------------------------
+// decodeHexString
+//------------------------------------------------------------------------
+std::string decodeHexString(std::string const &iValue, int iLineNum)
+{
+  RE_MOCK_ASSERT(iValue.size() % 2 == 0, "Invalid string property [%s] line [%d]", iValue, iLineNum);
+  std::string res{};
+  res.reserve(iValue.size() / 2);
+  for(size_t i = 0; i < iValue.size(); i += 2)
+  {
+    auto h = hexDigit(iValue[i]);
+    auto l = hexDigit(iValue[i + 1]);
+    RE_MOCK_ASSERT(h >= 0 && l >= 0, "Invalid string property [%s] line [%d]", iValue, iLineNum);
+    res += static_cast<char>((h << 4) | l);
+  }
+  return res;
+}
+
 //------------------------------------------------------------------------
 // extractSampleReferenceResolver
 //------------------------------------------------------------------------
@@ -90,7 +123,7 @@ sample_reference_resolver extractSampleReferenceResolver(XMLElement const *e)
 
     // Try AbsolutePath/NativeURL
     {
-      auto pathElt = findElement(sr, "AbsolutePath/NativeURL");
+      auto pathElt = findElement(sr, {"AbsolutePath", "NativeURL"});
       if(pathElt && pathElt->GetText())
       {
         std::string url{fmt::trim(pathElt->GetText())};
@@ -102,7 +135,7 @@ sample_reference_resolver extractSampleReferenceResolver(XMLElement const *e)
     // Try DatabasePath/Path (jukebox)
     if(!ref)
     {
-      auto pathElt = findElement(sr, "DatabasePath/Path");
+      auto pathElt = findElement(sr, {"DatabasePath", "Path"});
       auto kind = findAttributeValue(pathElt, "pathKind");
       if(kind && *kind == "jukebox" && pathElt->GetText())
       {
@@ -162,14 +195,14 @@ std::unique_ptr<resource::Patch> createPatch(XMLDocument const &iDoc)
 
   while(o != nullptr)
   {
-    auto objectName = fmt::trim(getAttributeValue(o, "name"));
+    auto objectPath = "/" + fmt::trim(getAttributeValue(o, "name")) + "/";
     // <Value property="prop_number" type="number" >0.5</Value>
     auto v = o->FirstChildElement("Value");
     while(v)
     {
       if(v->GetText()) // ignore empty nodes
       {
-        auto property = fmt::printf("/%s/%s", objectName, fmt::trim(getAttributeValue(v, "property")));
+        auto property = objectPath + fmt::trim(getAttributeValue(v, "property"));
         auto type = fmt::trim(getAttributeValue(v, "type"));
         auto value = fmt::trim(v->GetText());
 
@@ -192,13 +225,7 @@ std::unique_ptr<resource::Patch> createPatch(XMLDocument const &iDoc)
         }
         else if(type == "string")
         {
-          std::string s = "";
-          while(!value.empty())
-          {
-            s += static_cast<char>(std::stoi(value.substr(0, 2), nullptr, 16));
-            value = value.substr(2);
-          }
-          patch->string(property, s);
+          patch->string(property, decodeHexString(value, v->GetLineNum()));
         }
       }
 
@@ -235,4 +262,204 @@ std::unique_ptr<resource::Patch> PatchParser::from(resource::String iPatchString
   return impl::createPatch(doc);
 }
 
-}
\ No newline at end of file
+//------------------------------------------------------------------------
+// PatchCache
+//------------------------------------------------------------------------
+namespace impl {
+
+class PatchCache
+{
+public:
+  static PatchCache &instance()
+  {
+    static PatchCache kInstance{};
+    return kInstance;
+  }
+
+  std::shared_ptr<const resource::Patch> get(resource::File const &iPatchFile)
+  {
+    RE_MOCK_ASSERT(FileManager::fileExists(iPatchFile), "Cannot find patch file %s", iPatchFile.fFilePath.u8string());
+
+    auto path = fs::canonical(iPatchFile.fFilePath);
+    auto lastWriteTime = fs::last_write_time(path);
+    auto size = fs::file_size(path);
+
+    {
+      std::lock_guard<std::mutex> lock{fMutex};
+      auto iter = fEntries.find(path);
+      if(iter != fEntries.end() && iter->second.fLastWriteTime == lastWriteTime && iter->second.fSize == size)
+      {
+        fStats.fHitCount++;
+        fLRU.splice(fLRU.begin(), fLRU, iter->second.fLRUPosition); // most recently used
+        return iter->second.fPatch;
+      }
+      fStats.fMissCount++;
+    }
+
+    // parsing happens outside the lock (so that bulk loading is actually parallel)
+    std::shared_ptr<const resource::Patch> patch = PatchParser::from(resource::File{path});
+
+    std::lock_guard<std::mutex> lock{fMutex};
+    auto iter = fEntries.find(path);
+    if(iter == fEntries.end())
+    {
+      fLRU.emplace_front(path);
+      iter = fEntries.emplace(path, Entry{}).first;
+    }
+    else
+      fLRU.splice(fLRU.begin(), fLRU, iter->second.fLRUPosition);
+    iter->second = Entry{lastWriteTime, size, patch, fLRU.begin()};
+    evict();
+    return patch;
+  }
+
+  PatchParser::CacheStats getStats()
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    auto stats = fStats;
+    stats.fSize = fEntries.size();
+    return stats;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    fEntries.clear();
+    fLRU.clear();
+    fStats = {};
+  }
+
+  size_t getCapacity()
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    return fCapacity;
+  }
+
+  void setCapacity(size_t iCapacity)
+  {
+    RE_MOCK_ASSERT(iCapacity > 0, "patch cache capacity must be > 0");
+    std::lock_guard<std::mutex> lock{fMutex};
+    fCapacity = iCapacity;
+    evict();
+  }
+
+  // makes room for iCount more patches without evicting any of the ones currently cached (never shrinks)
+  void reserve(size_t iCount)
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    fCapacity = std::max(fCapacity, fEntries.size() + iCount);
+  }
+
+private:
+  // removes the least recently used entries until the cache fits (lock must be held)
+  void evict()
+  {
+    while(fEntries.size() > fCapacity)
+    {
+      fEntries.erase(fLRU.back());
+      fLRU.pop_back();
+      fStats.fEvictionCount++;
+    }
+  }
+
+private:
+  struct Entry
+  {
+    fs::file_time_type fLastWriteTime{};
+    std::uintmax_t fSize{};
+    std::shared_ptr<const resource::Patch> fPatch{};
+    std::list<fs::path>::iterator fLRUPosition{};
+  };
+
+  std::mutex fMutex{};
+  std::map<fs::path, Entry> fEntries{};
+  std::list<fs::path> fLRU{}; // most recently used first
+  size_t fCapacity{PatchParser::kDefaultCacheCapacity};
+  PatchParser::CacheStats fStats{};
+};
+
+}
+
+//------------------------------------------------------------------------
+// PatchParser::fromCache
+//------------------------------------------------------------------------
+std::shared_ptr<const resource::Patch> PatchParser::fromCache(resource::File const &iPatchFile)
+{
+  return impl::PatchCache::instance().get(iPatchFile);
+}
+
+//------------------------------------------------------------------------
+// PatchParser::getCacheStats
+//------------------------------------------------------------------------
+PatchParser::CacheStats PatchParser::getCacheStats()
+{
+  return impl::PatchCache::instance().getStats();
+}
+
+//------------------------------------------------------------------------
+// PatchParser::clearCache
+//------------------------------------------------------------------------
+void PatchParser::clearCache()
+{
+  impl::PatchCache::instance().clear();
+}
+
+//------------------------------------------------------------------------
+// PatchParser::getCacheCapacity
+//------------------------------------------------------------------------
+size_t PatchParser::getCacheCapacity()
+{
+  return impl::PatchCache::instance().getCapacity();
+}
+
+//------------------------------------------------------------------------
+// PatchParser::setCacheCapacity
+//------------------------------------------------------------------------
+void PatchParser::setCacheCapacity(size_t iCapacity)
+{
+  impl::PatchCache::instance().setCapacity(iCapacity);
+}
+
+//------------------------------------------------------------------------
+// PatchParser::loadDirectory
+//------------------------------------------------------------------------
+PatchParser::BulkLoadResult PatchParser::loadDirectory(fs::path const &iDirectory, unsigned int iThreadCount)
+{
+  RE_MOCK_ASSERT(fs::is_directory(iDirectory), "%s is not a directory", iDirectory.u8string());
+
+  std::vector<fs::path> files{};
+  for(auto const &entry: fs::recursive_directory_iterator(iDirectory))
+  {
+    if(entry.is_regular_file() && entry.path().extension() == ".repatch")
+      files.emplace_back(entry.path());
+  }
+
+  // none of the patches loaded must be evicted before they are used
+  impl::PatchCache::instance().reserve(files.size());
+
+  std::vector<std::shared_ptr<const resource::Patch>> patches(files.size());
+  std::vector<std::string> errors(files.size());
+
+  stl::parallel_for(files.size(), iThreadCount, [&files, &patches, &errors](size_t i) {
+    try
+    {
+      patches[i] = fromCache(resource::File{files[i]});
+    }
+    catch(std::exception &e)
+    {
+      errors[i] = e.what();
+    }
+  });
+
+  BulkLoadResult res{};
+  for(size_t i = 0; i < files.size(); i++)
+  {
+    if(patches[i])
+      res.fPatches[files[i]] = std::move(patches[i]);
+    else
+      res.fErrors[files[i]] = std::move(errors[i]);
+  }
+  return res;
+}
+
+}
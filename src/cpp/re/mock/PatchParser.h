@@ -20,15 +20,59 @@
 #define RE_MOCK_PATCHLOADER_H
 
 #include "Config.h"
+#include "fs.h"
 #include <functional>
+#include <map>
 
 namespace re::mock {
 
 class PatchParser
 {
 public:
+  //! Parses the patch file (always parses, does not use the cache)
   static std::unique_ptr<resource::Patch> from(resource::File iPatchFile);
   static std::unique_ptr<resource::Patch> from(resource::String iPatchString);
+
+  /**
+   * Returns the (immutable) patch parsed from the file. The file is parsed only if it is not already in the cache or
+   * if it has changed since it was parsed (the cache is keyed by the canonical path of the file, its last write time
+   * and its size). The cache holds at most `getCacheCapacity()` patches: the least recently used one is evicted when
+   * it is full. This method is thread safe. */
+  static std::shared_ptr<const resource::Patch> fromCache(resource::File const &iPatchFile);
+
+  struct BulkLoadResult
+  {
+    std::map<fs::path, std::shared_ptr<const resource::Patch>> fPatches{};
+    std::map<fs::path, std::string> fErrors{}; // patch files which could not be parsed
+  };
+
+  /**
+   * Parses (in parallel) all the patch files (`.repatch`) found in the directory (and its sub-directories) and adds
+   * them to the cache: loading any of them afterwards (`Motherboard::loadPatch`) will not parse them again. The
+   * capacity of the cache grows if needed so that none of the patches already cached or loaded is evicted (it
+   * is never reduced: use `setCacheCapacity()` or `clearCache()` to release the memory).
+   *
+   * @param iThreadCount number of threads to use (`0` means `std::thread::hardware_concurrency()`) */
+  static BulkLoadResult loadDirectory(fs::path const &iDirectory, unsigned int iThreadCount = 0);
+
+  //! Default maximum number of patches kept in the cache (grown by `loadDirectory()` if needed)
+  constexpr static size_t kDefaultCacheCapacity = 1024;
+
+  struct CacheStats
+  {
+    size_t fSize{};
+    size_t fHitCount{};
+    size_t fMissCount{};
+    size_t fEvictionCount{};
+  };
+
+  static CacheStats getCacheStats();
+  static void clearCache();
+
+  static size_t getCacheCapacity();
+
+  //! Changes the maximum number of patches kept in the cache (evicting the least recently used ones if needed)
+  static void setCacheCapacity(size_t iCapacity);
 };
 
 }
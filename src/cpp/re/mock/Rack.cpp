@@ -54,6 +54,9 @@ Rack::~Rack()
       m.shutdown();
     });
   }
+
+  if(fTraceAutoFlush)
+    flushTraces();
 }
 
 //------------------------------------------------------------------------
@@ -74,23 +77,320 @@ rack::Extension Rack::newExtension(Config const &iConfig)
     // initializes the motherboard
     m.init();
   });
+
+  if(fTraceAutoFlush)
+    res->fMotherboard->flushTraces(std::cout);
+
   return rack::Extension{res};
 }
 
+//------------------------------------------------------------------------
+// Rack::newExtensions
+//------------------------------------------------------------------------
+std::vector<rack::Extension> Rack::newExtensions(std::vector<Config> const &iConfigs, unsigned int iThreadCount)
+{
+  // ids are reserved upfront (in order) so that they do not depend on which thread finishes first
+  std::vector<int> ids{};
+  ids.reserve(iConfigs.size());
+  for(size_t i = 0; i < iConfigs.size(); i++)
+    ids.emplace_back(fExtensions.reserve());
+
+  std::vector<std::shared_ptr<impl::ExtensionImpl>> extensions(iConfigs.size());
+  std::vector<std::exception_ptr> errors(iConfigs.size());
+
+  // the current motherboard being thread local, each thread can initialize its own motherboard
+  stl::parallel_for(iConfigs.size(), iThreadCount, [this, &iConfigs, &ids, &extensions, &errors](size_t i) {
+    try
+    {
+      auto extension = std::shared_ptr<impl::ExtensionImpl>(new impl::ExtensionImpl(ids[i], this, Motherboard::create(ids[i], fSampleRate, iConfigs[i])));
+      extensions[i] = extension;
+      extension->use([this](Motherboard &m) {
+        fTransport.initMotherboard(m);
+        m.init();
+      });
+    }
+    catch(...)
+    {
+      errors[i] = std::current_exception();
+    }
+  });
+
+  auto error = std::find_if(errors.begin(), errors.end(), [](auto const &e) { return e != nullptr; });
+  if(error != errors.end())
+  {
+    // in reverse order so that the next extensions get the same ids as if this call never happened
+    for(auto i = iConfigs.size(); i-- > 0;)
+    {
+      if(extensions[i])
+        extensions[i]->use([](Motherboard &m) { m.shutdown(); });
+      fExtensions.release(ids[i]);
+    }
+    std::rethrow_exception(*error);
+  }
+
+  std::vector<rack::Extension> res{};
+  res.reserve(iConfigs.size());
+  for(size_t i = 0; i < iConfigs.size(); i++)
+  {
+    fExtensions.commit(ids[i], std::move(extensions[i]));
+    auto &extension = fExtensions.get(ids[i]);
+
+    if(fTraceAutoFlush)
+      extension->fMotherboard->flushTraces(std::cout);
+
+    res.emplace_back(rack::Extension{extension});
+  }
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Rack::flushTraces
+//------------------------------------------------------------------------
+void Rack::flushTraces(std::ostream &oStream)
+{
+  for(auto &extension: fExtensions)
+    extension.second->fMotherboard->flushTraces(oStream);
+}
+
+//------------------------------------------------------------------------
+// Rack::snapshot
+//------------------------------------------------------------------------
+rack::Snapshot Rack::snapshot() const
+{
+  rack::Snapshot res{};
+  res.fRack = this;
+  res.fTransport = fTransport;
+  res.fBatchCount = fBatchCount;
+  res.fSongEnd = fSongEnd;
+  res.fExtensions.reserve(fExtensions.size());
+  for(auto &[id, extension]: fExtensions)
+  {
+    std::shared_ptr<const MotherboardSnapshot> motherboard{};
+    extension->use([&motherboard](Motherboard &m) { motherboard = m.snapshot(); });
+    res.fExtensions.emplace_back(rack::Snapshot::ExtensionState{
+      /* .fId = */             id,
+      /* .fMotherboard = */    std::move(motherboard),
+      /* .fSequencerTrack = */ extension->fSequencerTrack,
+      /* .fAudioOutWires = */  extension->fAudioOutWires,
+      /* .fAudioInWires = */   extension->fAudioInWires,
+      /* .fCVOutWires = */     extension->fCVOutWires,
+      /* .fCVInWires = */      extension->fCVInWires,
+      /* .fNoteOutWire = */    extension->fNoteOutWire,
+      /* .fNoteInWire = */     extension->fNoteInWire
+    });
+  }
+  return res;
+}
+
+//------------------------------------------------------------------------
+// Rack::restore
+//------------------------------------------------------------------------
+void Rack::restore(rack::Snapshot const &iSnapshot)
+{
+  RE_MOCK_ASSERT(iSnapshot.fRack == this, "The snapshot was taken by a different rack");
+  RE_MOCK_ASSERT(iSnapshot.fExtensions.size() == fExtensions.size(), "The extensions have changed since the snapshot was taken");
+  for(auto const &state: iSnapshot.fExtensions)
+    RE_MOCK_ASSERT(fExtensions.contains(state.fId), "Extension [%d] has been removed since the snapshot was taken", state.fId);
+
+  fTransport = *iSnapshot.fTransport;
+  fBatchCount = iSnapshot.fBatchCount;
+  fSongEnd = iSnapshot.fSongEnd;
+
+  for(auto const &state: iSnapshot.fExtensions)
+  {
+    auto &extension = fExtensions.get(state.fId);
+    extension->use([&state](Motherboard &m) { m.restore(*state.fMotherboard); });
+    extension->fSequencerTrack = state.fSequencerTrack;
+    extension->fAudioOutWires = state.fAudioOutWires;
+    extension->fAudioInWires = state.fAudioInWires;
+    extension->fCVOutWires = state.fCVOutWires;
+    extension->fCVInWires = state.fCVInWires;
+    extension->fNoteOutWire = state.fNoteOutWire;
+    extension->fNoteInWire = state.fNoteInWire;
+  }
+
+  // wires may have changed
+  for(auto &[id, extension]: fExtensions)
+  {
+    extension->fDependents = std::nullopt;
+    extension->fCVOutSlots = std::nullopt;
+  }
+}
+
+//------------------------------------------------------------------------
+// Rack::saveState
+//------------------------------------------------------------------------
+void Rack::saveState(std::string const &iFilePath) const
+{
+  StateArchive::Writer writer{StateArchive::Kind::kRack};
+
+  writer.write<TJBox_UInt64>(fBatchCount);
+  writer.write<TJBox_Float64>(fSongEnd.toPPQCount());
+  writer.write<TJBox_Int32>(fSongEnd.signature().numerator());
+  writer.write<TJBox_Int32>(fSongEnd.signature().denominator());
+
+  writer.write<TJBox_UInt8>(fTransport.getPlaying());
+  writer.write<TJBox_Int64>(fTransport.getPlayPos());
+  writer.write<TJBox_Float64>(fTransport.getTempo());
+  writer.write<TJBox_Float64>(fTransport.getFilteredTempo());
+  writer.write<TJBox_UInt8>(fTransport.getTempoAutomation());
+  writer.write<TJBox_Int32>(fTransport.getTimeSignatureNumerator());
+  writer.write<TJBox_Int32>(fTransport.getTimeSignatureDenominator());
+  writer.write<TJBox_UInt8>(fTransport.getLoopEnabled());
+  writer.write<TJBox_UInt64>(fTransport.getLoopStartPos());
+  writer.write<TJBox_UInt64>(fTransport.getLoopEndPos());
+  writer.write<TJBox_UInt64>(fTransport.getBarStartPos());
+
+  writer.write<TJBox_UInt32>(fExtensions.size());
+  for(auto &[id, extension]: fExtensions)
+  {
+    writer.write<TJBox_Int32>(id);
+    extension->use([&writer](Motherboard &m) { m.saveState(writer); });
+  }
+
+  writer.save(iFilePath);
+}
+
+//------------------------------------------------------------------------
+// Rack::loadState
+//------------------------------------------------------------------------
+void Rack::loadState(std::string const &iFilePath)
+{
+  auto reader = StateArchive::Reader::load(iFilePath, StateArchive::Kind::kRack);
+
+  auto batchCount = reader.read<TJBox_UInt64>();
+  auto songEndPPQ = reader.read<TJBox_Float64>();
+  auto songEndNumerator = reader.read<TJBox_Int32>();
+  auto songEndDenominator = reader.read<TJBox_Int32>();
+
+  auto playing = reader.read<TJBox_UInt8>() != 0;
+  auto playPos = reader.read<TJBox_Int64>();
+  auto tempo = reader.read<TJBox_Float64>();
+  auto filteredTempo = reader.read<TJBox_Float64>();
+  auto tempoAutomation = reader.read<TJBox_UInt8>() != 0;
+  auto numerator = reader.read<TJBox_Int32>();
+  auto denominator = reader.read<TJBox_Int32>();
+  auto loopEnabled = reader.read<TJBox_UInt8>() != 0;
+  auto loopStartPos = reader.read<TJBox_UInt64>();
+  auto loopEndPos = reader.read<TJBox_UInt64>();
+  auto barStartPos = reader.read<TJBox_UInt64>();
+
+  auto extensionCount = reader.read<TJBox_UInt32>();
+  RE_MOCK_ASSERT(extensionCount == fExtensions.size(), "The state [%s] was saved with %d extensions (rack has %ld)",
+                 iFilePath, extensionCount, fExtensions.size());
+
+  // the whole file is decoded and validated first so that a failure leaves the rack untouched
+  std::vector<std::pair<std::shared_ptr<impl::ExtensionImpl>, std::unique_ptr<MotherboardSnapshot>>> states{};
+  states.reserve(extensionCount);
+  for(TJBox_UInt32 i = 0; i < extensionCount; i++)
+  {
+    auto id = reader.read<TJBox_Int32>();
+    RE_MOCK_ASSERT(fExtensions.contains(id), "Extension [%d] from state [%s] is not in the rack", id, iFilePath);
+    auto &extension = fExtensions.get(id);
+    auto state = extension->use<std::unique_ptr<MotherboardSnapshot>>([&reader](Motherboard &m) { return m.decodeState(reader); });
+    states.emplace_back(extension, std::move(state));
+  }
+
+  RE_MOCK_ASSERT(reader.done(), "Unexpected data at the end of [%s]", iFilePath);
+
+  auto songEnd = sequencer::Time::from(songEndPPQ, sequencer::TimeSignature(songEndNumerator, songEndDenominator));
+  auto timeSignature = sequencer::TimeSignature(numerator, denominator);
+
+  // apply (cannot fail)
+  for(auto &[extension, state]: states)
+  {
+    extension->use([&state = state](Motherboard &m) { m.loadState(std::move(state)); });
+    extension->fSequencerTrack.invalidateCursor();
+  }
+
+  fBatchCount = batchCount;
+  setSongEnd(songEnd);
+
+  fTransport.setPlaying(playing);
+  fTransport.setTempo(tempo);
+  fTransport.setFilteredTempo(filteredTempo);
+  fTransport.setTempoAutomation(tempoAutomation);
+  setTransportTimeSignature(timeSignature);
+  fTransport.setLoopEnabled(loopEnabled);
+  fTransport.setLoopStartPos(loopStartPos);
+  fTransport.setLoopEndPos(loopEndPos);
+  // last: the setters above may reset the batch position
+  fTransport.setPlayPos(playPos);
+  // only recomputed by setPlayPos when the play position changes
+  fTransport.setNumberValue(fTransport.fBarStartPos, barStartPos, kJBox_TransportBarStartPos);
+}
+
+//------------------------------------------------------------------------
+// Rack::memoryReport
+//------------------------------------------------------------------------
+rack::MemoryReport Rack::memoryReport() const
+{
+  rack::MemoryReport res{};
+  for(auto const &[id, extension]: fExtensions)
+  {
+    auto report = extension->fMotherboard->memoryReport();
+    res.fTotal += report;
+    res.fExtensions[id] = report;
+  }
+  return res;
+}
+
 //------------------------------------------------------------------------
 // Rack::nextBatch
 //------------------------------------------------------------------------
 void Rack::nextBatch()
 {
-  std::set<int> processedExtensions{};
+  // each extension is marked with the generation when processed (no allocation, unlike a set of processed ids)
+  fBatchGeneration++;
 
   for(auto &extension: fExtensions)
   {
-    nextBatch(*extension.second, processedExtensions);
+    nextBatch(*extension.second, fBatchGeneration);
   }
 
   fTransport.nextBatch();
   fBatchCount++;
+
+  if(fTraceAutoFlush)
+    flushTraces();
+}
+
+//------------------------------------------------------------------------
+// Rack::preRoll
+//------------------------------------------------------------------------
+rack::PreRollStats Rack::preRoll(std::function<void()> const &iCallback)
+{
+  RE_MOCK_ASSERT(!fPreRolling, "Rack is already pre-rolling");
+
+  // restores the flag even if the callback throws
+  struct PreRollingRAII
+  {
+    explicit PreRollingRAII(bool &iPreRolling) : fPreRolling{iPreRolling} { fPreRolling = true; }
+    ~PreRollingRAII() { fPreRolling = false; }
+    bool &fPreRolling;
+  };
+
+  auto batchCountBefore = fBatchCount;
+  auto start = std::chrono::steady_clock::now();
+
+  {
+    PreRollingRAII raii{fPreRolling};
+    iCallback();
+  }
+
+  return {fBatchCount - batchCountBefore, std::chrono::steady_clock::now() - start};
+}
+
+//------------------------------------------------------------------------
+// Rack::preRoll
+//------------------------------------------------------------------------
+rack::PreRollStats Rack::preRoll(rack::Duration iDuration)
+{
+  return preRoll([this, iDuration]() {
+    for(size_t i = 0; i < iDuration.fBatches; i++)
+      nextBatch();
+  });
 }
 
 //------------------------------------------------------------------------
@@ -98,6 +398,10 @@ void Rack::nextBatch()
 //------------------------------------------------------------------------
 void Rack::nextBatch(impl::ExtensionImpl &iExtension)
 {
+  // an observer only captures what other devices produce, so it does not need to run while pre-rolling
+  if(fPreRolling && iExtension.fObserver)
+    return;
+
   iExtension.use([&iExtension, this](Motherboard &m) {
 
     // update transport for motherboard
@@ -145,8 +449,10 @@ void Rack::nextBatch(impl::ExtensionImpl &iExtension)
   for(auto &wire: iExtension.fAudioOutWires)
     copyAudioBuffers(wire);
 
-  for(auto &wire: iExtension.fCVOutWires)
-    copyCVValue(wire);
+  if(!iExtension.fCVOutSlots)
+    resolveCVOutSlots(iExtension);
+  for(auto &slots: *iExtension.fCVOutSlots)
+    copyCVValue(slots);
 
   if(iExtension.fNoteOutWire)
     copyNoteEvents(iExtension.fNoteOutWire.value());
@@ -155,19 +461,19 @@ void Rack::nextBatch(impl::ExtensionImpl &iExtension)
 //------------------------------------------------------------------------
 // Rack::nextBatch
 //------------------------------------------------------------------------
-void Rack::nextBatch(impl::ExtensionImpl &iExtension, std::set<int> &iProcessedExtensions)
+void Rack::nextBatch(impl::ExtensionImpl &iExtension, size_t iGeneration)
 {
-  if(stl::contains(iProcessedExtensions, iExtension.fId))
+  if(iExtension.fProcessedGeneration == iGeneration)
     // already processed
     return;
 
-  // we start by adding it to break any cycle
-  iProcessedExtensions.emplace(iExtension.fId);
+  // we start by marking it to break any cycle
+  iExtension.fProcessedGeneration = iGeneration;
 
   // we process all dependent extensions first
   for(auto id: iExtension.getDependents())
   {
-    nextBatch(*fExtensions.get(id), iProcessedExtensions);
+    nextBatch(*fExtensions.get(id), iGeneration);
   }
 
   // we process the extension
@@ -182,6 +488,10 @@ void Rack::copyAudioBuffers(rack::Extension::AudioWire const &iWire)
   auto outExtension = fExtensions.get(iWire.fFromSocket.fExtensionId);
   auto inExtension = fExtensions.get(iWire.fToSocket.fExtensionId);
 
+  // nothing to observe while pre-rolling
+  if(fPreRolling && inExtension->fObserver)
+    return;
+
   auto buffer = outExtension->fMotherboard->getDSPBuffer(iWire.fFromSocket.fSocketRef);
   inExtension->fMotherboard->setDSPBuffer(iWire.fToSocket.fSocketRef, buffer);
 }
@@ -189,13 +499,32 @@ void Rack::copyAudioBuffers(rack::Extension::AudioWire const &iWire)
 //------------------------------------------------------------------------
 // Rack::copyCVValue
 //------------------------------------------------------------------------
-void Rack::copyCVValue(rack::Extension::CVWire const &iWire)
+void Rack::copyCVValue(impl::ExtensionImpl::CVValueSlots const &iSlots)
 {
-  auto outExtension = fExtensions.get(iWire.fFromSocket.fExtensionId);
-  auto inExtension = fExtensions.get(iWire.fToSocket.fExtensionId);
+  // nothing to observe while pre-rolling
+  if(fPreRolling && iSlots.fToExtension->fObserver)
+    return;
 
-  auto value = outExtension->fMotherboard->getCVSocketValue(iWire.fFromSocket.fSocketRef);
-  inExtension->fMotherboard->setCVSocketValue(iWire.fToSocket.fSocketRef, value);
+  iSlots.fToExtension->fMotherboard->setCVSocketValue(iSlots.fToValue, iSlots.fFromValue->loadValue()->getNumber());
+}
+
+//------------------------------------------------------------------------
+// Rack::resolveCVOutSlots
+//------------------------------------------------------------------------
+void Rack::resolveCVOutSlots(impl::ExtensionImpl &iExtension)
+{
+  std::vector<impl::ExtensionImpl::CVValueSlots> slots{};
+  slots.reserve(iExtension.fCVOutWires.size());
+  for(auto const &wire: iExtension.fCVOutWires)
+  {
+    auto inExtension = fExtensions.get(wire.fToSocket.fExtensionId).get();
+    slots.emplace_back(impl::ExtensionImpl::CVValueSlots{
+      /* .fFromValue = */   iExtension.fMotherboard->getCVSocketValueProperty(wire.fFromSocket.fSocketRef),
+      /* .fToExtension = */ inExtension,
+      /* .fToValue = */     inExtension->fMotherboard->getCVSocketValueProperty(wire.fToSocket.fSocketRef)
+    });
+  }
+  iExtension.fCVOutSlots = std::move(slots);
 }
 
 //------------------------------------------------------------------------
@@ -206,11 +535,13 @@ void Rack::copyNoteEvents(rack::Extension::NoteWire const &iWire)
   auto outExtension = fExtensions.get(iWire.fFromSocket.fExtensionId);
   auto inExtension = fExtensions.get(iWire.fToSocket.fExtensionId);
 
+  // nothing to observe while pre-rolling
+  if(fPreRolling && inExtension->fObserver)
+    return;
+
   if(!inExtension->fMotherboard->isNotePlayerBypassed())
   {
-    auto noteEvents = outExtension->fMotherboard->getNoteOutEvents();
-    for(auto &noteEvent: noteEvents)
-      inExtension->fMotherboard->setNoteInEvent(noteEvent);
+    inExtension->fMotherboard->setNoteInEvents(outExtension->fMotherboard->getNoteOutEvents());
   }
 }
 
@@ -293,6 +624,8 @@ void Rack::wire(rack::Extension::CVOutSocket const &iOutSocket, rack::Extension:
 
   inExtension->fMotherboard->connectSocket(iInSocket.fSocketRef);
   outExtension->fMotherboard->connectSocket(iOutSocket.fSocketRef);
+
+  resolveCVOutSlots(*outExtension);
 }
 
 //------------------------------------------------------------------------
@@ -470,6 +803,27 @@ void Rack::setSongEnd(sequencer::Time iSongEnd)
   fTransport.setSongEndPos(iSongEnd.toPPQCount());
 }
 
+//------------------------------------------------------------------------
+// PreRollStats::getBatchesPerSecond
+//------------------------------------------------------------------------
+double rack::PreRollStats::getBatchesPerSecond() const
+{
+  auto seconds = std::chrono::duration<double>(fElapsedTime).count();
+  return seconds > 0 ? static_cast<double>(fBatchCount) / seconds : 0;
+}
+
+//------------------------------------------------------------------------
+// MemoryReport::toString
+//------------------------------------------------------------------------
+std::string rack::MemoryReport::toString() const
+{
+  std::string res{};
+  for(auto const &[id, report]: fExtensions)
+    res += fmt::printf("---- extension [%d] ----\n%s\n", id, report.toString());
+  res += fmt::printf("---- rack ----\n%s", fTotal.toString());
+  return res;
+}
+
 namespace impl {
 //------------------------------------------------------------------------
 // InternalThreadLocalRAII::InternalThreadLocalRAII - to manage the "current" motherboard
@@ -493,7 +847,10 @@ InternalThreadLocalRAII::~InternalThreadLocalRAII()
 // ExtensionImpl::ExtensionImpl
 //------------------------------------------------------------------------
 ExtensionImpl::ExtensionImpl(int id, Rack *iRack, std::unique_ptr<Motherboard> iMotherboard) :
-  fId{id}, fMotherboard{std::move(iMotherboard)}, fSequencerTrack{iRack->getTransportTimeSignature()} {}
+  fId{id},
+  fMotherboard{std::move(iMotherboard)},
+  fSequencerTrack{iRack->getTransportTimeSignature(), fMotherboard->getMemoryCounter(MemoryReport::Subsystem::kSequencerEvents)}
+{}
 
 //------------------------------------------------------------------------
 // ExtensionImpl::use
@@ -618,7 +975,10 @@ void ExtensionImpl::wire(rack::Extension::CVOutSocket const &iOutSocket, rack::E
   RE_MOCK_ASSERT(!stl::contains_if(fCVOutWires, [&newWire](auto &wire) { return rack::Extension::CVWire::overlap(wire, newWire); }), "CV socket in use");
 
   if(iOutSocket.fExtensionId == fId)
+  {
     fCVOutWires.emplace_back(newWire);
+    fCVOutSlots = std::nullopt;
+  }
 
   if(iOutSocket.fExtensionId != fId)
   {
@@ -665,6 +1025,7 @@ std::optional<rack::Extension::CVInSocket> ExtensionImpl::unwire(rack::Extension
   {
     auto wire = *iter;
     fCVOutWires.erase(iter);
+    fCVOutSlots = std::nullopt;
     return wire.fToSocket;
   }
 
@@ -767,6 +1128,9 @@ std::optional<rack::Extension::NoteWire> ExtensionImpl::findWire(rack::Extension
 //------------------------------------------------------------------------
 void ExtensionImpl::loadMidiNotes(smf::MidiEventList const &iEvents)
 {
+  // at most one note lane entry per midi event
+  fSequencerTrack.reserveNotes(iEvents.size());
+
   for(int i = 0; i < iEvents.size(); i++)
   {
     auto &event = iEvents[i];
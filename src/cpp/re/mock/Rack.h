@@ -21,6 +21,7 @@
 #define __Pongasoft_re_mock_rack_h__
 
 #include <map>
+#include <chrono>
 #include "Motherboard.h"
 #include "ObjectManager.hpp"
 #include "Transport.h"
@@ -48,6 +49,34 @@ namespace rack {
  * fixed 64 audio frames/samples irrelevant of the sample rate. If the sample rate is higher more batches needs
  * to be processed in order to render more samples. */
 struct Duration { size_t fBatches{}; };
+
+/**
+ * Statistics returned by `Rack::preRoll()` */
+struct PreRollStats
+{
+  size_t fBatchCount{};
+  std::chrono::nanoseconds fElapsedTime{};
+
+  //! Returns the number of batches processed per second (wall clock)
+  double getBatchesPerSecond() const;
+};
+
+/**
+ * Memory used by the rack (returned by `Rack::memoryReport()`): one report per extension (keyed by extension id) and
+ * their total (where the peak of each subsystem is the sum of the peaks of the extensions) */
+struct MemoryReport
+{
+  std::map<int, re::mock::MemoryReport> fExtensions{};
+  re::mock::MemoryReport fTotal{};
+
+  std::string toString() const;
+};
+
+/**
+ * Trait used by `Rack::newDevice()` to automatically mark a device as an observer (see `Extension::setObserver()`).
+ * Specialize it (to `std::true_type`) for devices which only capture what other devices produce. */
+template<typename Device>
+struct is_observer : std::false_type {};
 }
 
 namespace timeline {
@@ -99,6 +128,14 @@ private:
 
   void loadMidiNotes(smf::MidiEventList const &iEvents);
 
+  //! The `value` properties at both ends of a cv out wire, resolved once (see `Rack::resolveCVOutSlots()`)
+  struct CVValueSlots
+  {
+    impl::JboxProperty *fFromValue;
+    ExtensionImpl *fToExtension;
+    impl::JboxProperty *fToValue;
+  };
+
 private:
   int fId;
   std::unique_ptr<Motherboard> fMotherboard;
@@ -109,7 +146,45 @@ private:
   std::vector<rack::Extension::CVWire> fCVInWires{};
   std::optional<rack::Extension::NoteWire> fNoteOutWire{};
   std::optional<rack::Extension::NoteWire> fNoteInWire{};
+  bool fObserver{};
   mutable std::optional<std::set<int>> fDependents{};
+  std::optional<std::vector<CVValueSlots>> fCVOutSlots{}; // resolved from fCVOutWires (reset when they change)
+  size_t fProcessedGeneration{}; // Rack::fBatchGeneration when last processed by nextBatch
+};
+
+}
+
+namespace rack {
+
+/**
+ * The state of a rack captured by `Rack::snapshot()`: the transport, the batch count and, for each extension, the
+ * state of its motherboard (see `MotherboardSnapshot`), its sequencer track and its wires. Restoring a snapshot
+ * (`Rack::restore()`) is much cheaper than building and warming up (`Rack::preRoll()`) a new rack, which makes it
+ * possible to run many variations from the same starting point. */
+class Snapshot
+{
+public:
+  friend class re::mock::Rack;
+
+private:
+  struct ExtensionState
+  {
+    int fId;
+    std::shared_ptr<const MotherboardSnapshot> fMotherboard;
+    sequencer::Track fSequencerTrack;
+    std::vector<rack::Extension::AudioWire> fAudioOutWires;
+    std::vector<rack::Extension::AudioWire> fAudioInWires;
+    std::vector<rack::Extension::CVWire> fCVOutWires;
+    std::vector<rack::Extension::CVWire> fCVInWires;
+    std::optional<rack::Extension::NoteWire> fNoteOutWire;
+    std::optional<rack::Extension::NoteWire> fNoteInWire;
+  };
+
+  Rack const *fRack{};
+  std::optional<Transport> fTransport{}; // Transport has no default constructor
+  size_t fBatchCount{};
+  sequencer::Time fSongEnd{};
+  std::vector<ExtensionState> fExtensions{};
 };
 
 }
@@ -124,6 +199,14 @@ public:
 
   rack::Extension newExtension(Config const &iConfig);
 
+  /**
+   * Same as calling `newExtension()` for each config (same ids, same order) except that the motherboards are
+   * created and initialized (lua parsing, properties, default patch...) concurrently. If any of them fails, none is
+   * added to the rack and the (first) error is rethrown.
+   *
+   * @param iThreadCount number of threads to use (`0` means `std::thread::hardware_concurrency()`) */
+  std::vector<rack::Extension> newExtensions(std::vector<Config> const &iConfigs, unsigned int iThreadCount = 0);
+
   template<typename Device>
   rack::ExtensionDevice<Device> newDevice(DeviceConfig<Device> const &iConfig);
 
@@ -198,6 +281,67 @@ public:
 
   inline size_t getBatchCount() const { return fBatchCount; }
 
+  /**
+   * Pre-rolls the rack for the given duration: the transport, the sequencer tracks and all devices (the
+   * `JBox_Export_RenderRealtime` api) are advanced exactly like `nextBatch()` does, since the state of the devices
+   * depends on it, but all observation work is skipped: observers (see `Extension::setObserver()`) are not rendered
+   * and wires leading to them are not copied.
+   *
+   * @return the number of batches processed and how long it took */
+  rack::PreRollStats preRoll(rack::Duration iDuration);
+
+  //! Executes the callback (which is expected to call `nextBatch()`) in pre-roll mode (see `preRoll(rack::Duration)`)
+  rack::PreRollStats preRoll(std::function<void()> const &iCallback);
+
+  //! Returns `true` while the rack is pre-rolling
+  inline bool isPreRolling() const { return fPreRolling; }
+
+  /**
+   * Traces (`JBOX_TRACE`) are recorded in a per device ring buffer and only formatted/output when flushed. By default
+   * they are flushed at the end of every batch. Disabling auto flush lets the traces accumulate (up to
+   * `Config::trace_buffer_size()`, after which they are dropped and counted) until `flushTraces()` is called. */
+  void setTraceAutoFlush(bool iAutoFlush) { fTraceAutoFlush = iAutoFlush; }
+
+  //! Returns `true` if the traces are flushed at the end of every batch (default)
+  bool getTraceAutoFlush() const { return fTraceAutoFlush; }
+
+  //! Formats and outputs all pending traces of all devices
+  void flushTraces(std::ostream &oStream = std::cout);
+
+  /**
+   * Captures the state of the rack (transport, sequencer tracks, wires and all the devices) so that it can be
+   * restored later (any number of times) with `restore()`.
+   *
+   * @note throws if a device uses a read/write native object which cannot be cloned (see
+   *       `Realtime::clone_native_object`, opt-in with `DeviceConfig::rt_cloner()`) */
+  rack::Snapshot snapshot() const;
+
+  /**
+   * Restores the state captured by `snapshot()`. The rack must contain the same extensions as when the snapshot was
+   * taken.
+   *
+   * @note the device instances are replaced by copies, so pointers to a device obtained before this call are no
+   *       longer valid (`rack::ExtensionDevice` always fetches the current instance)
+   * @note the state of the realtime controller (Lua globals set by the rtc bindings) is not part of the snapshot and
+   *       is not rewound */
+  void restore(rack::Snapshot const &iSnapshot);
+
+  /**
+   * Saves the state of the rack (batch count, song end, transport and the full state of every device, see
+   * `rack::Extension::saveState()`) to a compact binary file which can be loaded with `loadState()`, possibly in
+   * another process. Contrary to `snapshot()`, the sequencer tracks and wires are not saved: they are part of the
+   * test setup which is expected to be rebuilt the same way before loading.
+   *
+   * @note the transport resumes at the saved play position (the fractional part accumulated by the batches is not
+   *       saved) */
+  void saveState(std::string const &iFilePath) const;
+
+  //! Restores the state saved by `saveState()`. The rack must contain the same extensions (same ids, same configs).
+  void loadState(std::string const &iFilePath);
+
+  //! Memory used by each extension broken down by subsystem (see `Motherboard::memoryReport()`)
+  rack::MemoryReport memoryReport() const;
+
   static Motherboard &currentMotherboard();
 
   template<typename Device>
@@ -205,10 +349,11 @@ public:
 
 protected:
   void copyAudioBuffers(rack::Extension::AudioWire const &iWire);
-  void copyCVValue(rack::Extension::CVWire const &iWire);
+  void copyCVValue(impl::ExtensionImpl::CVValueSlots const &iSlots);
+  void resolveCVOutSlots(impl::ExtensionImpl &iExtension);
   void copyNoteEvents(rack::Extension::NoteWire const &iWire);
   void nextBatch(impl::ExtensionImpl &iExtension);
-  void nextBatch(impl::ExtensionImpl &iExtension, std::set<int> &iProcessedExtensions);
+  void nextBatch(impl::ExtensionImpl &iExtension, size_t iGeneration);
 
 protected:
 
@@ -216,8 +361,11 @@ protected:
   int fSampleRate;
   Transport fTransport;
   size_t fBatchCount{};
+  size_t fBatchGeneration{}; // incremented by every nextBatch (never restored, unlike fBatchCount)
+  bool fPreRolling{};
+  bool fTraceAutoFlush{true};
   sequencer::Time fSongEnd{101,1,1,0}; // same default as Reason, not exported to device
-  ObjectManager<std::shared_ptr<impl::ExtensionImpl>> fExtensions{};
+  SlotObjectManager<std::shared_ptr<impl::ExtensionImpl>> fExtensions{};
 };
 
 //------------------------------------------------------------------------
@@ -226,7 +374,10 @@ protected:
 template<typename Device>
 rack::ExtensionDevice<Device> Rack::newDevice(DeviceConfig<Device> const &iConfig)
 {
-  return rack::ExtensionDevice<Device>(newExtension(iConfig.getConfig()).fImpl);
+  auto extension = newExtension(iConfig.getConfig());
+  if constexpr(rack::is_observer<Device>::value)
+    extension.setObserver(true);
+  return rack::ExtensionDevice<Device>(extension.fImpl);
 }
 
 //------------------------------------------------------------------------
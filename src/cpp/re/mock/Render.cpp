@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "Render.h"
+#include "lua/RenderJobsLua.h"
+#include "stl.h"
+
+namespace re::mock::render {
+
+namespace impl {
+
+//------------------------------------------------------------------------
+// impl::toJobs
+//------------------------------------------------------------------------
+std::vector<Job> toJobs(lua::RenderJobsLua &iLua, fs::path const &iBaseDir)
+{
+  auto path = [&iBaseDir](std::string const &p) { return iBaseDir / fs::u8path(p); };
+
+  std::vector<Job> res{};
+  for(auto const &j: iLua.jobs())
+  {
+    Job job{};
+    job.fOutputFile = path(j.fOutput);
+    job.fName = j.fName ? *j.fName : job.fOutputFile.stem().u8string();
+    if(j.fPatch)
+      job.fPatchFile = path(*j.fPatch);
+    if(j.fMidi)
+      job.fMidiFile = path(*j.fMidi);
+    if(j.fInput)
+      job.fInputFile = path(*j.fInput);
+    if(j.fDurationMilliseconds)
+      job.fDuration = time::Duration{static_cast<float>(*j.fDurationMilliseconds)};
+    if(j.fSampleRate)
+      job.fSampleRate = *j.fSampleRate;
+    if(!j.fMainIn.empty())
+    {
+      RE_MOCK_ASSERT(j.fMainIn.size() == 2, "Job [%s]: main_in must be { left, right }", job.fName);
+      job.fMainIn = {j.fMainIn[0], j.fMainIn[1]};
+    }
+    if(!j.fMainOut.empty())
+    {
+      RE_MOCK_ASSERT(j.fMainOut.size() == 2, "Job [%s]: main_out must be { left, right }", job.fName);
+      job.fMainOut = {j.fMainOut[0], j.fMainOut[1]};
+    }
+    res.emplace_back(std::move(job));
+  }
+  return res;
+}
+
+//------------------------------------------------------------------------
+// impl::prepare
+//------------------------------------------------------------------------
+void prepare(DeviceTester &iTester, Job const &iJob)
+{
+  if(iJob.fPatchFile)
+    iTester.deviceLoadPatch(resource::File{*iJob.fPatchFile});
+  if(iJob.fMidiFile)
+    iTester.importMidi(resource::File{*iJob.fMidiFile});
+}
+
+}
+
+//------------------------------------------------------------------------
+// Job::fromFile
+//------------------------------------------------------------------------
+std::vector<Job> Job::fromFile(fs::path const &iJobFile)
+{
+  RE_MOCK_ASSERT(fs::is_regular_file(iJobFile), "Job file [%s] not found", iJobFile.u8string());
+  return impl::toJobs(*lua::RenderJobsLua::fromFile(iJobFile), iJobFile.parent_path());
+}
+
+//------------------------------------------------------------------------
+// Job::fromString
+//------------------------------------------------------------------------
+std::vector<Job> Job::fromString(std::string const &iJobs, fs::path const &iBaseDir)
+{
+  return impl::toJobs(*lua::RenderJobsLua::fromString(iJobs), iBaseDir);
+}
+
+//------------------------------------------------------------------------
+// Result::getRealTimeFactor
+//------------------------------------------------------------------------
+double Result::getRealTimeFactor() const
+{
+  if(fElapsedTime.count() == 0 || fSampleRate == 0)
+    return 0;
+  auto audioSeconds = static_cast<double>(fFrameCount) / fSampleRate;
+  return audioSeconds / std::chrono::duration<double>(fElapsedTime).count();
+}
+
+//------------------------------------------------------------------------
+// run
+//------------------------------------------------------------------------
+Result run(Config const &iDeviceConfig, Job const &iJob)
+{
+  Result res{};
+  res.fName = iJob.fName;
+  res.fSampleRate = iJob.fSampleRate;
+
+  try
+  {
+    // renders the job with the tester (only the rendering itself is timed)
+    auto render = [&iJob, &res](DeviceTester &iTester, auto &&iRenderer) {
+      impl::prepare(iTester, iJob);
+      auto start = std::chrono::steady_clock::now();
+      auto output = iRenderer();
+      res.fElapsedTime = std::chrono::steady_clock::now() - start;
+      res.fFrameCount = output->getFrameCount();
+      if(iJob.fOutputFile.has_parent_path())
+        fs::create_directories(iJob.fOutputFile.parent_path());
+      iTester.saveSample(*output, resource::File{iJob.fOutputFile});
+    };
+
+    switch(iDeviceConfig.info().fDeviceType)
+    {
+      case DeviceType::kInstrument:
+      {
+        ExtensionInstrumentTester tester(iDeviceConfig, iJob.fSampleRate);
+        tester.wireMainOut(iJob.fMainOut.first, iJob.fMainOut.second);
+        render(tester, [&tester, &iJob]() { return tester.bounce(iJob.fDuration); });
+        break;
+      }
+
+      case DeviceType::kStudioFX:
+      case DeviceType::kCreativeFX:
+      {
+        RE_MOCK_ASSERT(iJob.fInputFile.has_value(), "Job [%s]: an effect requires an input file", iJob.fName);
+        ExtensionEffectTester tester(iDeviceConfig, iJob.fSampleRate);
+        tester.wireMainIn(iJob.fMainIn.first, iJob.fMainIn.second);
+        tester.wireMainOut(iJob.fMainOut.first, iJob.fMainOut.second);
+        auto input = tester.loadSample(resource::File{*iJob.fInputFile});
+        render(tester, [&tester, &input, &iJob]() { return tester.processSample(*input, iJob.fDuration); });
+        break;
+      }
+
+      default:
+        RE_MOCK_FAIL("Job [%s]: only instruments and effects can be rendered", iJob.fName);
+    }
+  }
+  catch(std::exception &e)
+  {
+    res.fError = e.what();
+  }
+  catch(...)
+  {
+    res.fError = fmt::printf("Job [%s]: unknown error", iJob.fName);
+  }
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// run
+//------------------------------------------------------------------------
+std::vector<Result> run(Config const &iDeviceConfig, std::vector<Job> const &iJobs, unsigned int iThreadCount)
+{
+  std::vector<Result> res(iJobs.size());
+
+  stl::parallel_for(iJobs.size(), iThreadCount, [&iDeviceConfig, &iJobs, &res](size_t i) {
+    res[i] = run(iDeviceConfig, iJobs[i]);
+  });
+
+  return res;
+}
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_render_h__
+#define __Pongasoft_re_mock_render_h__
+
+#include "DeviceTesters.h"
+#include <chrono>
+
+/**
+ * Headless rendering of a device (used by the `re-mock-render` command line tool): each job loads a patch and/or a
+ * midi file into a fresh rack and bounces the output of the device to a wav file. */
+namespace re::mock::render {
+
+struct Job
+{
+  std::string fName{};
+  std::optional<fs::path> fPatchFile{};
+  std::optional<fs::path> fMidiFile{};
+  std::optional<fs::path> fInputFile{};
+  fs::path fOutputFile{};
+  time::Duration fDuration{}; // instrument: length of the bounce / effect: tail after the input
+  int fSampleRate{44100};
+  std::pair<std::string, std::string> fMainIn{"MainInLeft", "MainInRight"};    // effects only
+  std::pair<std::string, std::string> fMainOut{"MainOutLeft", "MainOutRight"};
+
+  /**
+   * Loads the jobs from a lua job file (see `lua::RenderJobsLua` for the syntax). Relative paths are resolved against
+   * the folder containing the job file. */
+  static std::vector<Job> fromFile(fs::path const &iJobFile);
+
+  //! Same as `fromFile` with relative paths resolved against `iBaseDir`
+  static std::vector<Job> fromString(std::string const &iJobs, fs::path const &iBaseDir);
+};
+
+struct Result
+{
+  std::string fName{};
+  TJBox_AudioFramePos fFrameCount{};
+  int fSampleRate{};
+  std::chrono::nanoseconds fElapsedTime{}; // rendering only (excludes loading the device and saving the output)
+  std::optional<std::string> fError{};
+
+  //! Duration of the audio rendered divided by the time it took (> 1 means faster than real time)
+  double getRealTimeFactor() const;
+};
+
+//! Renders the job with the device described by the config (never throws: errors are reported in the result)
+Result run(Config const &iDeviceConfig, Job const &iJob);
+
+/**
+ * Renders all the jobs using `iThreadCount` threads (`0` means one per core). Each job uses its own rack, so jobs
+ * are independent from each other.
+ *
+ * @return the results in the same order as the jobs */
+std::vector<Result> run(Config const &iDeviceConfig, std::vector<Job> const &iJobs, unsigned int iThreadCount = 0);
+
+}
+
+#endif //__Pongasoft_re_mock_render_h__
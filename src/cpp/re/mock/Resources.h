@@ -24,6 +24,7 @@
 #include <map>
 #include <vector>
 #include <variant>
+#include "AlignedAllocator.h"
 
 namespace re::mock::resource {
 
@@ -91,13 +92,13 @@ struct Sample
 {
   TJBox_UInt32 fChannels{1};
   TJBox_UInt32 fSampleRate{1};
-  std::vector<TJBox_AudioSample> fData{};
+  SampleData fData{}; // aligned (see kAudioAlignment)
 
   Sample &channels(TJBox_UInt32 c) { fChannels = c; return *this; }
   Sample &mono() { return channels(1); }
   Sample &stereo() { return channels(2); }
   Sample &sample_rate(TJBox_UInt32 s) { fSampleRate = s; return *this; }
-  Sample &data(std::vector<TJBox_AudioSample> d) { fData = std::move(d); return *this; }
+  Sample &data(std::vector<TJBox_AudioSample> const &d) { fData.assign(d.begin(), d.end()); return *this; }
 };
 
 }
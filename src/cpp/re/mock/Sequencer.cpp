@@ -19,6 +19,9 @@
 #include "Sequencer.h"
 #include "fmt.h"
 #include "Motherboard.h"
+#include <limits>
+#include <array>
+#include <bitset>
 
 namespace re::mock::sequencer {
 
@@ -181,35 +184,70 @@ Track &Track::event(TJBox_Float64 iAtPPQ, Event iEvent)
     fSorted = fEvents[fEvents.size() - 1].fAtPPQ <= iAtPPQ;
 
   fEvents.emplace_back(EventImpl{id, iAtPPQ, std::move(iEvent)});
+  invalidateCursor();
 
   return *this;
 }
 
 //------------------------------------------------------------------------
-// Track::noteOn
+// Track::noteEvent
 //------------------------------------------------------------------------
-Track &Track::noteOn(PPQ iTime, TJBox_UInt8 iNoteNumber, TJBox_UInt8 iNoteVelocity)
+Track &Track::noteEvent(TJBox_Float64 iAtPPQ, TJBox_UInt8 iNoteNumber, TJBox_UInt8 iNoteVelocity)
 {
-  event(iTime.count(),
-        [iNoteNumber, iNoteVelocity](Motherboard &iMotherboard, Batch const &iBatch) {
-          // we don't start a note that will be turned off anyway
-          if(iBatch.fType != Batch::Type::kLoopingStart)
-            iMotherboard.setNoteInEvent(iNoteNumber, iNoteVelocity, iBatch.fAtFrameIndex);
-        });
+  auto id = fLastEventId++;
+
+  if(fSorted && !fNotes.empty())
+    fSorted = fNotes.fAtPPQs[fNotes.size() - 1] <= iAtPPQ;
+
+  fNotes.add(id, iAtPPQ, iNoteNumber, iNoteVelocity);
+  invalidateCursor();
 
   return *this;
 }
 
+//------------------------------------------------------------------------
+// Track::automation
+//------------------------------------------------------------------------
+Track &Track::automation(std::string const &iPropertyPath, PPQ iTime, TJBox_Float64 iValue, Interpolation iInterpolation)
+{
+  auto lane = std::find_if(fAutomationLanes.begin(), fAutomationLanes.end(),
+                           [&iPropertyPath](AutomationLane const &l) { return l.fPropertyPath == iPropertyPath; });
+  if(lane == fAutomationLanes.end())
+    lane = fAutomationLanes.insert(lane, AutomationLane{iPropertyPath, fAutomationLanes.get_allocator()});
+
+  if(fSorted && !lane->empty())
+    fSorted = lane->fAtPPQs[lane->size() - 1] <= iTime.count();
+
+  lane->add(iTime.count(), iValue, iInterpolation);
+
+  return *this;
+}
+
+//------------------------------------------------------------------------
+// Track::automationResolution
+//------------------------------------------------------------------------
+Track &Track::automationResolution(int iFrameCount)
+{
+  RE_MOCK_ASSERT(iFrameCount >= 1 && iFrameCount <= constants::kBatchSize, "Invalid automation resolution [%d]", iFrameCount);
+  fAutomationResolution = iFrameCount;
+  return *this;
+}
+
+//------------------------------------------------------------------------
+// Track::noteOn
+//------------------------------------------------------------------------
+Track &Track::noteOn(PPQ iTime, TJBox_UInt8 iNoteNumber, TJBox_UInt8 iNoteVelocity)
+{
+  RE_MOCK_ASSERT(iNoteVelocity <= 127, "Invalid note velocity [%d]", iNoteVelocity);
+  return noteEvent(iTime.count(), iNoteNumber, iNoteVelocity);
+}
+
 //------------------------------------------------------------------------
 // Track::noteOff
 //------------------------------------------------------------------------
 Track &Track::noteOff(PPQ iTime, TJBox_UInt8 iNoteNumber)
 {
-  event(iTime.count(),
-        [iNoteNumber](Motherboard &iMotherboard, Batch const &iBatch) {
-          iMotherboard.stopNoteIfOn(iNoteNumber);
-        });
-  return *this;
+  return noteEvent(iTime.count(), iNoteNumber, NoteLane::kNoteOff);
 }
 
 //------------------------------------------------------------------------
@@ -242,22 +280,192 @@ void Track::executeEvents(Motherboard &iMotherboard,
     event(iMotherboard, batch);
 
   auto const &events = getEvents(); // events are sorted by fAtPPQ!
-
-  // binary search for the first event where fAtPPQ >= iPlayStartPos
-  auto event = std::lower_bound(events.begin(), events.end(), static_cast<TJBox_Float64>(iPlayBatchStartPos),
-                                [](EventImpl const &iEvent, TJBox_Float64 iValue) {
-                                  return iEvent.fAtPPQ < iValue;
-                                });
-
-  while(event != events.end() && event->fAtPPQ < iPlayBatchEndPos)
+  auto const &notes = getNotes(); // notes are sorted by fAtPPQ!
+
+  // computed once per batch (instead of once per event)
+  auto const frameIndexFactor = static_cast<TJBox_Float64>(iBatchSize) / static_cast<TJBox_Float64>(iPlayBatchEndPos - iPlayBatchStartPos);
+  auto toFrameIndex = [iAtFrameIndex, iPlayBatchStartPos, frameIndexFactor](TJBox_Float64 iAtPPQ) {
+    auto frameIndex = static_cast<TJBox_UInt16>(std::round(iAtFrameIndex + (iAtPPQ - iPlayBatchStartPos) * frameIndexFactor));
+    if(frameIndex == constants::kBatchSize)
+      frameIndex = constants::kBatchSize - 1;
+    RE_MOCK_INTERNAL_ASSERT(frameIndex >= 0 && frameIndex < constants::kBatchSize);
+    return frameIndex;
+  };
+
+  auto const cursor = bindCursor(iPlayBatchStartPos);
+  auto event = events.begin() + static_cast<std::ptrdiff_t>(cursor.fEvent);
+  auto note = cursor.fNote;
+
+  while(true)
   {
-    batch.fAtFrameIndex = std::round(iAtFrameIndex + iBatchSize * (event->fAtPPQ - iPlayBatchStartPos) / (iPlayBatchEndPos - iPlayBatchStartPos));
-    if(batch.fAtFrameIndex == constants::kBatchSize)
-      batch.fAtFrameIndex = constants::kBatchSize - 1;
-    RE_MOCK_INTERNAL_ASSERT(batch.fAtFrameIndex >= 0 && batch.fAtFrameIndex < constants::kBatchSize);
+    auto const hasEvent = event != events.end() && event->fAtPPQ < iPlayBatchEndPos;
+
+    // notes that happen before the next generic event (or until the end of the batch if there is none)
+    auto const limitPPQ = hasEvent ? event->fAtPPQ : static_cast<TJBox_Float64>(iPlayBatchEndPos);
+    auto const limitId = hasEvent ? event->fId : std::numeric_limits<int>::min();
+
+    while(note < notes.size() &&
+          (notes.fAtPPQs[note] < limitPPQ || (notes.fAtPPQs[note] == limitPPQ && notes.fIds[note] < limitId)))
+    {
+      auto const number = notes.fNumbers[note];
+      auto const velocity = notes.fVelocities[note];
+      if(velocity == NoteLane::kNoteOff)
+      {
+        iMotherboard.stopNoteIfOn(number);
+        fStats.fNoteCount++;
+      }
+      else
+      {
+        // we don't start a note that will be turned off anyway
+        if(iBatchType != Batch::Type::kLoopingStart)
+        {
+          iMotherboard.setNoteInEvent(number, velocity, toFrameIndex(notes.fAtPPQs[note]));
+          fStats.fNoteCount++;
+        }
+      }
+      note++;
+    }
+
+    if(!hasEvent)
+      break;
+
+    batch.fAtFrameIndex = toFrameIndex(event->fAtPPQ);
     event->fEvent(iMotherboard, batch);
+    fStats.fEventCount++;
     event++;
   }
+
+  // the next batch (if contiguous) resumes from here (unless an event modified the track in which case the cursor
+  // was invalidated)
+  if(fCursor.fValid)
+  {
+    fCursor.fPlayPos = iPlayBatchEndPos;
+    fCursor.fEvent = static_cast<size_t>(event - events.begin());
+    fCursor.fNote = note;
+  }
+
+  if(!fAutomationLanes.empty())
+    executeAutomation(iMotherboard, iPlayBatchStartPos, iPlayBatchEndPos, iAtFrameIndex, iBatchSize);
+}
+
+//------------------------------------------------------------------------
+// Track::executeAutomation
+//------------------------------------------------------------------------
+void Track::executeAutomation(Motherboard &iMotherboard,
+                              TJBox_Int64 iPlayBatchStartPos,
+                              TJBox_Int64 iPlayBatchEndPos,
+                              int iAtFrameIndex,
+                              int iBatchSize) const
+{
+  auto const frameIndexFactor = static_cast<TJBox_Float64>(iBatchSize) / static_cast<TJBox_Float64>(iPlayBatchEndPos - iPlayBatchStartPos);
+  auto const endFrameIndex = iAtFrameIndex + iBatchSize;
+  auto toPPQ = [iAtFrameIndex, iPlayBatchStartPos, frameIndexFactor](int iFrameIndex) {
+    return static_cast<TJBox_Float64>(iPlayBatchStartPos) + (iFrameIndex - iAtFrameIndex) / frameIndexFactor;
+  };
+
+  for(auto const &lane: getAutomationLanes())
+  {
+    if(lane.empty())
+      continue;
+
+    if(lane.fMotherboard != &iMotherboard)
+    {
+      auto property = iMotherboard.getProperty(lane.fPropertyPath);
+      RE_MOCK_ASSERT(property->fInfo.fValueType == JboxPropertyType::kNumber,
+                     "Automation is only supported for number properties [%s]", lane.fPropertyPath);
+      lane.fMotherboard = &iMotherboard;
+      lane.fProperty = property;
+    }
+
+    // same principle as the track cursor: relocate the lane on discontinuity only
+    if(!lane.fCursorValid || lane.fCursorPlayPos != iPlayBatchStartPos)
+    {
+      auto next = std::lower_bound(lane.fAtPPQs.begin(), lane.fAtPPQs.end(), static_cast<TJBox_Float64>(iPlayBatchStartPos));
+      lane.fCursorValid = true;
+      lane.fCursorNext = static_cast<size_t>(next - lane.fAtPPQs.begin());
+    }
+
+    auto const first = lane.fCursorNext;
+    auto last = first;
+    while(last < lane.size() && lane.fAtPPQs[last] < iPlayBatchEndPos)
+      last++;
+
+    lane.fCursorPlayPos = iPlayBatchEndPos;
+    lane.fCursorNext = last;
+
+    // the lane has not started yet
+    if(last == 0)
+      continue;
+
+    // frames at which the lane is evaluated: the resolution grid + the exact frame of each point in the batch
+    std::bitset<constants::kBatchSize> frames{};
+    std::array<TJBox_Float64, constants::kBatchSize> atPPQs; // only valid for the frames that are set
+    for(auto frameIndex = iAtFrameIndex; frameIndex < endFrameIndex; frameIndex += fAutomationResolution)
+    {
+      frames.set(frameIndex);
+      atPPQs[frameIndex] = toPPQ(frameIndex);
+    }
+    for(auto point = first; point < last; point++)
+    {
+      auto const pointPPQ = lane.fAtPPQs[point];
+      auto frameIndex = static_cast<int>(std::round(iAtFrameIndex + (pointPPQ - iPlayBatchStartPos) * frameIndexFactor));
+      frameIndex = std::min(frameIndex, endFrameIndex - 1);
+      // the point must be reached at the frame it rounds to (its exact value, not the one slightly before)
+      atPPQs[frameIndex] = frames.test(frameIndex) ? std::max(atPPQs[frameIndex], pointPPQ) : std::max(toPPQ(frameIndex), pointPPQ);
+      frames.set(frameIndex);
+    }
+
+    auto next = first > 0 ? first - 1 : 0;
+    for(auto frameIndex = iAtFrameIndex; frameIndex < endFrameIndex; frameIndex++)
+    {
+      if(!frames.test(frameIndex))
+        continue;
+
+      auto const atPPQ = atPPQs[frameIndex];
+      while(next < lane.size() && lane.fAtPPQs[next] <= atPPQ)
+        next++;
+
+      // before the first point of the lane
+      if(next == 0)
+        continue;
+
+      auto const value = lane.valueAt(next, atPPQ);
+      if(lane.fProperty->loadValue()->getNumber() != value)
+      {
+        iMotherboard.storeProperty(lane.fProperty, iMotherboard.makeNumber(value), static_cast<TJBox_UInt16>(frameIndex));
+        fStats.fAutomationCount++;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------
+// Track::bindCursor
+//------------------------------------------------------------------------
+Track::Cursor const &Track::bindCursor(TJBox_Int64 iPlayPos) const
+{
+  if(!fCursor.fValid || fCursor.fPlayPos != iPlayPos)
+  {
+    // discontinuity (first batch, loop, seek, new events...) => binary search for the first event/note where
+    // fAtPPQ >= iPlayPos
+    auto const &events = getEvents();
+    auto const &notes = getNotes();
+
+    auto event = std::lower_bound(events.begin(), events.end(), static_cast<TJBox_Float64>(iPlayPos),
+                                  [](EventImpl const &iEvent, TJBox_Float64 iValue) {
+                                    return iEvent.fAtPPQ < iValue;
+                                  });
+
+    auto note = std::lower_bound(notes.fAtPPQs.begin(), notes.fAtPPQs.end(), static_cast<TJBox_Float64>(iPlayPos));
+
+    fCursor.fValid = true;
+    fCursor.fPlayPos = iPlayPos;
+    fCursor.fEvent = static_cast<size_t>(event - events.begin());
+    fCursor.fNote = static_cast<size_t>(note - notes.fAtPPQs.begin());
+    fStats.fCursorRebindCount++;
+  }
+
+  return fCursor;
 }
 
 //------------------------------------------------------------------------
@@ -293,9 +501,12 @@ Track &Track::onEveryBatch(Track::Event iEvent)
 Track &Track::reset()
 {
   fEvents.clear();
+  fNotes.clear();
   fCurrentTime = Time{};
   fOnEveryBatchEvents.clear();
+  fAutomationLanes.clear();
   fSorted = true;
+  invalidateCursor();
   return *this;
 }
 
@@ -320,6 +531,11 @@ void Track::ensureSorted() const
                 else
                   return l.fAtPPQ < r.fAtPPQ;
               });
+
+    nonConstThis->fNotes.sort();
+
+    for(auto &lane: nonConstThis->fAutomationLanes)
+      lane.sort();
   }
 
   fSorted = true;
@@ -331,8 +547,18 @@ void Track::ensureSorted() const
 //------------------------------------------------------------------------
 Time Track::getFirstEventTime() const
 {
-  RE_MOCK_ASSERT(!fEvents.empty(), "no events");
-  return Time::from(getEvents().at(0).fAtPPQ, fTimeSignature);
+  auto res = std::numeric_limits<TJBox_Float64>::max();
+  if(!getEvents().empty())
+    res = std::min(res, fEvents.front().fAtPPQ);
+  if(!fNotes.empty())
+    res = std::min(res, fNotes.fAtPPQs.front());
+  for(auto const &lane: fAutomationLanes)
+  {
+    if(!lane.empty())
+      res = std::min(res, lane.fAtPPQs.front());
+  }
+  RE_MOCK_ASSERT(res != std::numeric_limits<TJBox_Float64>::max(), "no events");
+  return Time::from(res, fTimeSignature);
 }
 
 //------------------------------------------------------------------------
@@ -340,8 +566,134 @@ Time Track::getFirstEventTime() const
 //------------------------------------------------------------------------
 Time Track::getLastEventTime() const
 {
-  RE_MOCK_ASSERT(!fEvents.empty(), "no events");
-  return Time::from(getEvents().at(fEvents.size() - 1).fAtPPQ, fTimeSignature);
+  auto res = std::numeric_limits<TJBox_Float64>::lowest();
+  if(!getEvents().empty())
+    res = std::max(res, fEvents.back().fAtPPQ);
+  if(!fNotes.empty())
+    res = std::max(res, fNotes.fAtPPQs.back());
+  for(auto const &lane: fAutomationLanes)
+  {
+    if(!lane.empty())
+      res = std::max(res, lane.fAtPPQs.back());
+  }
+  RE_MOCK_ASSERT(res != std::numeric_limits<TJBox_Float64>::lowest(), "no events");
+  return Time::from(res, fTimeSignature);
+}
+
+//------------------------------------------------------------------------
+// Track::NoteLane::add
+//------------------------------------------------------------------------
+void Track::NoteLane::add(int iId, TJBox_Float64 iAtPPQ, TJBox_UInt8 iNumber, TJBox_UInt8 iVelocity)
+{
+  fIds.emplace_back(iId);
+  fAtPPQs.emplace_back(iAtPPQ);
+  fNumbers.emplace_back(iNumber);
+  fVelocities.emplace_back(iVelocity);
+}
+
+//------------------------------------------------------------------------
+// Track::NoteLane::reserve
+//------------------------------------------------------------------------
+void Track::NoteLane::reserve(size_t iCount)
+{
+  fIds.reserve(iCount);
+  fAtPPQs.reserve(iCount);
+  fNumbers.reserve(iCount);
+  fVelocities.reserve(iCount);
+}
+
+//------------------------------------------------------------------------
+// Track::NoteLane::clear
+//------------------------------------------------------------------------
+void Track::NoteLane::clear()
+{
+  fIds.clear();
+  fAtPPQs.clear();
+  fNumbers.clear();
+  fVelocities.clear();
+}
+
+//------------------------------------------------------------------------
+// Track::NoteLane::sort
+//------------------------------------------------------------------------
+void Track::NoteLane::sort()
+{
+  auto const count = size();
+
+  // sort an array of indices (much cheaper to move around than the arrays themselves)...
+  std::vector<size_t> order(count);
+  for(size_t i = 0; i < count; i++)
+    order[i] = i;
+
+  std::sort(order.begin(), order.end(), [this](size_t l, size_t r) {
+    if(fAtPPQs[l] == fAtPPQs[r])
+      return fIds[l] < fIds[r];
+    else
+      return fAtPPQs[l] < fAtPPQs[r];
+  });
+
+  // ... then apply the permutation to each array
+  NoteLane sorted{fIds.get_allocator()};
+  sorted.reserve(count);
+  for(auto i: order)
+    sorted.add(fIds[i], fAtPPQs[i], fNumbers[i], fVelocities[i]);
+
+  *this = std::move(sorted);
+}
+
+//------------------------------------------------------------------------
+// Track::AutomationLane::add
+//------------------------------------------------------------------------
+void Track::AutomationLane::add(TJBox_Float64 iAtPPQ, TJBox_Float64 iValue, Interpolation iInterpolation)
+{
+  fAtPPQs.emplace_back(iAtPPQ);
+  fValues.emplace_back(iValue);
+  fInterpolations.emplace_back(iInterpolation);
+  fCursorValid = false;
+}
+
+//------------------------------------------------------------------------
+// Track::AutomationLane::sort
+//------------------------------------------------------------------------
+void Track::AutomationLane::sort()
+{
+  if(std::is_sorted(fAtPPQs.begin(), fAtPPQs.end()))
+    return;
+
+  auto const count = size();
+
+  // same as NoteLane::sort (stable so that points at the same time remain in insertion order)
+  std::vector<size_t> order(count);
+  for(size_t i = 0; i < count; i++)
+    order[i] = i;
+
+  std::stable_sort(order.begin(), order.end(), [this](size_t l, size_t r) { return fAtPPQs[l] < fAtPPQs[r]; });
+
+  AutomationLane sorted{fPropertyPath, fAtPPQs.get_allocator()};
+  sorted.fAtPPQs.reserve(count);
+  sorted.fValues.reserve(count);
+  sorted.fInterpolations.reserve(count);
+  for(auto i: order)
+    sorted.add(fAtPPQs[i], fValues[i], fInterpolations[i]);
+
+  *this = std::move(sorted);
+}
+
+//------------------------------------------------------------------------
+// Track::AutomationLane::valueAt
+//------------------------------------------------------------------------
+TJBox_Float64 Track::AutomationLane::valueAt(size_t iNext, TJBox_Float64 iAtPPQ) const
+{
+  RE_MOCK_INTERNAL_ASSERT(iNext > 0 && iNext <= size());
+
+  auto const previous = iNext - 1;
+
+  // after the last point or holding the value until the next point
+  if(iNext == size() || fInterpolations[iNext] == Interpolation::kStep)
+    return fValues[previous];
+
+  auto const ratio = (iAtPPQ - fAtPPQs[previous]) / (fAtPPQs[iNext] - fAtPPQs[previous]);
+  return fValues[previous] + (fValues[iNext] - fValues[previous]) * ratio;
 }
 
 //------------------------------------------------------------------------
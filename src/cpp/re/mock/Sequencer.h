@@ -24,10 +24,13 @@
 #include <vector>
 #include <functional>
 #include "Errors.h"
+#include "Constants.h"
+#include "MemoryAccounting.h"
 
 namespace re::mock {
 class Motherboard;
 class Rack;
+namespace impl { class ExtensionImpl; struct JboxProperty; }
 }
 
 namespace re::mock::sequencer {
@@ -229,6 +232,16 @@ struct Note
  * This example sets a C3 note starting at 2.1.1.0 for a duration of 120 ticks, a C4 note that starts at 2.2.1.0 and
  * lasts 1 16th, and finally changes the custom property "gain" to 0.8 at 2.2.1.0.
  *
+ * Property changes that follow a curve are better expressed as automation (no closure involved, and the values are
+ * computed for the exact frame they happen at):
+ *
+ * ```cpp
+ * tester.sequencerTrack()
+ *   .automation("/custom_properties/gain", sequencer::Time(1,1,1,0), 0.0)
+ *   .automation("/custom_properties/gain", sequencer::Time(2,1,1,0), 1.0) // ramps from 0 to 1 during the first bar
+ *   .automation("/custom_properties/gain", sequencer::Time(3,1,1,0), 0.5, sequencer::Track::Interpolation::kStep);
+ * ```
+ *
  * @note It is possible to populate the sequencer track with (imported) midi notes. Check `DeviceTester::importMidi()`
  *       and `Extension::importMidiNotes()`
  *
@@ -256,6 +269,24 @@ public:
    * the event is happening. */
   using Event = std::function<void(Motherboard &, Batch const &)>;
 
+  /**
+   * Counters about the events dispatched by this track while playing (see `getStats()`) */
+  struct Stats
+  {
+    size_t fEventCount{};        //!< number of generic events dispatched
+    size_t fNoteCount{};         //!< number of note on/off events dispatched
+    size_t fCursorRebindCount{}; //!< number of times the play cursor had to be relocated (seek, loop...)
+    size_t fAutomationCount{};   //!< number of property values stored by automation lanes
+  };
+
+  /**
+   * How the value of an automation lane goes from the previous point to the next one */
+  enum class Interpolation : TJBox_UInt8
+  {
+    kStep,  //!< the previous value is held until the point is reached
+    kLinear //!< the value ramps linearly from the previous value to the value of the point
+  };
+
   //! An event that does nothing
   static const Event kNoOp;
 
@@ -263,8 +294,14 @@ public:
   static Event wrap(SimpleEvent iEvent);
 
 public:
-  //! Constructor
-  explicit Track(TimeSignature iTimeSignature = {}) : fTimeSignature{iTimeSignature} {}
+  //! Constructor (the events, notes and automation are reported to `iMemoryCounter` if provided)
+  explicit Track(TimeSignature iTimeSignature = {}, std::shared_ptr<MemoryCounter> const &iMemoryCounter = {}) :
+    fTimeSignature{iTimeSignature},
+    fEvents{CountingAllocator<EventImpl>{iMemoryCounter}},
+    fNotes{CountingAllocator<char>{iMemoryCounter}},
+    fAutomationLanes{CountingAllocator<AutomationLane>{iMemoryCounter}},
+    fOnEveryBatchEvents{CountingAllocator<Event>{iMemoryCounter}}
+  {}
 
   /**
    * Moves the "current" time to the time provided. All apis which do not take a time use this "current" time.
@@ -344,6 +381,29 @@ public:
   //! Add a (simple) event that happens on every batch
   Track &onEveryBatch(SimpleEvent iEvent) { return onEveryBatch(wrap(iEvent)); }
 
+  /**
+   * Adds a point to the automation lane of the (number) property `iPropertyPath`: the property reaches `iValue` at
+   * the time (provided in PPQ), `iInterpolation` defining how it gets there from the previous point. The property is
+   * not touched before the first point of the lane and keeps the value of the last point after it. */
+  Track &automation(std::string const &iPropertyPath, PPQ iTime, TJBox_Float64 iValue, Interpolation iInterpolation = Interpolation::kLinear);
+
+  //! Adds an automation point at the time provided (see `automation(std::string const &, PPQ, ...)`)
+  inline Track &automation(std::string const &iPropertyPath, Time iTime, TJBox_Float64 iValue, Interpolation iInterpolation = Interpolation::kLinear) {
+    return automation(iPropertyPath, iTime.toPPQ(), iValue, iInterpolation);
+  }
+
+  //! Adds an automation point at the "current" time (defined by `at` or `after`)
+  Track &automation(std::string const &iPropertyPath, TJBox_Float64 iValue, Interpolation iInterpolation = Interpolation::kLinear) {
+    return automation(iPropertyPath, fCurrentTime, iValue, iInterpolation);
+  }
+
+  /**
+   * Defines how often (in frames) automation lanes are evaluated while a linear segment is in progress. The default
+   * (`constants::kBatchSize`) stores one grid value per batch (at the beginning of the batch) plus one value per point
+   * falling in the batch, whereas 1 stores a value for every frame where it changes (sample accurate). Points are
+   * always applied at the exact frame they happen, whatever the resolution. */
+  Track &automationResolution(int iFrameCount);
+
   //! Clear all events and reset the "current" time to `1.1.1.0`
   Track &reset();
 
@@ -356,7 +416,14 @@ public:
   //! Returns the time at which the last event happens
   Time getLastEventTime() const;
 
+  //! Returns the counters about the events dispatched so far
+  Stats const &getStats() const { return fStats; }
+
+  //! Resets the counters about the events dispatched
+  void resetStats() { fStats = {}; }
+
   friend class re::mock::Rack;
+  friend class re::mock::impl::ExtensionImpl;
 
 private:
   struct EventImpl
@@ -366,11 +433,89 @@ private:
     Event fEvent{};
   };
 
+  /**
+   * Notes are by far the most common events on a track (especially when importing a midi file) so instead of being
+   * stored as generic events (one closure per note on/off), they are stored in a dedicated "lane" (struct of arrays).
+   * Notes and generic events share the same id sequence so that their relative order is preserved. */
+  struct NoteLane
+  {
+    //! Velocity used to represent a "note off" event (midi velocity is always <= 127)
+    constexpr static TJBox_UInt8 kNoteOff = 0xff;
+
+    explicit NoteLane(CountingAllocator<char> const &iAllocator) :
+      fIds{iAllocator}, fAtPPQs{iAllocator}, fNumbers{iAllocator}, fVelocities{iAllocator} {}
+
+    void add(int iId, TJBox_Float64 iAtPPQ, TJBox_UInt8 iNumber, TJBox_UInt8 iVelocity);
+    void reserve(size_t iCount);
+    void clear();
+    void sort();
+    inline size_t size() const { return fIds.size(); }
+    inline bool empty() const { return fIds.empty(); }
+
+    counted_vector<int> fIds;
+    counted_vector<TJBox_Float64> fAtPPQs;
+    counted_vector<TJBox_UInt8> fNumbers;
+    counted_vector<TJBox_UInt8> fVelocities;
+  };
+
+  /**
+   * The points of the automation of a single property (struct of arrays, sorted by fAtPPQ when played). The property
+   * is resolved on first use and the lane keeps its own cursor (index of the first point not yet reached). */
+  struct AutomationLane
+  {
+    AutomationLane(std::string iPropertyPath, CountingAllocator<char> const &iAllocator) :
+      fPropertyPath{std::move(iPropertyPath)}, fAtPPQs{iAllocator}, fValues{iAllocator}, fInterpolations{iAllocator} {}
+
+    void add(TJBox_Float64 iAtPPQ, TJBox_Float64 iValue, Interpolation iInterpolation);
+    void sort();
+    inline size_t size() const { return fAtPPQs.size(); }
+    inline bool empty() const { return fAtPPQs.empty(); }
+
+    //! Value of the lane at `iAtPPQ` where `iNext` is the index of the first point after `iAtPPQ` (must be > 0)
+    TJBox_Float64 valueAt(size_t iNext, TJBox_Float64 iAtPPQ) const;
+
+    std::string fPropertyPath;
+    counted_vector<TJBox_Float64> fAtPPQs;
+    counted_vector<TJBox_Float64> fValues;
+    counted_vector<Interpolation> fInterpolations;
+
+    mutable Motherboard const *fMotherboard{};
+    mutable impl::JboxProperty *fProperty{};
+    mutable bool fCursorValid{};
+    mutable TJBox_Int64 fCursorPlayPos{};
+    mutable size_t fCursorNext{};
+  };
+
+  /**
+   * Playback is monotonic except when looping or when the play position changes: the cursor remembers where the
+   * previous batch ended so that the next batch can resume from there instead of searching for the first event. */
+  struct Cursor
+  {
+    bool fValid{};
+    TJBox_Int64 fPlayPos{}; // the play position at which the cursor is valid
+    size_t fEvent{};
+    size_t fNote{};
+  };
+
   void ensureSorted() const;
+  void invalidateCursor() const { fCursor.fValid = false; }
+  Cursor const &bindCursor(TJBox_Int64 iPlayPos) const;
 
   Track &event(TJBox_Float64 iAtPPQ, Event iEvent);
+  Track &noteEvent(TJBox_Float64 iAtPPQ, TJBox_UInt8 iNoteNumber, TJBox_UInt8 iNoteVelocity);
+
+  //! Reserves enough space in the note lane for `iCount` additional note on/off events
+  void reserveNotes(size_t iCount) { fNotes.reserve(fNotes.size() + iCount); }
+
+  counted_vector<EventImpl> const &getEvents() const { ensureSorted(); return fEvents; }
+  NoteLane const &getNotes() const { ensureSorted(); return fNotes; }
+  counted_vector<AutomationLane> const &getAutomationLanes() const { ensureSorted(); return fAutomationLanes; }
 
-  std::vector<EventImpl> const &getEvents() const { ensureSorted(); return fEvents; }
+  void executeAutomation(Motherboard &iMotherboard,
+                         TJBox_Int64 iPlayBatchStartPos,
+                         TJBox_Int64 iPlayBatchEndPos,
+                         int iAtFrameIndex,
+                         int iBatchSize) const;
 
   //! Execute
   void executeEvents(Motherboard &iMotherboard,
@@ -383,10 +528,15 @@ private:
 private:
   TimeSignature fTimeSignature;
   Time fCurrentTime{};
-  std::vector<EventImpl> fEvents{};
+  counted_vector<EventImpl> fEvents;
+  NoteLane fNotes;
+  counted_vector<AutomationLane> fAutomationLanes;
+  int fAutomationResolution{constants::kBatchSize};
   mutable bool fSorted{true};
   int fLastEventId{};
-  std::vector<Event> fOnEveryBatchEvents{};
+  counted_vector<Event> fOnEveryBatchEvents;
+  mutable Cursor fCursor{};
+  mutable Stats fStats{};
 };
 
 }
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "StateArchive.h"
+
+namespace re::mock {
+
+namespace {
+constexpr BinaryWriter::Magic kMagic{'R', 'E', 'M', 'S'};
+}
+
+//------------------------------------------------------------------------
+// StateArchive::Writer::Writer
+//------------------------------------------------------------------------
+StateArchive::Writer::Writer(Kind iKind) : BinaryWriter{kMagic, kVersion}
+{
+  write(iKind);
+}
+
+//------------------------------------------------------------------------
+// StateArchive::Reader::load
+//------------------------------------------------------------------------
+StateArchive::Reader StateArchive::Reader::load(std::string const &iFilePath, Kind iKind)
+{
+  Reader res{BinaryReader::load(iFilePath, kMagic, kVersion, "state")};
+  auto kind = res.read<Kind>();
+  RE_MOCK_ASSERT(kind == iKind, "[%s] is not a %s state", iFilePath, iKind == Kind::kRack ? "rack" : "device");
+  return res;
+}
+
+}
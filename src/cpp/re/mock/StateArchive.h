@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_state_archive_h__
+#define __Pongasoft_re_mock_state_archive_h__
+
+#include "BinaryStream.h"
+
+namespace re::mock {
+
+/**
+ * A compact binary checkpoint of the full state of a device (`rack::Extension::saveState()`) or of a whole rack
+ * (`Rack::saveState()`), meant to resume a long test (or start a CI shard) from a warmed up state. Contrary to a
+ * patch, it contains every property value (including the song persisted and rt owned ones), the note states, the
+ * loaded samples / blobs (as references to their resource) and, for a rack, the transport.
+ *
+ * Binary format (see `BinaryWriter`):
+ *
+ * - header: `REMS` + version (`UInt32`) + kind (`UInt8`, see `Kind`)
+ * - `kRack`: batch count (`UInt64`), song end (ppq as `Float64` + time signature as 2 `Int32`), transport (see
+ *   `Rack::saveState()`), extension count (`UInt32`) then, for each extension: instance id (`Int32`) + device state
+ * - `kDevice`: device state
+ * - device state: property count (`UInt32`) then, for each property: path (`UInt32` size + chars), patch dirty
+ *   flag (`UInt8`), value type (`UInt8`) + value (see `Motherboard::saveState()`) */
+class StateArchive
+{
+public:
+  constexpr static TJBox_UInt32 kVersion = 1;
+
+  enum class Kind : TJBox_UInt8
+  {
+    kDevice = 1,
+    kRack   = 2
+  };
+
+  //! Accumulates the state in memory (`save()` writes it to a file at once)
+  class Writer : public BinaryWriter
+  {
+  public:
+    explicit Writer(Kind iKind);
+  };
+
+  //! Reads a state (every read is bounds checked)
+  class Reader : public BinaryReader
+  {
+  public:
+    /**
+     * Reads the file at once and validates its header.
+     *
+     * @throw Exception if the file cannot be read or is not a (compatible) state of this kind */
+    static Reader load(std::string const &iFilePath, Kind iKind);
+
+  private:
+    explicit Reader(BinaryReader iReader) : BinaryReader{std::move(iReader)} {}
+  };
+};
+
+}
+
+#endif //__Pongasoft_re_mock_state_archive_h__
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "TraceRing.h"
+#include "Errors.h"
+#include "fmt.h"
+#include <cstring>
+#include <algorithm>
+
+namespace re::mock {
+
+//------------------------------------------------------------------------
+// TraceRing::Text::store
+//------------------------------------------------------------------------
+template<size_t N>
+bool TraceRing::Text<N>::store(char const *iString)
+{
+  if(!iString)
+    iString = "";
+  auto len = std::strlen(iString);
+  fSpilled = len >= N;
+  if(fSpilled)
+    fOverflow.assign(iString, len);
+  else
+  {
+    std::memcpy(fInline.data(), iString, len);
+    fInline[len] = '\0';
+  }
+  return fSpilled;
+}
+
+//------------------------------------------------------------------------
+// TraceRing::TraceRing
+//------------------------------------------------------------------------
+TraceRing::TraceRing(size_t iCapacity) : fEntries(iCapacity + 1) // one entry is always kept empty (full vs empty)
+{
+  RE_MOCK_ASSERT(iCapacity > 0, "trace ring capacity must be > 0");
+}
+
+//------------------------------------------------------------------------
+// TraceRing::acquire
+//------------------------------------------------------------------------
+TraceRing::Entry *TraceRing::acquire()
+{
+  auto head = fHead.load(std::memory_order_relaxed);
+  auto next = head + 1 == fEntries.size() ? 0 : head + 1;
+  if(next == fTail.load(std::memory_order_acquire))
+  {
+    fDroppedCount.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  return &fEntries[head];
+}
+
+//------------------------------------------------------------------------
+// TraceRing::publish
+//------------------------------------------------------------------------
+void TraceRing::publish(Entry const *iEntry)
+{
+  if(iEntry->fFile.fSpilled || iEntry->fMessage.fSpilled)
+    fSpilledCount.fetch_add(1, std::memory_order_relaxed);
+  auto head = fHead.load(std::memory_order_relaxed);
+  fHead.store(head + 1 == fEntries.size() ? 0 : head + 1, std::memory_order_release);
+  fRecordedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------
+// TraceRing::trace
+//------------------------------------------------------------------------
+bool TraceRing::trace(char const *iFile, TJBox_Int32 iLine, char const *iMessage)
+{
+  auto entry = acquire();
+  if(!entry)
+    return false;
+
+  entry->fFile.store(iFile);
+  entry->fLine = iLine;
+  entry->fMessage.store(iMessage);
+  entry->fValueCount = -1;
+
+  publish(entry);
+  return true;
+}
+
+//------------------------------------------------------------------------
+// TraceRing::traceValues
+//------------------------------------------------------------------------
+bool TraceRing::traceValues(char const *iFile,
+                            TJBox_Int32 iLine,
+                            char const *iTemplate,
+                            TJBox_Value const iValues[],
+                            TJBox_Int32 iValueCount)
+{
+  RE_MOCK_ASSERT(iValueCount >= 0 && iValueCount <= kMaxValueCount, "Too many values (%d)", iValueCount);
+
+  auto entry = acquire();
+  if(!entry)
+    return false;
+
+  entry->fFile.store(iFile);
+  entry->fLine = iLine;
+  entry->fMessage.store(iTemplate);
+  entry->fValueCount = iValueCount;
+  std::copy(iValues, iValues + iValueCount, entry->fValues.begin());
+
+  publish(entry);
+  return true;
+}
+
+//------------------------------------------------------------------------
+// TraceRing::drain
+//------------------------------------------------------------------------
+size_t TraceRing::drain(ValueFormatter const &iFormatter, Consumer const &iConsumer)
+{
+  size_t count = 0;
+
+  std::vector<std::string> values{};
+  std::string message{};
+
+  auto tail = fTail.load(std::memory_order_relaxed);
+  auto const head = fHead.load(std::memory_order_acquire);
+
+  while(tail != head)
+  {
+    auto const &entry = fEntries[tail];
+
+    if(entry.fValueCount < 0)
+      iConsumer(entry.fFile.c_str(), entry.fLine, entry.fMessage.c_str());
+    else
+    {
+      values.clear();
+      for(int i = 0; i < entry.fValueCount; i++)
+        values.emplace_back(iFormatter(entry.fValues[i]));
+      message.clear();
+      fmt::impl::printf(entry.fMessage.c_str(), values, std::back_inserter(message));
+      iConsumer(entry.fFile.c_str(), entry.fLine, message);
+    }
+
+    tail = tail + 1 == fEntries.size() ? 0 : tail + 1;
+    // releases the entry to the producer
+    fTail.store(tail, std::memory_order_release);
+    count++;
+  }
+
+  return count;
+}
+
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_trace_ring_h__
+#define __Pongasoft_re_mock_trace_ring_h__
+
+#include <JukeboxTypes.h>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <string>
+#include <functional>
+#include <string_view>
+
+namespace re::mock {
+
+/**
+ * Bounded, preallocated, lock-free (single producer / single consumer) ring buffer of traces (`JBox_Trace` and
+ * `JBox_TraceValues`). Recording a trace simply copies the raw information (file, line, message or template and
+ * values) into a preallocated entry: no formatting, no allocation and no I/O. Formatting and output happen when
+ * the ring is drained (`drain`).
+ *
+ * When the ring is full, the trace is dropped and counted (see `getDroppedCount()`).
+ *
+ * A file or message which does not fit in the preallocated entry is never truncated: it is stored out of line
+ * instead (which may allocate the first time an entry spills) and counted (see `getSpilledCount()`).
+ *
+ * @note The producer is the thread rendering the device and the consumer is the thread calling `drain`: they can
+ *       be different threads, but there can only be one of each at any given time. */
+class TraceRing
+{
+public:
+  constexpr static size_t kMaxFileSize = 64;     // stored out of line when longer
+  constexpr static size_t kMaxMessageSize = 192; // stored out of line when longer
+  constexpr static int kMaxValueCount = 10;      // ^0 to ^9
+
+  //! Converts a (primitive) value into a string (used when draining)
+  using ValueFormatter = std::function<std::string(TJBox_Value const &)>;
+
+  struct Stats
+  {
+    size_t fRecordedCount{}; //!< number of traces recorded in the ring
+    size_t fDroppedCount{};  //!< number of traces dropped because the ring was full
+    size_t fSpilledCount{};  //!< number of traces whose file or message did not fit in the entry (stored out of line)
+  };
+
+  //! Called for each formatted trace when draining
+  using Consumer = std::function<void(std::string_view iFile, TJBox_Int32 iLine, std::string_view iMessage)>;
+
+public:
+  explicit TraceRing(size_t iCapacity);
+
+  //! Records a trace. Returns `false` if the trace was dropped (ring full)
+  bool trace(char const *iFile, TJBox_Int32 iLine, char const *iMessage);
+
+  /**
+   * Records a trace with values (values are stored raw and formatted on `drain`). Returns `false` if the trace
+   * was dropped (ring full)
+   *
+   * @note Only primitive values (nil, number, boolean) can be stored raw since other values only exist for the
+   *       duration of the batch. The caller is expected to format the message upfront otherwise (`trace`). */
+  bool traceValues(char const *iFile, TJBox_Int32 iLine, char const *iTemplate, TJBox_Value const iValues[], TJBox_Int32 iValueCount);
+
+  //! Formats all pending traces (in order) and hands them to `iConsumer`. Returns the number of traces consumed
+  size_t drain(ValueFormatter const &iFormatter, Consumer const &iConsumer);
+
+  size_t getCapacity() const { return fEntries.size() - 1; }
+  size_t getRecordedCount() const { return fRecordedCount.load(std::memory_order_relaxed); }
+  size_t getDroppedCount() const { return fDroppedCount.load(std::memory_order_relaxed); }
+  size_t getSpilledCount() const { return fSpilledCount.load(std::memory_order_relaxed); }
+  Stats getStats() const { return {getRecordedCount(), getDroppedCount(), getSpilledCount()}; }
+
+private:
+  //! Preallocated string which spills into `fOverflow` when too long (its capacity is then reused by later traces)
+  template<size_t N>
+  struct Text
+  {
+    std::array<char, N> fInline{};
+    std::string fOverflow{};
+    bool fSpilled{};
+
+    //! Returns `true` if the string had to be stored out of line
+    bool store(char const *iString);
+    char const *c_str() const { return fSpilled ? fOverflow.c_str() : fInline.data(); }
+  };
+
+  struct Entry
+  {
+    Text<kMaxFileSize> fFile{};
+    TJBox_Int32 fLine{};
+    Text<kMaxMessageSize> fMessage{}; // message or template
+    TJBox_Int32 fValueCount{-1}; // -1 => plain message
+    std::array<TJBox_Value, kMaxValueCount> fValues{};
+  };
+
+  Entry *acquire();
+  void publish(Entry const *iEntry);
+
+private:
+  std::vector<Entry> fEntries;
+  std::atomic<size_t> fHead{}; // next entry to write (producer)
+  std::atomic<size_t> fTail{}; // next entry to read (consumer)
+  std::atomic<size_t> fRecordedCount{};
+  std::atomic<size_t> fDroppedCount{};
+  std::atomic<size_t> fSpilledCount{};
+};
+
+}
+
+#endif //__Pongasoft_re_mock_trace_ring_h__
@@ -19,13 +19,13 @@
 #include "Errors.h"
 #include <JukeboxTypes.h>
 #include <complex>
-#include <valarray>
+#include "AlignedAllocator.h"
 #include "fft.h"
 
 namespace re::mock {
 
 using Complex = std::complex<TJBox_Float32>;
-using ComplexArray = std::valarray<Complex>;
+using ComplexArray = aligned_vector<Complex>; // aligned working memory
 
 namespace impl {
 
@@ -41,8 +41,13 @@ void inPlaceFFT(ComplexArray &ioData)
   if(N <= 1)
     return;
 
-  ComplexArray even = ioData[std::slice(0, N / 2, 2)];
-  ComplexArray odd = ioData[std::slice(1, N / 2, 2)];
+  ComplexArray even(N / 2);
+  ComplexArray odd(N / 2);
+  for(size_t k = 0; k < N / 2; ++k)
+  {
+    even[k] = ioData[2 * k];
+    odd[k] = ioData[2 * k + 1];
+  }
 
   inPlaceFFT(even);
   inPlaceFFT(odd);
@@ -63,10 +68,12 @@ void inPlaceFFT(ComplexArray &ioData)
 //------------------------------------------------------------------------
 void inPlaceInverseFFT(ComplexArray &ioData)
 {
-  ioData = ioData.apply(std::conj);
+  for(auto &c: ioData)
+    c = std::conj(c);
   inPlaceFFT(ioData);
-  ioData = ioData.apply(std::conj);
-  ioData /= ioData.size();
+  auto const N = static_cast<TJBox_Float32>(ioData.size());
+  for(auto &c: ioData)
+    c = std::conj(c) / N;
 }
 
 }
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdlib>
 #include <re/mock/fmt.h>
 #include <re/mock/Errors.h>
 
@@ -114,12 +115,39 @@ static int lua_panic(lua_State *L)
     throw re::mock::Exception("panic");
 }
 
+//------------------------------------------------------------------------
+// lua_counting_alloc (same as the default lua allocator but reports to the counter)
+//------------------------------------------------------------------------
+static void *lua_counting_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+  auto counter = static_cast<MemoryCounter *>(ud);
+  auto const oldSize = ptr ? osize : 0; // when ptr is NULL, osize is the type of object (not a size)
+
+  if(nsize == 0)
+  {
+    free(ptr);
+    if(counter)
+      counter->deallocate(oldSize);
+    return nullptr;
+  }
+
+  auto res = realloc(ptr, nsize);
+  if(res && counter)
+  {
+    counter->deallocate(oldSize);
+    counter->allocate(nsize);
+  }
+  return res;
+}
+
 }
 
 //------------------------------------------------------------------------
 // LuaState::LuaState
 //------------------------------------------------------------------------
-LuaState::LuaState() : L{luaL_newstate()}
+LuaState::LuaState(std::shared_ptr<MemoryCounter> iHeapCounter) :
+  fHeapCounter{std::move(iHeapCounter)},
+  L{lua_newstate(impl::lua_counting_alloc, fHeapCounter.get())}
 {
   lua_atpanic(L, impl::lua_panic);
   luaL_openlibs(L);
@@ -33,6 +33,7 @@ extern "C" {
 #include "../fs.h"
 #include "../fmt.h"
 #include "../Errors.h"
+#include "../MemoryAccounting.h"
 
 namespace re::mock::lua {
 
@@ -75,7 +76,8 @@ struct LuaException : public re::mock::Exception {
 class LuaState
 {
 public:
-  LuaState();
+  //! The lua heap is reported to `iHeapCounter` (if provided)
+  explicit LuaState(std::shared_ptr<MemoryCounter> iHeapCounter = {});
   ~LuaState();
 
   int runLuaFile(fs::path const &iFilename);
@@ -125,6 +127,7 @@ public:
   static void dumpStack(lua_State *L, char const *iMessage = nullptr, std::ostream &oStream = std::cout);
 
 private:
+  std::shared_ptr<MemoryCounter> fHeapCounter; // must outlive L
   lua_State *L{}; // using common naming in all lua apis...
 };
 
@@ -28,7 +28,7 @@ char MockJBox::REGISTRY_KEY = 'K';
 //------------------------------------------------------------------------
 // MockJBox::MockJBox
 //------------------------------------------------------------------------
-MockJBox::MockJBox()
+MockJBox::MockJBox(std::shared_ptr<MemoryCounter> iHeapCounter) : L{std::move(iHeapCounter)}
 {
   lua_pushlightuserdata(L, static_cast<void *>(&REGISTRY_KEY));
   lua_pushlightuserdata(L, static_cast<void *>(this));
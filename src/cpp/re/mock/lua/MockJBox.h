@@ -33,7 +33,8 @@ class MockJBox
 public:
   using lua_table_key_t = std::variant<std::string, int>;
 public:
-  MockJBox();
+  //! The lua heap is reported to `iHeapCounter` (if provided)
+  explicit MockJBox(std::shared_ptr<MemoryCounter> iHeapCounter = {});
 
   virtual ~MockJBox() = default;
 
@@ -120,7 +120,7 @@ struct JBoxObjectUD
 //------------------------------------------------------------------------
 // MotherboardDef::MotherboardDef
 //------------------------------------------------------------------------
-MotherboardDef::MotherboardDef()
+MotherboardDef::MotherboardDef(std::shared_ptr<MemoryCounter> iHeapCounter) : MockJBox(std::move(iHeapCounter))
 {
   static const struct luaL_Reg jboxLib[] = {
     {"add_cv_routing_target",              lua_ignored},
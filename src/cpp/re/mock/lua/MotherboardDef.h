@@ -258,7 +258,7 @@ struct JboxPropertySet {
 class MotherboardDef : public MockJBox
 {
 public:
-  MotherboardDef();
+  explicit MotherboardDef(std::shared_ptr<MemoryCounter> iHeapCounter = {});
 
   int luaIgnored();
   int luaNativeObject();
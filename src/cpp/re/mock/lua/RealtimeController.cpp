@@ -114,7 +114,7 @@ namespace re::mock::lua {
 //------------------------------------------------------------------------
 // RealtimeController::RealtimeController
 //------------------------------------------------------------------------
-RealtimeController::RealtimeController()
+RealtimeController::RealtimeController(std::shared_ptr<MemoryCounter> iHeapCounter) : MockJBox(std::move(iHeapCounter))
 {
   static const struct luaL_Reg jboxLib[] = {
     {"get_blob_info",            lua_get_blob_info},
@@ -34,7 +34,7 @@ namespace re::mock::lua {
 class RealtimeController: public MockJBox
 {
 public:
-  RealtimeController();
+  explicit RealtimeController(std::shared_ptr<MemoryCounter> iHeapCounter = {});
 
   int luaTrace();
 
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "RenderJobsLua.h"
+
+namespace re::mock::lua {
+
+//------------------------------------------------------------------------
+// RenderJobsLua::fromFile
+//------------------------------------------------------------------------
+std::unique_ptr<RenderJobsLua> RenderJobsLua::fromFile(fs::path const &iLuaFilename)
+{
+  auto res = std::make_unique<RenderJobsLua>();
+  res->loadFile(iLuaFilename);
+  return res;
+}
+
+//------------------------------------------------------------------------
+// RenderJobsLua::fromString
+//------------------------------------------------------------------------
+std::unique_ptr<RenderJobsLua> RenderJobsLua::fromString(std::string const &iLuaCode)
+{
+  auto res = std::make_unique<RenderJobsLua>();
+  res->loadString(iLuaCode);
+  return res;
+}
+
+//------------------------------------------------------------------------
+// RenderJobsLua::jobs
+//------------------------------------------------------------------------
+std::vector<render_job> RenderJobsLua::jobs()
+{
+  std::vector<render_job> res{};
+  if(lua_getglobal(L, "jobs") != LUA_TNIL)
+  {
+    luaL_checktype(L, -1, LUA_TTABLE);
+    auto count = static_cast<size_t>(L.getTableSize());
+    for(size_t i = 1; i <= count; i++)
+    {
+      lua_geti(L, -1, i);
+      RE_MOCK_ASSERT(lua_type(L, -1) == LUA_TTABLE, "jobs[%ld] is not a table", i);
+      render_job job{};
+      job.fName = L.getTableValueAsOptionalString("name");
+      job.fPatch = L.getTableValueAsOptionalString("patch");
+      job.fMidi = L.getTableValueAsOptionalString("midi");
+      job.fInput = L.getTableValueAsOptionalString("input");
+      auto output = L.getTableValueAsOptionalString("output");
+      RE_MOCK_ASSERT(output.has_value(), "jobs[%ld] is missing output", i);
+      job.fOutput = *output;
+      job.fDurationMilliseconds = L.getTableValueAsOptionalNumber("duration_ms");
+      job.fSampleRate = L.getTableValueAsOptionalInteger<int>("sample_rate");
+      job.fMainIn = getTableValueAsStrings("main_in");
+      job.fMainOut = getTableValueAsStrings("main_out");
+      res.emplace_back(std::move(job));
+      lua_pop(L, 1);
+    }
+  }
+  lua_pop(L, 1);
+  return res;
+}
+
+//------------------------------------------------------------------------
+// RenderJobsLua::getTableValueAsStrings
+//------------------------------------------------------------------------
+std::vector<std::string> RenderJobsLua::getTableValueAsStrings(char const *iKey)
+{
+  std::vector<std::string> res{};
+  if(lua_getfield(L, -1, iKey) != LUA_TNIL)
+  {
+    luaL_checktype(L, -1, LUA_TTABLE);
+    auto count = static_cast<size_t>(L.getTableSize());
+    for(size_t i = 1; i <= count; i++)
+    {
+      lua_geti(L, -1, i);
+      auto s = lua_tostring(L, -1);
+      if(s != nullptr)
+        res.emplace_back(s);
+      lua_pop(L, 1);
+    }
+  }
+  lua_pop(L, 1);
+  return res;
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_lua_render_jobs_lua_h__
+#define __Pongasoft_re_mock_lua_render_jobs_lua_h__
+
+#include "MockJBox.h"
+#include <vector>
+#include <optional>
+
+namespace re::mock::lua {
+
+/*
+jobs = {
+  {
+    name = "plain",                   -- optional (defaults to the name of the output file)
+    patch = "patches/Plain.repatch",  -- optional
+    midi = "midi/song.mid",           -- optional (all tracks are imported, including the tempo)
+    input = "audio/drums.wav",        -- optional (effects only)
+    output = "out/plain.wav",
+    duration_ms = 5000,               -- instrument: length of the bounce / effect: tail after the input
+    sample_rate = 48000,              -- optional (defaults to 44100)
+    main_in = { "InL", "InR" },       -- optional (defaults to { "MainInLeft", "MainInRight" })
+    main_out = { "OutL", "OutR" },    -- optional (defaults to { "MainOutLeft", "MainOutRight" })
+  },
+}
+*/
+
+struct render_job
+{
+  std::optional<std::string> fName{};
+  std::optional<std::string> fPatch{};
+  std::optional<std::string> fMidi{};
+  std::optional<std::string> fInput{};
+  std::string fOutput{};
+  std::optional<lua_Number> fDurationMilliseconds{};
+  std::optional<int> fSampleRate{};
+  std::vector<std::string> fMainIn{};
+  std::vector<std::string> fMainOut{};
+};
+
+class RenderJobsLua : public MockJBox
+{
+public:
+  std::vector<render_job> jobs();
+
+protected:
+  std::vector<std::string> getTableValueAsStrings(char const *iKey);
+
+public:
+  static std::unique_ptr<RenderJobsLua> fromFile(fs::path const &iLuaFilename);
+  static std::unique_ptr<RenderJobsLua> fromString(std::string const &iLuaCode);
+};
+
+}
+
+#endif //__Pongasoft_re_mock_lua_render_jobs_lua_h__
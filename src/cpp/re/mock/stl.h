@@ -27,6 +27,10 @@
 #include <string>
 #include <variant>
 #include <optional>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
 
 namespace re::mock::stl {
 
@@ -176,6 +180,51 @@ constexpr std::optional<T> optional_static_cast(std::optional<U> const &v) {
     return std::nullopt;
 }
 
+/**
+ * Calls `iFunction(i)` for every `i` in `[0, iCount)` using (up to) `iThreadCount` threads, the current thread
+ * included (`0` means one thread per core). Each thread picks the next index until there are none left, so the
+ * order in which indices are processed is not deterministic: `iFunction` must only touch state owned by index `i`.
+ *
+ * If `iFunction` throws, the remaining indices are still processed and the first exception (in index order) is
+ * rethrown once all threads are done. */
+template<typename Function>
+void parallel_for(size_t iCount, unsigned int iThreadCount, Function &&iFunction)
+{
+  std::vector<std::exception_ptr> errors(iCount);
+
+  std::atomic<size_t> next{0};
+  auto worker = [iCount, &iFunction, &errors, &next]() {
+    for(auto i = next++; i < iCount; i = next++)
+    {
+      try
+      {
+        iFunction(i);
+      }
+      catch(...)
+      {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+
+  if(iThreadCount == 0)
+    iThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  iThreadCount = static_cast<unsigned int>(std::min<size_t>(iThreadCount, std::max<size_t>(iCount, 1)));
+
+  std::vector<std::thread> threads{};
+  for(unsigned int i = 1; i < iThreadCount; i++)
+    threads.emplace_back(worker);
+  worker(); // current thread participates as well
+  for(auto &t: threads)
+    t.join();
+
+  for(auto const &error: errors)
+  {
+    if(error)
+      std::rethrow_exception(error);
+  }
+}
+
 /**
  * An action that gets executed when the destructor of this class runs */
 template<typename F>
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include <re/mock/Render.h>
+#include <re/mock/fmt.h>
+#include <Jukebox.h>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+/**
+ * Command line tool which renders (bounces) the output of a device for each job described in one or more job files
+ * (see `re::mock::lua::RenderJobsLua` for the syntax).
+ *
+ * The device is loaded from a shared library which exports the Jukebox entry points (`JBox_Export_CreateNativeObject`
+ * and `JBox_Export_RenderRealtime`) and resolves the Jukebox api against this executable.
+ *
+ * @note The Jukebox api does not provide an entry point to destroy the native objects, so they are never deleted */
+
+using namespace re::mock;
+
+namespace {
+
+using create_native_object_fn = decltype(&JBox_Export_CreateNativeObject);
+using render_realtime_fn = decltype(&JBox_Export_RenderRealtime);
+
+//------------------------------------------------------------------------
+// usage
+//------------------------------------------------------------------------
+int usage(char const *iProgram)
+{
+  std::cerr << fmt::printf("Usage: %s [-j <threads>] <device_library> <device_root_dir> <job_file>...\n", iProgram);
+  std::cerr << "  -j <threads>     number of jobs rendered in parallel (default: one per core)\n";
+  std::cerr << "  device_library   shared library exporting JBox_Export_CreateNativeObject/JBox_Export_RenderRealtime\n";
+  std::cerr << "  device_root_dir  folder containing info.lua, motherboard_def.lua and realtime_controller.lua\n";
+  return 1;
+}
+
+#ifdef _WIN32
+using library_t = HMODULE;
+#else
+using library_t = void *;
+#endif
+
+//------------------------------------------------------------------------
+// loadLibrary
+//------------------------------------------------------------------------
+library_t loadLibrary(std::string const &iLibrary)
+{
+#ifdef _WIN32
+  auto res = LoadLibraryA(iLibrary.c_str());
+  RE_MOCK_ASSERT(res != nullptr, "Cannot load [%s]", iLibrary);
+#else
+  auto res = dlopen(iLibrary.c_str(), RTLD_NOW | RTLD_LOCAL);
+  RE_MOCK_ASSERT(res != nullptr, "Cannot load [%s] (%s)", iLibrary, dlerror());
+#endif
+  return res;
+}
+
+//------------------------------------------------------------------------
+// loadSymbol
+//------------------------------------------------------------------------
+template<typename F>
+F loadSymbol(library_t iLibrary, char const *iSymbol)
+{
+#ifdef _WIN32
+  auto res = reinterpret_cast<void *>(GetProcAddress(iLibrary, iSymbol));
+#else
+  auto res = dlsym(iLibrary, iSymbol);
+#endif
+  RE_MOCK_ASSERT(res != nullptr, "Symbol [%s] not found in device library", iSymbol);
+  return reinterpret_cast<F>(res);
+}
+
+//------------------------------------------------------------------------
+// loadDeviceConfig
+//------------------------------------------------------------------------
+Config loadDeviceConfig(std::string const &iLibrary, fs::path const &iDeviceRootDir)
+{
+  auto library = loadLibrary(iLibrary); // never unloaded (the native objects are never deleted)
+  auto createNativeObject = loadSymbol<create_native_object_fn>(library, "JBox_Export_CreateNativeObject");
+  auto renderRealtime = loadSymbol<render_realtime_fn>(library, "JBox_Export_RenderRealtime");
+
+  return Config(Info::from_file(iDeviceRootDir / "info.lua"))
+    .device_root_dir(iDeviceRootDir)
+    .device_resources_dir(iDeviceRootDir / "Resources")
+    .mdef_file(iDeviceRootDir / "motherboard_def.lua")
+    .rtc_file(iDeviceRootDir / "realtime_controller.lua")
+    .rt([createNativeObject, renderRealtime](Realtime &rt) {
+      rt.create_native_object = createNativeObject;
+      rt.render_realtime = renderRealtime;
+    });
+}
+
+}
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  unsigned int threadCount = 0;
+  std::vector<std::string> args{};
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg{argv[i]};
+    if(arg == "-j" && i + 1 < argc)
+      threadCount = static_cast<unsigned int>(std::stoul(argv[++i]));
+    else if(arg == "-h" || arg == "--help")
+      return usage(argv[0]);
+    else
+      args.emplace_back(arg);
+  }
+
+  if(args.size() < 3)
+    return usage(argv[0]);
+
+  try
+  {
+    auto config = loadDeviceConfig(args[0], fs::u8path(args[1]));
+
+    std::vector<render::Job> jobs{};
+    for(size_t i = 2; i < args.size(); i++)
+    {
+      auto fileJobs = render::Job::fromFile(fs::u8path(args[i]));
+      jobs.insert(jobs.end(), fileJobs.begin(), fileJobs.end());
+    }
+
+    auto results = render::run(config, jobs, threadCount);
+
+    int errorCount = 0;
+    for(auto const &result: results)
+    {
+      if(result.fError)
+      {
+        errorCount++;
+        std::cout << fmt::printf("%-30s ERROR %s\n", result.fName, *result.fError);
+      }
+      else
+      {
+        std::cout << fmt::printf("%-30s %10lld frames %10.2fms %8.2fx realtime\n",
+                                 result.fName,
+                                 static_cast<long long>(result.fFrameCount),
+                                 std::chrono::duration<double, std::milli>(result.fElapsedTime).count(),
+                                 result.getRealTimeFactor());
+      }
+    }
+    return errorCount == 0 ? 0 : 2;
+  }
+  catch(std::exception &e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
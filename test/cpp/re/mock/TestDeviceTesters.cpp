@@ -222,6 +222,41 @@ TEST(InstrumentTester, TimelineUsage)
     ;
 }
 
+// InstrumentTester.PreRoll
+TEST(InstrumentTester, PreRoll)
+{
+  // the MAUSrc configuration defines it as a helper, so we need to redefine it as an instrument
+  auto config = DeviceConfig<MAUSrc>::fromSkeleton(DeviceType::kInstrument).mdef(Config::stereo_audio_out());
+
+  InstrumentTester<MAUSrc> tester(config);
+
+  tester.wireMainOut(MAUSrc::LEFT_SOCKET, MAUSrc::RIGHT_SOCKET);
+
+  ASSERT_TRUE(tester.dst().isObserver());
+  ASSERT_FALSE(tester.device().isObserver());
+
+  tester.device()->fBuffer = MockAudioDevice::buffer(3.0, 4.0);
+
+  auto stats = tester.preRoll(rack::Duration{10});
+
+  ASSERT_EQ(10, stats.fBatchCount);
+  ASSERT_EQ(10, tester.rack().getBatchCount());
+  ASSERT_GE(stats.getBatchesPerSecond(), 0);
+  ASSERT_FALSE(tester.rack().isPreRolling());
+  ASSERT_GT(tester.rack().getTransportPlayPos(), 0);
+
+  // the device was rendered...
+  ASSERT_EQ(MockAudioDevice::buffer(3.0, 4.0),
+            MockAudioDevice::buffer(tester.device().getDSPBuffer(std::string("/audio_outputs/") + MAUSrc::LEFT_SOCKET),
+                                    tester.device().getDSPBuffer(std::string("/audio_outputs/") + MAUSrc::RIGHT_SOCKET)));
+
+  // ... but nothing was captured
+  ASSERT_EQ(MockAudioDevice::buffer(0, 0), tester.dst()->fBuffer);
+
+  // back to normal
+  ASSERT_EQ(MockAudioDevice::buffer(3.0, 4.0), tester.nextBatch({}));
+}
+
 // NotePlayerTester.Usage
 TEST(NotePlayerTester, Usage)
 {
@@ -365,6 +400,21 @@ TEST(HelperTester, Usage)
   ASSERT_FALSE(tester.device().getBool("/cv_outputs/cvo/connected"));
 }
 
+// Timeline.MemoryReport
+TEST(Timeline, MemoryReport)
+{
+  auto tester = HelperTester<MAUDst>(MAUDst::CONFIG);
+
+  ASSERT_EQ(0, tester.device().memoryReport()[MemoryReport::Subsystem::kTimelineEvents].fBytes);
+
+  {
+    auto timeline = tester.newTimeline().event([]() {}).after1Batch().event([]() {});
+    ASSERT_GT(tester.device().memoryReport()[MemoryReport::Subsystem::kTimelineEvents].fBytes, 0);
+  }
+
+  ASSERT_EQ(0, tester.device().memoryReport()[MemoryReport::Subsystem::kTimelineEvents].fBytes);
+}
+
 // Timeline.Usage
 TEST(Timeline, Usage)
 {
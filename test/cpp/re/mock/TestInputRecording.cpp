@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include <re/mock/Rack.h>
+#include <re/mock/MockDevices.h>
+#include <re/mock/fs.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+
+namespace re::mock::Test {
+
+using namespace mock;
+
+namespace {
+
+// Logs everything the device receives (diffs, audio input, transport position)
+struct InputLogger : public MockDevice
+{
+  explicit InputLogger(int iSampleRate) :
+    MockDevice(iSampleRate),
+    fInLeft{JBox_GetMotherboardObjectRef("/audio_inputs/L")},
+    fTransport{JBox_GetMotherboardObjectRef("/transport")}
+  {}
+
+  void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+  {
+    for(TJBox_UInt32 i = 0; i < iDiffCount; i++)
+    {
+      auto const &diff = iPropertyDiffs[i];
+      auto value = JBox_GetType(diff.fCurrentValue) == kJBox_Number ? JBox_GetNumber(diff.fCurrentValue) : -1.0;
+      fLog.emplace_back(fmt::printf("diff %d/%d=%f@%d", diff.fPropertyRef.fObject, diff.fPropertyTag, value, diff.fAtFrameIndex));
+    }
+
+    TJBox_AudioSample samples[constants::kBatchSize];
+    JBox_GetDSPBufferData(JBox_LoadMOMPropertyByTag(fInLeft, kJBox_AudioInputBuffer), 0, constants::kBatchSize, samples);
+    auto sum = std::accumulate(std::begin(samples), std::end(samples), 0.0);
+    fLog.emplace_back(fmt::printf("audio %f, play_pos %f", sum, JBox_LoadMOMPropertyAsNumber(fTransport, kJBox_TransportPlayPos)));
+  }
+
+  TJBox_ObjectRef fInLeft;
+  TJBox_ObjectRef fTransport;
+  std::vector<std::string> fLog{};
+};
+
+}
+
+// InputRecording.RecordReplay
+TEST(InputRecording, RecordReplay)
+{
+  auto recordingFile = (fs::temp_directory_path() / "re-mock-InputRecording.remi").string();
+
+  auto config = DeviceConfig<InputLogger>::fromSkeleton(DeviceType::kInstrument)
+    .accept_notes(true)
+    .mdef(Config::stereo_audio_in())
+    .mdef(Config::cv_in())
+    .mdef(Config::document_owner_property("gain", lua::jbox_number_property{}.default_value(0.5)))
+    .rtc(Config::rt_input_setup_notify("/custom_properties/gain"))
+    .rtc(Config::rt_input_setup_notify("/cv_inputs/C/value"))
+    .rtc(Config::rt_input_setup_notify("/note_states/*"));
+
+  // original rack: the device is fed by an audio source and a cv source
+  std::vector<std::string> originalLog{};
+  {
+    Rack rack{};
+    auto src = rack.newDevice(MAUSrc::CONFIG);
+    auto cv = rack.newDevice(MCVSrc::CONFIG);
+    auto re = rack.newDevice(config);
+    rack.wire(src.getStereoAudioOutSocket(MAUSrc::LEFT_SOCKET, MAUSrc::RIGHT_SOCKET),
+              re.getStereoAudioInSocket(Config::LEFT_SOCKET, Config::RIGHT_SOCKET));
+    rack.wire(cv.getCVOutSocket(MCVSrc::SOCKET), re.getCVInSocket(Config::SOCKET));
+
+    re.startInputRecording(recordingFile);
+    rack.transportStart();
+
+    for(int i = 0; i < 10; i++)
+    {
+      src->fBuffer.fill(static_cast<TJBox_AudioSample>(i), 0);
+      cv->fValue = i / 2;
+      if(i == 3)
+        re.setNum("/custom_properties/gain", 0.8);
+      if(i == 5)
+        re.setNoteInEvent(64, 100, 12);
+      if(i == 7)
+        re.setNoteInEvent(64, 0, 3);
+      rack.nextBatch();
+    }
+
+    ASSERT_EQ(10, re.stopInputRecording());
+    originalLog = re->fLog;
+    ASSERT_GT(originalLog.size(), 10); // 1 audio line per batch + diffs
+  }
+
+  auto recording = InputRecording::load(recordingFile);
+  ASSERT_EQ(10, recording->getBatchCount());
+
+  // replay in a rack containing only the device
+  {
+    Rack rack{};
+    auto re = rack.newDevice(config);
+    ASSERT_EQ(10, re.replayInputs(*recording));
+    ASSERT_EQ(originalLog, re->fLog);
+    ASSERT_FLOAT_EQ(0.8, re.getNum("/custom_properties/gain"));
+  }
+
+  // recording started after the device has been used: its state is replayed first
+  {
+    Rack rack{};
+    auto re = rack.newDevice(config);
+    re.setNum("/custom_properties/gain", 0.2);
+    rack.nextBatch();
+    auto logSize = re->fLog.size();
+    re.startInputRecording(recordingFile);
+    rack.nextBatch();
+    ASSERT_EQ(1, re.stopInputRecording());
+    std::vector<std::string> recordedLog(re->fLog.begin() + static_cast<long>(logSize), re->fLog.end());
+
+    Rack replayRack{};
+    auto replay = replayRack.newDevice(config);
+    ASSERT_EQ(1, replay.replayInputs(recordingFile));
+    ASSERT_FLOAT_EQ(0.2, replay.getNum("/custom_properties/gain"));
+
+    // the recorded device received the state before the recording, the fresh one on the first replayed batch
+    auto hasGainDiff = [](std::vector<std::string> const &iLog) {
+      return std::any_of(iLog.begin(), iLog.end(), [](auto const &l) { return l.find("=0.200000@") != std::string::npos; });
+    };
+    ASSERT_FALSE(hasGainDiff(recordedLog));
+    ASSERT_TRUE(hasGainDiff(replay->fLog));
+  }
+
+  ASSERT_THROW(InputRecording::load((fs::temp_directory_path() / "re-mock-does-not-exist.remi").string()), Exception);
+
+  fs::remove(recordingFile);
+}
+
+}
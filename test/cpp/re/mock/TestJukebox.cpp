@@ -304,6 +304,18 @@ TEST(Jukebox, AudioSocket)
       ASSERT_TRUE(std::all_of(o1.begin() + 20, o1.end(), [](auto s) { return s == 100; }));
     }
   });
+
+  // a DSP buffer value is only valid for the duration of the batch
+  TJBox_Value output1Dsp{};
+  re.withJukebox([&output1Dsp](auto &motherboard) {
+    output1Dsp = JBox_LoadMOMPropertyByTag(JBox_GetMotherboardObjectRef("/audio_outputs/output_1"), kJBox_AudioOutputBuffer);
+  });
+  rack.nextBatch();
+  re.withJukebox([&output1Dsp](auto &motherboard) {
+    Motherboard::DSPBuffer buffer{};
+    ASSERT_THROW(JBox_GetDSPBufferData(output1Dsp, 0, DSP_BUFFER_SIZE, buffer.data()), Exception);
+    ASSERT_THROW(JBox_GetDSPBufferInfo(output1Dsp), Exception);
+  });
 }
 
 }
\ No newline at end of file
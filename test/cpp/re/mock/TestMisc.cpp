@@ -18,6 +18,7 @@
 
 #include <re/mock/DeviceTesters.h>
 #include <gtest/gtest.h>
+#include <sstream>
 
 namespace re::mock::Test {
 
@@ -101,4 +102,195 @@ TEST(Misc, RequestReset)
 
 }
 
-}
\ No newline at end of file
+// Misc.Trace
+TEST(Misc, Trace)
+{
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      fBatchCount++;
+      JBox_Trace("Device.cpp", 10, "render");
+      TJBox_Value values[] = { JBox_MakeNumber(fBatchCount), JBox_MakeBoolean(true) };
+      JBox_TraceValues("Device.cpp", 11, "batch=^0/^1", values, 2);
+    }
+
+    int fBatchCount{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton().trace_buffer_size(5);
+
+  auto tester = HelperTester<Device>(c);
+
+  tester.rack().setTraceAutoFlush(false);
+
+  tester.nextBatch();
+  tester.nextBatch();
+
+  std::ostringstream out{};
+  tester.flushTraces(out);
+  ASSERT_EQ("Device.cpp:10 | render\n"
+            "Device.cpp:11 | batch=1.000000/true\n"
+            "Device.cpp:10 | render\n"
+            "Device.cpp:11 | batch=2.000000/true\n", out.str());
+
+  // nothing left to flush
+  out.str("");
+  tester.flushTraces(out);
+  ASSERT_EQ("", out.str());
+
+  // overflow => 6 traces for a buffer of 5
+  tester.nextBatch();
+  tester.nextBatch();
+  tester.nextBatch();
+  out.str("");
+  tester.flushTraces(out);
+  ASSERT_EQ("Device.cpp:10 | render\n"
+            "Device.cpp:11 | batch=3.000000/true\n"
+            "Device.cpp:10 | render\n"
+            "Device.cpp:11 | batch=4.000000/true\n"
+            "Device.cpp:10 | render\n"
+            " | 1 trace(s) dropped (trace buffer size is 5)\n", out.str());
+
+  auto stats = tester.device().withJukebox<TraceRing::Stats>([](Motherboard &m) { return m.getTraceStats(); });
+  ASSERT_EQ(9, stats.fRecordedCount);
+  ASSERT_EQ(1, stats.fDroppedCount);
+  ASSERT_EQ(0, stats.fSpilledCount);
+
+  // long file / template => stored out of line (not truncated, placeholders preserved)
+  {
+    std::string longFile = "src/" + std::string(100, 'd') + "/Device.cpp";
+    std::string longTemplate = std::string(250, '-') + " ^0";
+    TraceRing ring{2};
+    TJBox_Value values[1]{}; // formatted by the lambda below
+    ASSERT_TRUE(ring.traceValues(longFile.c_str(), 12, longTemplate.c_str(), values, 1));
+    ASSERT_TRUE(ring.trace("Device.cpp", 13, "short"));
+    std::vector<std::string> traces{};
+    ring.drain([](TJBox_Value const &) { return std::string("3"); },
+               [&traces](std::string_view iFile, TJBox_Int32 iLine, std::string_view iMessage) {
+                 traces.emplace_back(fmt::printf("%s:%d | %s", std::string(iFile), iLine, std::string(iMessage)));
+               });
+    ASSERT_EQ(2, traces.size());
+    ASSERT_EQ(fmt::printf("%s:12 | %s 3", longFile, std::string(250, '-')), traces[0]);
+    ASSERT_EQ("Device.cpp:13 | short", traces[1]);
+    ASSERT_EQ(1, ring.getSpilledCount());
+    ASSERT_EQ(0, ring.getDroppedCount());
+  }
+
+  // disabled trace => nothing recorded
+  auto tester2 = HelperTester<Device>(DeviceConfig<Device>::fromSkeleton().disable_trace());
+  tester2.rack().setTraceAutoFlush(false);
+  tester2.nextBatch();
+  out.str("");
+  tester2.flushTraces(out);
+  ASSERT_EQ("", out.str());
+}
+
+// Misc.JboxProfiler
+TEST(Misc, JboxProfiler)
+{
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      auto customProperties = JBox_GetMotherboardObjectRef("/custom_properties");
+      JBox_LoadMOMPropertyByTag(customProperties, 100);
+      JBox_LoadMOMPropertyByTag(customProperties, 100);
+      JBox_StoreMOMPropertyAsNumber(customProperties, 100, 3.0);
+    }
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::document_owner_property("prop", lua::jbox_number_property{}.property_tag(100)));
+
+  auto tester = HelperTester<Device>(c);
+
+  // disabled by default
+  tester.nextBatch();
+  ASSERT_EQ(0, tester.device().getJboxProfilerSnapshot().fBatchCount);
+
+  tester.device().enableJboxProfiler();
+  tester.nextBatch();
+  tester.nextBatch();
+
+  using Function = JboxProfiler::Function;
+
+  auto snapshot = tester.device().getJboxProfilerSnapshot();
+  ASSERT_EQ(2, snapshot.fBatchCount);
+  ASSERT_EQ(2, snapshot.get(Function::kGetMotherboardObjectRef).fCallCount);
+  ASSERT_EQ(4, snapshot.get(Function::kLoadMOMPropertyByTag).fCallCount);
+  ASSERT_EQ(2, snapshot.get(Function::kStoreMOMPropertyAsNumber).fCallCount);
+  ASSERT_EQ(0, snapshot.get(Function::kStoreMOMPropertyByTag).fCallCount); // no double counting
+  ASSERT_EQ(0, snapshot.get(Function::kGetSampleData).fCallCount);
+
+  auto report = snapshot.toString();
+  ASSERT_NE(std::string::npos, report.find("JBox_LoadMOMPropertyByTag"));
+  ASSERT_EQ(std::string::npos, report.find("JBox_GetSampleData"));
+
+  tester.device().resetJboxProfiler();
+  tester.nextBatch();
+  snapshot = tester.device().getJboxProfilerSnapshot();
+  ASSERT_EQ(1, snapshot.fBatchCount);
+  ASSERT_EQ(2, snapshot.get(Function::kLoadMOMPropertyByTag).fCallCount);
+
+  tester.device().disableJboxProfiler();
+  tester.nextBatch();
+  ASSERT_EQ(0, tester.device().getJboxProfilerSnapshot().get(Function::kLoadMOMPropertyByTag).fCallCount);
+}
+
+// Misc.JboxProfilerByteCount
+TEST(Misc, JboxProfilerByteCount)
+{
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      auto value = JBox_LoadMOMProperty(JBox_MakePropertyRef(JBox_GetMotherboardObjectRef("/custom_properties"), "prop_sample"));
+      TJBox_AudioSample data[6];
+      JBox_GetSampleData(value, 0, 3, data); // 3 stereo frames
+    }
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::rtc_owner_property("prop_sample", lua::jbox_sample_property{}.default_value("/Private/sample.data")))
+    .sample_data("/Private/sample.data", resource::Sample{}.sample_rate(44100).channels(2).data({0, 1, 2, 3, 4, 5}));
+
+  auto tester = HelperTester<Device>(c);
+
+  tester.device().enableJboxProfiler();
+  tester.nextBatch();
+
+  auto stats = tester.device().getJboxProfilerSnapshot().get(JboxProfiler::Function::kGetSampleData);
+  ASSERT_EQ(1, stats.fCallCount);
+  ASSERT_EQ(6 * sizeof(TJBox_AudioSample), stats.fByteCount);
+}
+
+// Misc.AlignedStorage
+TEST(Misc, AlignedStorage)
+{
+  static_assert(alignof(impl::AlignedDSPBuffer) == kAudioAlignment);
+  ASSERT_EQ(0, kAudioAlignment % JBox_GetOptimalFFTAlignment());
+
+  SampleData data{};
+  for(int i = 0; i < 1000; i++)
+  {
+    data.emplace_back(static_cast<TJBox_AudioSample>(i));
+    ASSERT_TRUE(is_aligned(data.data()));
+  }
+
+  // can be compared with a regular vector
+  ASSERT_EQ(std::vector<TJBox_AudioSample>({0, 1, 2}), SampleData({0, 1, 2}));
+  ASSERT_NE(SampleData({0, 1, 2}), std::vector<TJBox_AudioSample>({0, 1}));
+
+  auto sample = MockAudioDevice::Sample{}.stereo().data({1, 2, 3, 4});
+  ASSERT_TRUE(is_aligned(sample.getData().data()));
+  ASSERT_TRUE(is_aligned(sample.clone().getData().data()));
+}
+
+}
@@ -68,6 +68,7 @@ TEST(MockDevices, Sample)
   ASSERT_EQ(3, sub.getFrameCount());
   ASSERT_EQ(6, sub.getSampleCount());
   ASSERT_EQ(std::vector<TJBox_AudioSample>({2, 3, 4, 5, 6, 7}), sub.getData());
+  ASSERT_EQ(std::vector<TJBox_AudioSample>({2, 3, 4, 5, 6, 7}), sub.getDataAsVector());
 
   sub.applyGain(2.0);
   ASSERT_EQ(44100, sub.getSampleRate());
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include <re/mock/ObjectManager.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace re::mock::Test {
+
+using namespace mock;
+
+// SlotObjectManager.Usage
+TEST(SlotObjectManager, Usage)
+{
+  SlotObjectManager<std::string> om{};
+
+  // same keys as ObjectManager when nothing is removed
+  ASSERT_EQ(1, om.add("a"));
+  ASSERT_EQ(2, om.add([](int id) { return std::to_string(id); }));
+  ASSERT_EQ(3, om.add("c"));
+  ASSERT_EQ(3, om.size());
+
+  ASSERT_EQ("a", om.get(1));
+  ASSERT_EQ("2", om.get(2));
+  ASSERT_THROW(om.get(4), Exception);
+  ASSERT_THROW(om.get(0), Exception);
+
+  // removal preserves insertion order
+  om.remove(2);
+  ASSERT_EQ(2, om.size());
+  ASSERT_FALSE(om.contains(2));
+  ASSERT_THROW(om.get(2), Exception);
+
+  // slot is reused with a new generation => stale key is detected
+  auto d = om.add("d");
+  ASSERT_NE(2, d);
+  ASSERT_EQ(2, d & SlotObjectManager<std::string>::kIndexMask);
+  ASSERT_THROW(om.get(2), Exception);
+  ASSERT_EQ("d", om.get(d));
+
+  std::vector<std::string> values{};
+  for(auto const &[id, o]: om)
+    values.emplace_back(o);
+  ASSERT_EQ(std::vector<std::string>({"a", "c", "d"}), values);
+
+  om.replace(3, "C");
+  ASSERT_EQ("C", om.get(3));
+  ASSERT_THROW(om.replace(2, "x"), Exception);
+
+  // failing factory does not leak the slot
+  ASSERT_THROW(om.add([](int id) -> std::string { throw std::runtime_error("failed"); }), std::runtime_error);
+  ASSERT_EQ(3, om.size());
+
+  om.clear();
+  ASSERT_EQ(0, om.size());
+  ASSERT_FALSE(om.contains(1));
+  ASSERT_NE(1, om.add("e"));
+
+  om.reset();
+  ASSERT_EQ(1, om.add("f"));
+}
+
+}
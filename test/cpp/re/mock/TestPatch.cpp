@@ -335,4 +335,212 @@ TEST(Patch, Load)
   }
 }
 
-}
\ No newline at end of file
+// Patch.Cache
+TEST(Patch, Cache)
+{
+  PatchParser::clearCache();
+
+  auto patchesDir = fs::path(RE_MOCK_PROJECT_DIR) / "test" / "resources" / "re" / "mock" / "patches";
+
+  auto res = PatchParser::loadDirectory(patchesDir, 2);
+  ASSERT_EQ(2, res.fPatches.size());
+  ASSERT_TRUE(res.fErrors.empty());
+
+  auto stats = PatchParser::getCacheStats();
+  ASSERT_EQ(2, stats.fSize);
+  ASSERT_EQ(0, stats.fHitCount);
+  ASSERT_EQ(2, stats.fMissCount);
+
+  // same (immutable) instance returned => no parsing
+  auto test0 = resource::File{patchesDir / "Kooza_test0.repatch"};
+  auto patch = PatchParser::fromCache(test0);
+  ASSERT_EQ(res.fPatches[fs::canonical(test0.fFilePath)], patch);
+  ASSERT_EQ(PatchParser::from(test0)->fProperties.size(), patch->fProperties.size());
+  ASSERT_EQ(1, PatchParser::getCacheStats().fHitCount);
+
+  // capacity reached => the least recently used patch is evicted
+  ASSERT_EQ(PatchParser::kDefaultCacheCapacity, PatchParser::getCacheCapacity());
+  PatchParser::setCacheCapacity(1);
+  stats = PatchParser::getCacheStats();
+  ASSERT_EQ(1, stats.fSize);
+  ASSERT_EQ(1, stats.fEvictionCount);
+  ASSERT_EQ(patch, PatchParser::fromCache(test0)); // test0 was the most recently used
+  ASSERT_EQ(2, PatchParser::getCacheStats().fHitCount);
+  auto other = std::find_if(res.fPatches.begin(), res.fPatches.end(), [&test0](auto const &p) { return p.first != fs::canonical(test0.fFilePath); });
+  ASSERT_NE(other->second, PatchParser::fromCache(resource::File{other->first})); // evicted => parsed again
+  stats = PatchParser::getCacheStats();
+  ASSERT_EQ(1, stats.fSize);
+  ASSERT_EQ(2, stats.fEvictionCount);
+  ASSERT_EQ(3, stats.fMissCount);
+  PatchParser::setCacheCapacity(PatchParser::kDefaultCacheCapacity);
+
+  PatchParser::clearCache();
+  ASSERT_EQ(0, PatchParser::getCacheStats().fSize);
+}
+
+// Patch.CacheLoadDirectory
+TEST(Patch, CacheLoadDirectory)
+{
+  PatchParser::clearCache();
+
+  auto patchesDir = fs::path(RE_MOCK_PROJECT_DIR) / "test" / "resources" / "re" / "mock" / "patches";
+  auto dir = fs::temp_directory_path() / "re-mock-Patch.CacheLoadDirectory";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+
+  // more patches than the default capacity of the cache
+  constexpr auto kPatchCount = PatchParser::kDefaultCacheCapacity + 10;
+  for(size_t i = 0; i < kPatchCount; i++)
+    fs::copy_file(patchesDir / "Kooza_test0.repatch", dir / fmt::printf("patch_%04ld.repatch", i));
+
+  auto res = PatchParser::loadDirectory(dir);
+  ASSERT_EQ(kPatchCount, res.fPatches.size());
+  ASSERT_GE(PatchParser::getCacheCapacity(), kPatchCount);
+
+  // nothing was evicted => none of the patches is parsed again
+  for(auto const &[path, patch]: res.fPatches)
+    ASSERT_EQ(patch, PatchParser::fromCache(resource::File{path}));
+  auto stats = PatchParser::getCacheStats();
+  ASSERT_EQ(kPatchCount, stats.fSize);
+  ASSERT_EQ(0, stats.fEvictionCount);
+  ASSERT_EQ(kPatchCount, stats.fMissCount);
+  ASSERT_EQ(kPatchCount, stats.fHitCount);
+
+  PatchParser::setCacheCapacity(PatchParser::kDefaultCacheCapacity);
+  PatchParser::clearCache();
+  fs::remove_all(dir);
+}
+
+// Patch.InvalidString
+TEST(Patch, InvalidString)
+{
+  auto patchString = R"(
+<?xml version="1.0"?>
+<JukeboxPatch version="2.0"  deviceProductID="com.acme.Kooza"  deviceVersion="1.0.0d1" >
+    <Properties>
+        <Object name="custom_properties" >
+            <Value property="prop_string"  type="string" >
+                41G2
+            </Value>
+        </Object>
+    </Properties>
+</JukeboxPatch>
+)";
+
+  ASSERT_THROW(PatchParser::from(resource::String{patchString}), Exception);
+}
+
+// Patch.Compiled
+TEST(Patch, Compiled)
+{
+  Rack rack{};
+
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      fDiffs.clear();
+      for(int i = 0; i < iDiffCount; i++)
+        fDiffs.emplace_back(JBox_toString(iPropertyDiffs[i].fPropertyRef));
+    }
+
+    std::vector<std::string> fDiffs{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::document_owner_property("prop_bool", lua::jbox_boolean_property{}))
+    .mdef(Config::document_owner_property("prop_float", lua::jbox_number_property{}.default_value(0.8)))
+    .mdef(Config::document_owner_property("prop_string", lua::jbox_string_property{}.default_value("abcd")))
+    .rtc(Config::rt_input_setup_notify("/custom_properties/*"));
+
+  auto re = rack.newDevice(c);
+  rack.nextBatch();
+
+  auto preset1 = re.compilePatch(resource::Patch{}
+                                   .boolean("/custom_properties/prop_bool", true)
+                                   .number("/custom_properties/prop_float", 0.1)
+                                   .string("/custom_properties/prop_string", "p1"));
+  auto preset2 = re.compilePatch(resource::Patch{}
+                                   .boolean("/custom_properties/prop_bool", true)
+                                   .number("/custom_properties/prop_float", 0.2)
+                                   .string("/custom_properties/prop_string", "p2"));
+  ASSERT_EQ(3, preset1.size());
+
+  re.loadPatch(preset1);
+  rack.nextBatch();
+  ASSERT_EQ(std::vector<std::string>({"/custom_properties/prop_bool",
+                                      "/custom_properties/prop_float",
+                                      "/custom_properties/prop_string"}), re->fDiffs);
+
+  // only what changed
+  re.loadPatch(preset2);
+  rack.nextBatch();
+  ASSERT_EQ(std::vector<std::string>({"/custom_properties/prop_float", "/custom_properties/prop_string"}), re->fDiffs);
+  ASSERT_FLOAT_EQ(0.2, re.getNum("/custom_properties/prop_float"));
+  ASSERT_EQ("p2", re.getString("/custom_properties/prop_string"));
+
+  // same patch => no change
+  re.loadPatch(preset2);
+  rack.nextBatch();
+  ASSERT_TRUE(re->fDiffs.empty());
+
+  // back to default
+  re.reset();
+  rack.nextBatch();
+  ASSERT_EQ(3, re->fDiffs.size());
+  ASSERT_FALSE(re.getBool("/custom_properties/prop_bool"));
+  ASSERT_EQ("abcd", re.getString("/custom_properties/prop_string"));
+
+  // validation happens at compile time
+  ASSERT_THROW(re.compilePatch(resource::Patch{}.number("/custom_properties/prop_bool", 1)), Exception);
+  ASSERT_THROW(re.compilePatch(resource::Patch{}.number("/environment/system_sample_rate", 1)), Exception);
+  ASSERT_THROW(re.compilePatch(resource::Patch{}.number("/custom_properties/invalid", 1)), Exception);
+
+  // a compiled patch is tied to the device
+  auto re2 = rack.newDevice(c);
+  ASSERT_THROW(re2.loadPatch(preset1), Exception);
+}
+
+// Patch.Delta
+TEST(Patch, Delta)
+{
+  Rack rack{};
+
+  auto c = DeviceConfig<MockDevice>::fromSkeleton()
+    .mdef(Config::document_owner_property("prop_bool", lua::jbox_boolean_property{}))
+    .mdef(Config::document_owner_property("prop_float", lua::jbox_number_property{}.default_value(0.8)))
+    .mdef(Config::document_owner_property("prop_string", lua::jbox_string_property{}.default_value("abcd")));
+
+  auto re = rack.newDevice(c);
+
+  // nothing changed since creation
+  ASSERT_TRUE(re.generatePatchDelta().fProperties.empty());
+
+  re.setNum("/custom_properties/prop_float", 0.5);
+  re.setString("/custom_properties/prop_string", "efgh");
+  re.setNum("/custom_properties/prop_float", 0.6);
+  re.setNum("/environment/system_sample_rate", 48000); // not persisted in patches
+
+  auto delta = re.generatePatchDelta();
+  ASSERT_EQ(2, delta.fProperties.size());
+  ASSERT_FLOAT_EQ(0.6, std::get<resource::Patch::number_property>(delta.fProperties["/custom_properties/prop_float"]).fValue);
+  ASSERT_EQ("efgh", std::get<resource::Patch::string_property>(delta.fProperties["/custom_properties/prop_string"]).fValue);
+
+  // delta has been consumed
+  ASSERT_TRUE(re.generatePatchDelta().fProperties.empty());
+
+  re.setBool("/custom_properties/prop_bool", true);
+  delta = re.generatePatchDelta();
+  ASSERT_EQ(1, delta.fProperties.size());
+  ASSERT_TRUE(std::get<resource::Patch::boolean_property>(delta.fProperties["/custom_properties/prop_bool"]).fValue);
+
+  // a delta is relative to the previous one
+  re.setNum("/custom_properties/prop_float", 0.7);
+  delta = re.generatePatchDelta();
+  ASSERT_EQ(1, delta.fProperties.size());
+  ASSERT_FLOAT_EQ(0.7, std::get<resource::Patch::number_property>(delta.fProperties["/custom_properties/prop_float"]).fValue);
+}
+
+}
@@ -20,6 +20,32 @@
 #include <re/mock/MockDevices.h>
 #include <gtest/gtest.h>
 #include <re/mock/MockJukebox.h>
+#include <re/mock/fs.h>
+#include <cstdlib>
+#include <new>
+
+//------------------------------------------------------------------------
+// Counts the heap allocations made by the current thread while enabled (see Rack.NoteChainNoAllocation)
+//------------------------------------------------------------------------
+namespace re::mock::Test::HeapCounter {
+thread_local bool tEnabled{};
+thread_local size_t tCount{};
+}
+
+void *operator new(std::size_t iSize)
+{
+  if(re::mock::Test::HeapCounter::tEnabled)
+    re::mock::Test::HeapCounter::tCount++;
+  if(auto ptr = std::malloc(iSize == 0 ? 1 : iSize))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t iSize) { return ::operator new(iSize); }
+void operator delete(void *iPtr) noexcept { std::free(iPtr); }
+void operator delete[](void *iPtr) noexcept { std::free(iPtr); }
+void operator delete(void *iPtr, std::size_t) noexcept { std::free(iPtr); }
+void operator delete[](void *iPtr, std::size_t) noexcept { std::free(iPtr); }
 
 namespace re::mock::Test {
 
@@ -249,6 +275,49 @@ TEST(Rack, CVUnWiring) {
   ASSERT_FLOAT_EQ(2.0, dst->fValue);
 }
 
+// Rack.CVWiringDiffs
+TEST(Rack, CVWiringDiffs) {
+  Rack rack{};
+
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      fDiffCount += iDiffCount;
+    }
+
+    int fDiffCount{};
+  };
+
+  auto src = rack.newDevice(MCVSrc::CONFIG);
+  auto dst = rack.newDevice(DeviceConfig<Device>::fromSkeleton()
+                              .mdef(Config::cv_in())
+                              .rtc(Config::rt_input_setup_notify("/cv_inputs/C/value")));
+  rack.wire(src.getCVOutSocket(MCVSrc::SOCKET), dst.getCVInSocket(Config::SOCKET));
+
+  rack.nextBatch();
+  dst->fDiffCount = 0;
+
+  src->fValue = 2.0;
+  rack.nextBatch(); // src outputs 2.0
+  rack.nextBatch(); // dst sees the change
+  ASSERT_EQ(1, dst->fDiffCount);
+  ASSERT_FLOAT_EQ(2.0, dst.getCVSocketValue("/cv_inputs/C"));
+
+  // same value => no diff
+  rack.nextBatch();
+  rack.nextBatch();
+  ASSERT_EQ(1, dst->fDiffCount);
+
+  src->fValue = 3.0;
+  rack.nextBatch();
+  rack.nextBatch();
+  ASSERT_EQ(2, dst->fDiffCount);
+  ASSERT_FLOAT_EQ(3.0, dst.getCVSocketValue("/cv_inputs/C"));
+}
+
 // Rack.CircularWiring
 TEST(Rack, CircularWiring)
 {
@@ -621,6 +690,38 @@ rtc_bindings = {
   ASSERT_EQ(re.getInstanceId(), re->fInstanceID);
 }
 
+// Rack.NewExtensions
+TEST(Rack, NewExtensions)
+{
+  Rack rack{};
+
+  auto src = rack.newDevice(MAUSrc::CONFIG);
+
+  std::vector<Config> configs{};
+  for(int i = 0; i < 8; i++)
+    configs.emplace_back(i % 2 == 0 ? MAUPst::CONFIG.getConfig() : MCVPst::CONFIG.getConfig());
+
+  // same ids as if created one at a time (whatever the thread count)
+  auto extensions = rack.newExtensions(configs, 4);
+  ASSERT_EQ(8, extensions.size());
+  for(int i = 0; i < 8; i++)
+  {
+    ASSERT_EQ(src.getInstanceId() + i + 1, extensions[i].getInstanceId());
+    ASSERT_EQ(extensions[i].getInstanceId(), extensions[i].getNum<int>("/environment/instance_id"));
+  }
+
+  rack.nextBatch();
+
+  // one failure => none of them is added
+  configs[5] = DeviceConfig<MockDevice>::fromSkeleton().rtc_string("rtc_bindings = {").getConfig();
+  ASSERT_THROW(rack.newExtensions(configs, 4), Exception);
+
+  auto dst = rack.newDevice(MAUDst::CONFIG);
+  ASSERT_EQ(extensions[7].getInstanceId() + 1, dst.getInstanceId());
+
+  rack.nextBatch();
+}
+
 // Rack.Transport
 TEST(Rack, Transport)
 {
@@ -718,4 +819,518 @@ TEST(Rack, Transport)
 
 }
 
-}
\ No newline at end of file
+// Rack.ActiveNotes
+TEST(Rack, ActiveNotes)
+{
+  Rack rack{};
+
+  auto c = DeviceConfig<MockDevice>::fromSkeleton().accept_notes(true);
+
+  auto re = rack.newDevice(c);
+
+  auto activeNotes = [&re]() {
+    return re.withJukebox<std::vector<int>>([](Motherboard &m) {
+      std::vector<int> res{};
+      for(int i = 0; i < 128; i++)
+        if(m.getActiveNotes().test(i))
+          res.emplace_back(i);
+      return res;
+    });
+  };
+
+  ASSERT_EQ(std::vector<int>{}, activeNotes());
+
+  re.setNoteInEvent(69, 100);
+  re.setNoteInEvent(60, 90);
+  rack.nextBatch();
+  ASSERT_EQ(std::vector<int>({60, 69}), activeNotes());
+  ASSERT_EQ(90, re.getNum<int>("/note_states/60"));
+
+  re.setNoteInEvent(69, 0);
+  rack.nextBatch();
+  ASSERT_EQ(std::vector<int>({60}), activeNotes());
+  ASSERT_EQ(0, re.getNum<int>("/note_states/69"));
+
+  re.withJukebox([](Motherboard &m) {
+    m.stopAllNotesOn();
+    ASSERT_TRUE(m.getActiveNotes().none());
+    // no-op when nothing is playing
+    m.stopAllNotesOn();
+    m.stopNoteIfOn(60);
+  });
+  ASSERT_EQ(0, re.getNum<int>("/note_states/60"));
+
+  // setting the property directly is tracked as well
+  re.setNum("/note_states/61", 10);
+  ASSERT_EQ(std::vector<int>({61}), activeNotes());
+}
+
+// Rack.NoteInEvents
+TEST(Rack, NoteInEvents)
+{
+  Rack rack{};
+
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      fNoteEvents.clear();
+      for(int i = 0; i < iDiffCount; i++)
+        fNoteEvents.emplace_back(JBox_AsNoteEvent(iPropertyDiffs[i]));
+    }
+
+    std::vector<TJBox_NoteEvent> fNoteEvents{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .accept_notes(true)
+    .rtc(Config::rt_input_setup_notify("/note_states/*"));
+
+  auto re = rack.newDevice(c);
+
+  rack.nextBatch();
+
+  std::vector<TJBox_NoteEvent> events{
+    {69, 100, 3},
+    {60, 90,  0},
+    {69, 0,  10},
+  };
+
+  re.setNoteInEvents(events.data(), events.size());
+  rack.nextBatch();
+  // diffs are sorted by frame index
+  ASSERT_EQ(std::vector<TJBox_NoteEvent>({{60, 90, 0}, {69, 100, 3}, {69, 0, 10}}), re->fNoteEvents);
+  ASSERT_EQ(90, re.getNum<int>("/note_states/60"));
+  ASSERT_EQ(0, re.getNum<int>("/note_states/69"));
+  ASSERT_TRUE(re.withJukebox<bool>([](Motherboard &m) { return m.getActiveNotes().test(60) && !m.getActiveNotes().test(69); }));
+
+  // invalid events: none is applied
+  std::vector<TJBox_NoteEvent> invalid{
+    {61, 100, 0},
+    {62, 200, 0},
+  };
+  ASSERT_THROW(re.setNoteInEvents(invalid.data(), invalid.size()), Exception);
+  rack.nextBatch();
+  ASSERT_TRUE(re->fNoteEvents.empty());
+  ASSERT_EQ(0, re.getNum<int>("/note_states/61"));
+
+  // nothing to do
+  re.setNoteInEvents(nullptr, 0);
+}
+
+// Rack.Snapshot
+TEST(Rack, Snapshot)
+{
+  Rack rack{};
+
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      fBatchCount++;
+      fDiffCount += iDiffCount;
+    }
+
+    int fBatchCount{};
+    int fDiffCount{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::document_owner_property("prop_float", lua::jbox_number_property{}.default_value(0.8).persistence(lua::EPersistence::kPatch)))
+    .rtc(Config::rt_input_setup_notify("/custom_properties/prop_float"))
+    .rt_cloner();
+
+  auto re = rack.newDevice(c);
+
+  rack.nextBatch();
+  rack.nextBatch();
+  rack.setTransportPlayPos(100);
+  re.setNum("/custom_properties/prop_float", 0.5); // diff pending (not yet delivered)
+
+  auto snapshot = rack.snapshot();
+
+  // modify everything
+  for(int i = 0; i < 5; i++)
+  {
+    re.setNum("/custom_properties/prop_float", 0.1 * i);
+    rack.nextBatch();
+  }
+  ASSERT_EQ(7, re->fBatchCount);
+  ASSERT_EQ(7, rack.getBatchCount());
+
+  for(int i = 0; i < 2; i++)
+  {
+    rack.restore(snapshot);
+
+    ASSERT_EQ(2, re->fBatchCount);
+    ASSERT_EQ(1, re->fDiffCount); // the initial diff (delivered on the first batch)
+    ASSERT_EQ(2, rack.getBatchCount());
+    ASSERT_EQ(100, rack.getTransportPlayPos());
+    ASSERT_FLOAT_EQ(0.5, re.getNum("/custom_properties/prop_float"));
+    ASSERT_EQ(1, re.generatePatchDelta().fProperties.size()); // dirty state is restored as well
+
+    // the pending diff is delivered after restore
+    rack.nextBatch();
+    ASSERT_EQ(3, re->fBatchCount);
+    ASSERT_EQ(2, re->fDiffCount);
+  }
+
+  // a rack with a different set of extensions cannot be restored
+  auto re2 = rack.newDevice(c);
+  ASSERT_THROW(rack.restore(snapshot), Exception);
+
+  // a device with a read/write instance which cannot be cloned cannot be snapshot (cloning is opt-in)
+  Rack rack2{};
+  rack2.newDevice(DeviceConfig<Device>::fromSkeleton());
+  ASSERT_THROW(rack2.snapshot(), Exception);
+}
+
+// Rack.SnapshotPartiallyResident
+TEST(Rack, SnapshotPartiallyResident)
+{
+  auto c = DeviceConfig<MockDevice>::fromSkeleton()
+    .mdef(Config::rtc_owner_property("prop_blob", lua::jbox_blob_property{}.default_value("/Private/blob.data")))
+    .mdef(Config::rtc_owner_property("prop_sample", lua::jbox_sample_property{}.default_value("/Private/sample.data")))
+    .blob_data("/Private/blob.data", {'a', 'b', 'c', 'd', 'e', 'f'})
+    .sample_data("/Private/sample.data", resource::Sample{}.sample_rate(44100).channels(2).data({0, 1, 2, 3, 4, 5}))
+    .resource_loading_context("/Private/blob.data", resource::LoadingContext{}.status(resource::LoadStatus::kPartiallyResident).resident_size(2))
+    .resource_loading_context("/Private/sample.data", resource::LoadingContext{}.status(resource::LoadStatus::kPartiallyResident).resident_size(1))
+    .rt_cloner();
+
+  Rack rack{};
+  auto re = rack.newDevice(c);
+
+  // reads all the resident data (like a device would)
+  auto blobData = [&re]() {
+    return re.withJukebox<std::vector<TJBox_UInt8>>([]() {
+      auto value = JBox_LoadMOMProperty(JBox_MakePropertyRef(JBox_GetMotherboardObjectRef("/custom_properties"), "prop_blob"));
+      std::vector<TJBox_UInt8> res(JBox_GetBLOBInfo(value).fResidentSize);
+      JBox_GetBLOBData(value, 0, static_cast<TJBox_SizeT>(res.size()), res.data());
+      return res;
+    });
+  };
+
+  auto sampleData = [&re]() {
+    return re.withJukebox<std::vector<TJBox_AudioSample>>([]() {
+      auto value = JBox_LoadMOMProperty(JBox_MakePropertyRef(JBox_GetMotherboardObjectRef("/custom_properties"), "prop_sample"));
+      auto info = JBox_GetSampleInfo(value);
+      std::vector<TJBox_AudioSample> res(info.fResidentFrameCount * info.fChannels);
+      JBox_GetSampleData(value, 0, info.fResidentFrameCount, res.data());
+      return res;
+    });
+  };
+
+  rack.nextBatch();
+  ASSERT_EQ(std::vector<TJBox_UInt8>({'a', 'b'}), blobData());
+  ASSERT_EQ(std::vector<TJBox_AudioSample>({0, 1}), sampleData());
+
+  auto snapshot = rack.snapshot();
+
+  // loading more data does not modify the values held by the snapshot
+  re.loadMoreBlob("/custom_properties/prop_blob", 2);
+  re.loadMoreSample("/custom_properties/prop_sample", 1);
+  rack.nextBatch();
+  ASSERT_EQ(std::vector<TJBox_UInt8>({'a', 'b', 'c', 'd'}), blobData());
+  ASSERT_EQ(std::vector<TJBox_AudioSample>({0, 1, 2, 3}), sampleData());
+
+  rack.restore(snapshot);
+  ASSERT_EQ(std::vector<TJBox_UInt8>({'a', 'b'}), blobData());
+  ASSERT_EQ(std::vector<TJBox_AudioSample>({0, 1}), sampleData());
+
+  // and the data can be loaded again
+  re.loadMoreBlob("/custom_properties/prop_blob");
+  re.loadMoreSample("/custom_properties/prop_sample");
+  ASSERT_EQ(std::vector<TJBox_UInt8>({'a', 'b', 'c', 'd', 'e', 'f'}), blobData());
+  ASSERT_EQ(std::vector<TJBox_AudioSample>({0, 1, 2, 3, 4, 5}), sampleData());
+}
+
+// Rack.SaveLoadState
+TEST(Rack, SaveLoadState)
+{
+  auto c = DeviceConfig<MockDevice>::fromSkeleton()
+    .accept_notes(true)
+    .mdef(Config::document_owner_property("prop_float", lua::jbox_number_property{}.default_value(0.8).persistence(lua::EPersistence::kPatch)))
+    .mdef(Config::document_owner_property("prop_string", lua::jbox_string_property{}.default_value("abc")));
+
+  auto stateFile = (fs::temp_directory_path() / "re-mock-Rack.SaveLoadState.rems").string();
+
+  Rack rack{};
+  auto re = rack.newDevice(c);
+
+  rack.setTransportTempo(140);
+  rack.setTransportPlayPos(5 * 15360); // second bar
+  rack.transportStart();
+  re.setNoteInEvent(60, 90);
+  rack.nextBatch();
+  rack.nextBatch();
+  re.setNum("/custom_properties/prop_float", 0.5);
+  re.setString("/custom_properties/prop_string", "def");
+
+  rack.saveState(stateFile);
+  auto playPos = rack.getTransportPlayPos();
+
+  // a new rack (same setup) resumes from the saved state
+  Rack rack2{};
+  auto re2 = rack2.newDevice(c);
+  rack2.loadState(stateFile);
+
+  ASSERT_EQ(2, rack2.getBatchCount());
+  ASSERT_TRUE(rack2.getTransportPlaying());
+  ASSERT_EQ(playPos, rack2.getTransportPlayPos());
+  ASSERT_EQ(4 * 15360, rack2.getTransportBarStartPos());
+  ASSERT_FLOAT_EQ(140, rack2.getTransportTempo());
+  ASSERT_FLOAT_EQ(0.5, re2.getNum("/custom_properties/prop_float"));
+  ASSERT_EQ("def", re2.getString("/custom_properties/prop_string"));
+  ASSERT_EQ(90, re2.getNum<int>("/note_states/60"));
+  ASSERT_TRUE(re2.withJukebox<bool>([](Motherboard &m) { return m.getActiveNotes().test(60); }));
+  ASSERT_EQ(re.generatePatchDelta().fProperties.size(), re2.generatePatchDelta().fProperties.size());
+
+  // both racks now render identically
+  rack.nextBatch();
+  rack2.nextBatch();
+  ASSERT_EQ(rack.getTransportPlayPos(), rack2.getTransportPlayPos());
+
+  // device state only
+  auto deviceFile = (fs::temp_directory_path() / "re-mock-Rack.SaveLoadState-device.rems").string();
+  re.setNum("/custom_properties/prop_float", 0.25);
+  re.saveState(deviceFile);
+  re2.loadState(deviceFile);
+  ASSERT_FLOAT_EQ(0.25, re2.getNum("/custom_properties/prop_float"));
+
+  // wrong kind
+  ASSERT_THROW(rack2.loadState(deviceFile), Exception);
+  ASSERT_THROW(re2.loadState(stateFile), Exception);
+
+  // different set of extensions
+  rack2.newDevice(c);
+  ASSERT_THROW(rack2.loadState(stateFile), Exception);
+
+  // missing file
+  ASSERT_THROW(rack.loadState((fs::temp_directory_path() / "re-mock-does-not-exist.rems").string()), Exception);
+
+  // a truncated state leaves the rack untouched (the whole file is validated before being applied)
+  {
+    Rack rack3{};
+    auto re3 = rack3.newDevice(c);
+    auto re4 = rack3.newDevice(c);
+    re3.setNum("/custom_properties/prop_float", 0.1);
+    re4.setNum("/custom_properties/prop_float", 0.2);
+    rack3.nextBatch();
+    rack3.saveState(stateFile);
+    fs::resize_file(stateFile, fs::file_size(stateFile) - 1); // the last extension cannot be read anymore
+
+    re3.setNum("/custom_properties/prop_float", 0.3);
+    rack3.nextBatch();
+    ASSERT_THROW(rack3.loadState(stateFile), Exception);
+    ASSERT_FLOAT_EQ(0.3, re3.getNum("/custom_properties/prop_float"));
+    ASSERT_FLOAT_EQ(0.2, re4.getNum("/custom_properties/prop_float"));
+    ASSERT_EQ(2, rack3.getBatchCount());
+  }
+}
+
+// Rack.LoadStateDiffs
+TEST(Rack, LoadStateDiffs)
+{
+  // records the diffs received by the device
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      for(TJBox_UInt32 i = 0; i < iDiffCount; i++)
+        fGain = JBox_GetNumber(iPropertyDiffs[i].fCurrentValue);
+      fDiffCount += static_cast<int>(iDiffCount);
+    }
+
+    TJBox_Float64 fGain{};
+    int fDiffCount{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::document_owner_property("gain", lua::jbox_number_property{}.default_value(0.5)))
+    .mdef(Config::rtc_owner_property("gain_copy", lua::jbox_number_property{}.default_value(0)))
+    .rtc(Config::rt_input_setup_notify("/custom_properties/gain"))
+    .rtc(Config::rtc_binding("/custom_properties/gain", "/global_rtc/on_gain"))
+    .rtc_string(R"(
+global_rtc["on_gain"] = function(source_property_path, new_value)
+  jbox.store_property("/custom_properties/gain_copy", new_value)
+end
+)");
+
+  auto stateFile = (fs::temp_directory_path() / "re-mock-Rack.LoadStateDiffs.rems").string();
+  auto deviceFile = (fs::temp_directory_path() / "re-mock-Rack.LoadStateDiffs-device.rems").string();
+
+  {
+    Rack rack{};
+    auto re = rack.newDevice(c);
+    re.setNum("/custom_properties/gain", 0.8);
+    rack.nextBatch();
+    ASSERT_FLOAT_EQ(0.8, re->fGain);
+    rack.saveState(stateFile);
+    re.saveState(deviceFile);
+  }
+
+  // restored in a fresh rack: the device sees the loaded value (rt notify and rtc binding)
+  {
+    Rack rack{};
+    auto re = rack.newDevice(c);
+    rack.loadState(stateFile);
+    rack.nextBatch();
+    ASSERT_FLOAT_EQ(0.8, re->fGain);
+    ASSERT_FLOAT_EQ(0.8, re.getNum("/custom_properties/gain_copy"));
+    ASSERT_EQ(2, re->fDiffCount); // the (pending) initial diff followed by the loaded value
+
+    // restored in a device which already processed batches
+    re.setNum("/custom_properties/gain", 0.2);
+    rack.nextBatch();
+    ASSERT_FLOAT_EQ(0.2, re->fGain);
+    re.loadState(deviceFile);
+    rack.nextBatch();
+    ASSERT_FLOAT_EQ(0.8, re->fGain);
+    ASSERT_FLOAT_EQ(0.8, re.getNum("/custom_properties/gain_copy"));
+    ASSERT_EQ(4, re->fDiffCount);
+  }
+
+  // an rt string longer than the max_size of the property is rejected
+  {
+    Rack rack{};
+    auto re = rack.newDevice(DeviceConfig<MockDevice>::fromSkeleton()
+                               .mdef(Config::rt_owner_property("prop_rt_string", lua::jbox_string_property{}.max_size(10))));
+    re.setRTString("/custom_properties/prop_rt_string", "0123456789");
+    re.saveState(deviceFile);
+
+    auto re2 = rack.newDevice(DeviceConfig<MockDevice>::fromSkeleton()
+                                .mdef(Config::rt_owner_property("prop_rt_string", lua::jbox_string_property{}.max_size(5))));
+    ASSERT_THROW(re2.loadState(deviceFile), Exception);
+    ASSERT_EQ("", re2.getRTString("/custom_properties/prop_rt_string"));
+  }
+}
+
+// Rack.MemoryReport
+TEST(Rack, MemoryReport)
+{
+  using Subsystem = re::mock::MemoryReport::Subsystem;
+
+  auto c = DeviceConfig<MAUDst>::fromSkeleton(DeviceType::kHelper)
+    .mdef(Config::stereo_audio_in())
+    .mdef(Config::rtc_owner_property("prop_sample", lua::jbox_sample_property{}.default_value("/Private/sample.data")))
+    .mdef(Config::rtc_owner_property("prop_blob", lua::jbox_blob_property{}.default_value("/Private/blob.data")))
+    .sample_data("/Private/sample.data", resource::Sample{}.sample_rate(44100).channels(1).data({0,1,2,3}))
+    .blob_data("/Private/blob.data", std::vector<char>(100, 'x'));
+
+  std::vector<std::shared_ptr<MemoryCounter>> counters{};
+
+  {
+    Rack rack{};
+
+    auto src = rack.newDevice(MAUSrc::CONFIG);
+    auto dst = rack.newDevice(c);
+    MockAudioDevice::wire(rack, src, dst);
+
+    auto report = dst.memoryReport();
+    ASSERT_GT(report[Subsystem::kPropertyStore].fBytes, 0);
+    ASSERT_GT(report[Subsystem::kJboxValues].fBytes, 0);
+    ASSERT_GE(report[Subsystem::kDSPBuffers].fBytes, 2 * sizeof(impl::AlignedDSPBuffer));
+    ASSERT_EQ(4 * sizeof(TJBox_AudioSample), report[Subsystem::kSampleData].fBytes);
+    ASSERT_EQ(100, report[Subsystem::kBlobData].fBytes);
+    ASSERT_GT(report[Subsystem::kLuaHeap].fBytes, 0);
+    ASSERT_GE(report[Subsystem::kLuaHeap].fPeakBytes, report[Subsystem::kLuaHeap].fBytes);
+    ASSERT_EQ(0, report[Subsystem::kSequencerEvents].fBytes);
+    ASSERT_EQ(0, report[Subsystem::kCapturedSamples].fBytes);
+
+    // sequencer events
+    dst.getSequencerTrack().noteOn(sequencer::PPQ{0}, 60).noteOff(sequencer::PPQ{1}, 60);
+    ASSERT_GT(dst.memoryReport()[Subsystem::kSequencerEvents].fBytes, 0);
+
+    // captured samples (no longer charged once handed over)
+    dst->produceSample();
+    rack.nextBatch();
+    rack.nextBatch();
+    ASSERT_EQ(dst->peekSample().fData.capacity() * sizeof(TJBox_AudioSample),
+              dst.memoryReport()[Subsystem::kCapturedSamples].fBytes);
+    auto sample = dst->getSample();
+    ASSERT_EQ(0, dst.memoryReport()[Subsystem::kCapturedSamples].fBytes);
+    ASSERT_GT(dst.memoryReport()[Subsystem::kCapturedSamples].fPeakBytes, 0);
+
+    // rack = sum of the extensions
+    auto rackReport = rack.memoryReport();
+    ASSERT_EQ(2, rackReport.fExtensions.size());
+    size_t total{};
+    for(auto const &[id, r]: rackReport.fExtensions)
+      total += r.getTotalBytes();
+    ASSERT_EQ(total, rackReport.fTotal.getTotalBytes());
+    ASSERT_EQ(src.memoryReport().getTotalBytes() + dst.memoryReport().getTotalBytes(), total);
+
+    for(size_t i = 0; i < re::mock::MemoryReport::kSubsystemCount; i++)
+      counters.emplace_back(dst.getMemoryCounter(static_cast<Subsystem>(i)));
+  }
+
+  // everything is released with the rack
+  for(auto const &counter: counters)
+    ASSERT_EQ(0, counter->getBytes());
+}
+
+// Rack.NoteChainNoAllocation
+TEST(Rack, NoteChainNoAllocation)
+{
+  using Subsystem = re::mock::MemoryReport::Subsystem;
+
+  constexpr int kDeviceCount = 4;
+  constexpr int kNoteCount = 8;
+
+  Rack rack{};
+  auto src = rack.newDevice(MNPSrc::CONFIG);
+  std::vector<rack::Extension> extensions{src};
+  for(int i = 0; i < kDeviceCount; i++)
+  {
+    auto pst = rack.newDevice(MNPPst::CONFIG);
+    MockNotePlayer::wire(rack, extensions.back(), pst);
+    extensions.emplace_back(pst);
+  }
+  auto dst = rack.newDevice(MNPDst::CONFIG);
+  MockNotePlayer::wire(rack, extensions.back(), dst);
+  extensions.emplace_back(dst);
+
+  bool on = true;
+  auto batch = [&rack, &src, &on]() {
+    for(int i = 0; i < kNoteCount; i++)
+      src->fNoteEvents.note(static_cast<TJBox_UInt8>(60 + i), on ? 100 : 0, static_cast<TJBox_UInt16>(i));
+    on = !on;
+    rack.nextBatch();
+  };
+
+  // warm up (buffers reach their steady state capacity)
+  for(int i = 0; i < 10; i++)
+    batch();
+
+  auto allocationCount = [&extensions]() {
+    size_t count{};
+    for(auto const &extension: extensions)
+    {
+      for(size_t i = 0; i < re::mock::MemoryReport::kSubsystemCount; i++)
+        count += extension.getMemoryCounter(static_cast<Subsystem>(i))->getAllocationCount();
+    }
+    return count;
+  };
+
+  auto const accountedAllocations = allocationCount();
+
+  HeapCounter::tCount = 0;
+  HeapCounter::tEnabled = true;
+  for(int i = 0; i < 100; i++)
+    batch();
+  HeapCounter::tEnabled = false;
+
+  ASSERT_EQ(0, HeapCounter::tCount);
+  ASSERT_EQ(accountedAllocations, allocationCount());
+
+  // the notes made it all the way through the chain
+  ASSERT_EQ(kNoteCount, dst->fNoteEvents.events().size());
+}
+
+}
@@ -1318,4 +1318,209 @@ TEST(RackExtension, Destructor)
   rack.nextBatch();
 }
 
-}
\ No newline at end of file
+// RackExtension.RenderValidation
+TEST(RackExtension, RenderValidation)
+{
+  Rack rack{};
+
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(const TJBox_PropertyDiff iPropertyDiffs[], TJBox_UInt32 iDiffCount) override
+    {
+      auto customProperties = JBox_GetMotherboardObjectRef("/custom_properties");
+      JBox_StoreMOMProperty(JBox_MakePropertyRef(customProperties, "prop_steps"), JBox_MakeNumber(fSteps));
+      JBox_StoreMOMProperty(JBox_MakePropertyRef(customProperties, "prop_number"), JBox_MakeNumber(fNumber));
+    }
+
+    TJBox_Float64 fSteps{};
+    TJBox_Float64 fNumber{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::rt_owner_property("prop_steps", lua::jbox_number_property{}.default_value(1).steps(3)))
+    .mdef(Config::rt_owner_property("prop_number", lua::jbox_number_property{}.default_value(0)));
+
+  auto re = rack.newDevice(c);
+
+  rack.nextBatch();
+
+  // step count constraint
+  re->fSteps = 2;
+  rack.nextBatch();
+  ASSERT_EQ(2, re.getNum<int>("/custom_properties/prop_steps"));
+  re->fSteps = 3;
+  ASSERT_THROW(rack.nextBatch(), Exception);
+  ASSERT_THROW(re.setNum("/custom_properties/prop_steps", -1), Exception);
+
+  // release mode: values stored while rendering are not validated anymore...
+  re.disableRenderValidation();
+  rack.nextBatch();
+  ASSERT_EQ(3, re.getNum<int>("/custom_properties/prop_steps"));
+
+  // ... but they still are via the api
+  ASSERT_THROW(re.setNum("/custom_properties/prop_steps", 4), Exception);
+  ASSERT_THROW(re.setBool("/custom_properties/prop_number", true), Exception);
+
+  re.enableRenderValidation();
+  ASSERT_THROW(rack.nextBatch(), Exception);
+  re->fSteps = 0;
+  rack.nextBatch();
+  ASSERT_EQ(0, re.getNum<int>("/custom_properties/prop_steps"));
+}
+
+// RackExtension.ValueConstraints
+TEST(RackExtension, ValueConstraints)
+{
+  Rack rack{};
+
+  auto c = DeviceConfig<MockDevice>::fromSkeleton()
+    .mdef(Config::patterns(2))
+    .mdef(Config::document_owner_property("prop_string", lua::jbox_string_property{}.default_value("abcdef")))
+    .mdef(Config::rt_owner_property("prop_rt_string", lua::jbox_string_property{}.max_size(5)));
+
+  auto re = rack.newDevice(c);
+  rack.nextBatch();
+
+  // integer range (pattern index in [kJBox_NoPatternIndex, num_patterns - 1])
+  re.setNum("/transport/pattern_index", 1);
+  re.setNum("/transport/pattern_index", kJBox_NoPatternIndex);
+  ASSERT_THROW(re.setNum("/transport/pattern_index", 2), Exception);
+  ASSERT_THROW(re.setNum("/transport/pattern_index", -2), Exception);
+  ASSERT_THROW(re.setNum("/transport/pattern_index", 0.5), Exception);
+  ASSERT_THROW(re.setNum("/transport/pattern_index", -0.5), Exception);
+  ASSERT_THROW(re.setBool("/transport/pattern_index", true), Exception);
+  ASSERT_EQ(kJBox_NoPatternIndex, re.getNum<int>("/transport/pattern_index"));
+
+  // rt string max size
+  re.withJukebox([]() {
+    auto customProperties = JBox_GetMotherboardObjectRef("/custom_properties");
+    auto rtString = JBox_MakePropertyRef(customProperties, "prop_rt_string");
+    JBox_SetRTStringData(rtString, 5, reinterpret_cast<TJBox_UInt8 const *>("12345"));
+    // 6 characters
+    ASSERT_THROW(JBox_StoreMOMProperty(rtString, JBox_LoadMOMProperty(JBox_MakePropertyRef(customProperties, "prop_string"))), Exception);
+  });
+  ASSERT_EQ("12345", re.getRTString("/custom_properties/prop_rt_string"));
+}
+
+
+// RackExtension.LazyProperties
+TEST(RackExtension, LazyProperties)
+{
+  Rack rack{};
+
+  auto c = DeviceConfig<MockDevice>::fromSkeleton()
+    .accept_notes(true)
+    .rt_cloner()
+    .mdef(Config::patterns(4))
+    .mdef(Config::user_sample(0, lua::jbox_user_sample_property{}.all_sample_parameters()))
+    .mdef(Config::user_sample(1, lua::jbox_user_sample_property{}.all_sample_parameters()));
+  for(int i = 0; i < 100; i++)
+    c.mdef(Config::document_owner_property(fmt::printf("prop_%d", i), lua::jbox_number_property{}.default_value(0.5).persistence(lua::EPersistence::kPatch)));
+
+  auto re = rack.newDevice(c);
+
+  auto propertyCount = re.withJukebox<size_t>([](Motherboard &m) { return m.getPropertyCount(); });
+  auto materializedCount = [&re]() { return re.withJukebox<size_t>([](Motherboard &m) { return m.getMaterializedPropertyCount(); }); };
+
+  // 100 custom properties + 128 note states + 2 x 9 user sample properties + 4 patterns...
+  ASSERT_GT(propertyCount, 250);
+  auto initialCount = materializedCount();
+  ASSERT_LT(initialCount, 50);
+
+  // enumerating the properties and generating patches does not materialise them
+  ASSERT_EQ(propertyCount, re.getPropertyInfos().size());
+  ASSERT_EQ(re.getDefaultValuesPatch().fProperties.size(), re.generatePatch().fProperties.size());
+  ASSERT_FLOAT_EQ(0.5, std::get<resource::Patch::number_property>(re.generatePatch().fProperties["/custom_properties/prop_42"]).fValue);
+  ASSERT_EQ(initialCount, materializedCount());
+
+  // first access
+  ASSERT_FLOAT_EQ(0.5, re.getNum("/custom_properties/prop_42"));
+  ASSERT_EQ(initialCount + 1, materializedCount());
+  re.setNum("/custom_properties/prop_42", 0.25);
+  ASSERT_EQ(initialCount + 1, materializedCount());
+  ASSERT_FLOAT_EQ(0.25, std::get<resource::Patch::number_property>(re.generatePatch().fProperties["/custom_properties/prop_42"]).fValue);
+  ASSERT_FLOAT_EQ(0.5, std::get<resource::Patch::number_property>(re.getDefaultValuesPatch().fProperties.at("/custom_properties/prop_42")).fValue);
+
+  re.setNoteInEvent(60, 100);
+  rack.nextBatch();
+  ASSERT_EQ(100, re.getNum<int>("/note_states/60"));
+  ASSERT_EQ(0, re.getNum<int>("/note_states/61"));
+  ASSERT_EQ(initialCount + 3, materializedCount());
+
+  // resetting (default values patch) only touches properties persisted in patches
+  re.reset();
+  ASSERT_FLOAT_EQ(0.5, re.getNum("/custom_properties/prop_42"));
+
+  // a snapshot needs all of them
+  rack.snapshot();
+  ASSERT_EQ(propertyCount, materializedCount());
+
+  // invalid definitions are still reported when the device is created
+  ASSERT_THROW(rack.newDevice(DeviceConfig<MockDevice>::fromSkeleton()
+                                .mdef(Config::document_owner_property("prop_steps", lua::jbox_number_property{}.default_value(5).steps(3)))),
+               Exception);
+}
+
+// RackExtension.RTCBindingsAndNotify
+TEST(RackExtension, RTCBindingsAndNotify)
+{
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      fDiffCount += static_cast<int>(iDiffCount);
+    }
+
+    int fDiffCount{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::document_owner_property("gain", lua::jbox_number_property{}.default_value(0.5)))
+    .mdef(Config::rtc_owner_property("gain_copy", lua::jbox_number_property{}.default_value(0)))
+    .rtc(Config::rt_input_setup_notify("/custom_properties/gain"))
+    .rtc(Config::rtc_binding("/custom_properties/gain", "/global_rtc/on_gain"))
+    .rtc_string(R"(
+global_rtc["on_gain"] = function(source_property_path, new_value)
+  jbox.store_property("/custom_properties/gain_copy", new_value)
+end
+)");
+
+  Rack rack{};
+  auto re = rack.newDevice(c);
+  rack.nextBatch();
+
+  auto diffCount = re->fDiffCount;
+  ASSERT_FLOAT_EQ(0.5, re.getNum("/custom_properties/gain_copy"));
+
+  // bindings disabled => the binding is not invoked but the device is still notified
+  re.disableRTCBindings();
+  re.setNum("/custom_properties/gain", 0.6);
+  rack.nextBatch();
+  ASSERT_EQ(diffCount + 1, re->fDiffCount);
+  ASSERT_FLOAT_EQ(0.5, re.getNum("/custom_properties/gain_copy"));
+
+  re.enableRTCBindings();
+  re.setNum("/custom_properties/gain", 0.7);
+  rack.nextBatch();
+  ASSERT_EQ(diffCount + 2, re->fDiffCount);
+  ASSERT_FLOAT_EQ(0.7, re.getNum("/custom_properties/gain_copy"));
+
+  // notify disabled => the device is not notified but the binding is still invoked
+  re.disableRTCNotify();
+  re.setNum("/custom_properties/gain", 0.8);
+  rack.nextBatch();
+  ASSERT_EQ(diffCount + 2, re->fDiffCount);
+  ASSERT_FLOAT_EQ(0.8, re.getNum("/custom_properties/gain_copy"));
+
+  re.enableRTCNotify();
+  re.setNum("/custom_properties/gain", 0.9);
+  rack.nextBatch();
+  ASSERT_EQ(diffCount + 3, re->fDiffCount);
+  ASSERT_FLOAT_EQ(0.9, re.getNum("/custom_properties/gain_copy"));
+}
+
+}
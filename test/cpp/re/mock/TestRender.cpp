@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include <re/mock/Render.h>
+#include <gtest/gtest.h>
+#include <re_mock_build.h>
+
+namespace re::mock::Test {
+
+using namespace mock;
+
+// Render.Jobs
+TEST(Render, Jobs)
+{
+  auto sinePath = fs::path(RE_MOCK_PROJECT_DIR) / "test" / "resources" / "re" / "mock" / "audio" / "sine.wav";
+  auto outDir = fs::temp_directory_path() / "re-mock-render";
+
+  auto jobs = render::Job::fromString(fmt::printf(R"(
+jobs = {
+  { name = "sine", input = "%s", output = "sine.wav", duration_ms = 10, main_in = { "L", "R" }, main_out = { "L", "R" } },
+  { input = "%s", output = "sub/sine48.wav", sample_rate = 48000, main_in = { "L", "R" }, main_out = { "L", "R" } },
+  { name = "no_input", output = "no_input.wav" },
+}
+)", sinePath.u8string(), sinePath.u8string()), outDir);
+
+  ASSERT_EQ(3, jobs.size());
+  ASSERT_EQ("sine", jobs[0].fName);
+  ASSERT_EQ(outDir / "sine.wav", jobs[0].fOutputFile);
+  ASSERT_FLOAT_EQ(10, jobs[0].fDuration.fMilliseconds);
+  ASSERT_EQ(44100, jobs[0].fSampleRate);
+  ASSERT_EQ("sine48", jobs[1].fName); // defaults to the output file name
+  ASSERT_EQ(48000, jobs[1].fSampleRate);
+  ASSERT_EQ("MainInLeft", jobs[2].fMainIn.first);
+
+  auto results = render::run(MAUPst::CONFIG.getConfig(), jobs, 2);
+  ASSERT_EQ(3, results.size());
+
+  StudioEffectTester<MAUPst> tester(MAUPst::CONFIG);
+  auto sine = tester.loadSample(resource::File{sinePath});
+
+  // pass through => output is the input (followed by the tail of 10ms = 441 frames)
+  ASSERT_FALSE(results[0].fError.has_value());
+  ASSERT_EQ(sine->getFrameCount() + 441, results[0].fFrameCount);
+  ASSERT_GT(results[0].getRealTimeFactor(), 0);
+  auto output = tester.loadSample(resource::File{outDir / "sine.wav"});
+  ASSERT_EQ(*sine, output->subSample(0, sine->getFrameCount()));
+
+  ASSERT_FALSE(results[1].fError.has_value());
+  ASSERT_TRUE(fs::exists(outDir / "sub" / "sine48.wav"));
+
+  // an effect requires an input
+  ASSERT_TRUE(results[2].fError.has_value());
+  ASSERT_FALSE(fs::exists(outDir / "no_input.wav"));
+
+  fs::remove_all(outDir);
+}
+
+// Render.NonStdException
+TEST(Render, NonStdException)
+{
+  struct Device : public MockDevice
+  {
+    Device(int iSampleRate) : MockDevice(iSampleRate) { throw 42; }
+  };
+
+  auto outDir = fs::temp_directory_path() / "re-mock-render-error";
+  auto jobs = render::Job::fromString(R"(jobs = { { name = "error", output = "error.wav" }, { name = "error2", output = "error2.wav" } })", outDir);
+
+  // a throw which is not a std::exception is still reported in the result (instead of terminating)
+  auto results = render::run(DeviceConfig<Device>::fromSkeleton(DeviceType::kInstrument).getConfig(), jobs, 2);
+  ASSERT_EQ(2, results.size());
+  ASSERT_EQ("Job [error]: unknown error", results[0].fError);
+  ASSERT_EQ("Job [error2]: unknown error", results[1].fError);
+
+  fs::remove_all(outDir);
+}
+
+}
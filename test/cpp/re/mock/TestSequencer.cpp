@@ -390,4 +390,144 @@ batch=775,pos=65271,note=61,vel=100,idx=13
   ASSERT_EQ(s, tester.device()->fOutput);
 }
 
-}
\ No newline at end of file
+// Track.notesAndEvents
+TEST(Track, notesAndEvents)
+{
+  auto c = DeviceConfig<MockDevice>::fromSkeleton().accept_notes(true);
+
+  auto tester = HelperTester<MockDevice>(c);
+
+  std::vector<std::string> output{};
+
+  auto recordNote = [&output](char const *iWhen) {
+    return [&output, iWhen](Motherboard &m, Track::Batch const &) {
+      output.emplace_back(fmt::printf("%s:%d", iWhen, m.getNum<int>("/note_states/60")));
+    };
+  };
+
+  // events are added out of order and notes / events at the same time must be executed in insertion order
+  tester.sequencerTrack()
+    .at(sequencer::Time(1,2,1,0))
+    .event(recordNote("before-on"))
+    .noteOn(60, 90)
+    .event(recordNote("after-on"))
+    .noteOff(60)
+    .event(recordNote("after-off"))
+    .at(sequencer::Time(1,1,2,0))
+    .event(recordNote("first"))
+    .noteOn(60, 80)
+    ;
+
+  ASSERT_EQ(sequencer::Time(1,1,2,0).toString(), tester.sequencerTrack().getFirstEventTime().toString());
+  ASSERT_EQ(sequencer::Time(1,2,1,0).toString(), tester.sequencerTrack().getLastEventTime().toString());
+
+  tester.newTimeline().play(sequencer::Duration(0,1,1,0));
+
+  ASSERT_EQ(std::vector<std::string>({"first:0", "before-on:80", "after-on:90", "after-off:0"}), output);
+
+  // notes only
+  tester.sequencerTrack().reset();
+  ASSERT_THROW(tester.sequencerTrack().getFirstEventTime(), Exception);
+  tester.sequencerTrack().note(sequencer::Time(1,3,1,0), 62, sequencer::Duration::k1Sixteenth_4x4);
+  ASSERT_EQ(sequencer::Time(1,3,1,0).toString(), tester.sequencerTrack().getFirstEventTime().toString());
+  ASSERT_EQ(sequencer::Time(1,3,2,0).toString(), tester.sequencerTrack().getLastEventTime().toString());
+}
+
+// Track.stats
+TEST(Track, stats)
+{
+  auto c = DeviceConfig<MockDevice>::fromSkeleton().accept_notes(true);
+
+  auto tester = HelperTester<MockDevice>(c);
+
+  tester.sequencerTrack()
+    .event(sequencer::Time(1,1,2,0), Track::kNoOp)
+    .event(sequencer::Time(1,3,1,0), Track::kNoOp)
+    .note(sequencer::Time(1,2,1,0), 60, sequencer::Duration::k1Sixteenth_4x4);
+
+  tester.newTimeline().play(sequencer::Duration(1,0,0,0));
+
+  auto const &stats = tester.sequencerTrack().getStats();
+  ASSERT_EQ(2, stats.fEventCount);
+  ASSERT_EQ(2, stats.fNoteCount);
+  // contiguous batches never relocate the cursor (only the very first one does)
+  ASSERT_EQ(1, stats.fCursorRebindCount);
+
+  // seek => cursor must be relocated
+  tester.sequencerTrack().resetStats();
+  tester.transportPlayPos(sequencer::Time(1,2,1,0));
+  tester.newTimeline().play(sequencer::Duration(0,2,0,0));
+  ASSERT_EQ(1, stats.fEventCount);
+  ASSERT_EQ(2, stats.fNoteCount);
+  ASSERT_EQ(1, stats.fCursorRebindCount);
+
+  // adding an event invalidates the cursor
+  tester.sequencerTrack().resetStats();
+  tester.sequencerTrack().event(sequencer::Time(1,4,2,0), Track::kNoOp);
+  tester.newTimeline().play(sequencer::Duration(0,1,0,0));
+  ASSERT_EQ(1, stats.fEventCount);
+  ASSERT_EQ(0, stats.fNoteCount);
+  ASSERT_EQ(1, stats.fCursorRebindCount);
+}
+
+// Track.automation
+TEST(Track, automation)
+{
+  struct Device : public MockDevice
+  {
+    explicit Device(int iSampleRate) : MockDevice(iSampleRate), fCustomProperties{JBox_GetMotherboardObjectRef("/custom_properties")} {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      for(TJBox_UInt32 i = 0; i < iDiffCount; i++)
+      {
+        auto const &diff = iPropertyDiffs[i];
+        if(diff.fPropertyRef.fObject == fCustomProperties)
+          fOutput.emplace_back(fmt::printf("%.3f@%d", JBox_GetNumber(diff.fCurrentValue), diff.fAtFrameIndex));
+      }
+    }
+
+    TJBox_ObjectRef fCustomProperties;
+    std::vector<std::string> fOutput{};
+  };
+
+  auto c = DeviceConfig<Device>::fromSkeleton()
+    .mdef(Config::document_owner_property("gain", lua::jbox_number_property{}.default_value(0.5)))
+    .rtc(Config::rt_input_setup_notify("/custom_properties/gain"));
+
+  auto tester = HelperTester<Device>(c, 48000);
+  tester.rack().setTransportTempo(187.5); // 1ppq == 1 sample == 1 fAtFrameIndex => 1 batch == 64ppq
+  tester.nextBatch();
+  tester.device()->fOutput.clear();
+
+  // points added out of order
+  tester.sequencerTrack()
+    .automation("/custom_properties/gain", PPQ{200}, 0.25, Track::Interpolation::kStep)
+    .automation("/custom_properties/gain", PPQ{64}, 0.0)
+    .automation("/custom_properties/gain", PPQ{192}, 1.0, Track::Interpolation::kLinear);
+
+  ASSERT_EQ(Time::from(64).toString(), tester.sequencerTrack().getFirstEventTime().toString());
+  ASSERT_EQ(Time::from(200).toString(), tester.sequencerTrack().getLastEventTime().toString());
+
+  // batch 0: before the first point (untouched) / batch 1: 0.0 / batch 2: ramp (one value per batch) / batch 3:
+  // end of ramp (1.0) then step at frame 8 / batch 4: no change
+  tester.rack().setTransportPlayPos(0);
+  tester.play(rack::Duration{5});
+  ASSERT_EQ(std::vector<std::string>({"0.000@0", "0.500@0", "1.000@0", "0.250@8"}), tester.device()->fOutput);
+  ASSERT_EQ(4, tester.sequencerTrack().getStats().fAutomationCount);
+
+  // higher resolution: 4 values per batch during the ramp
+  tester.device()->fOutput.clear();
+  tester.sequencerTrack().automationResolution(16);
+  tester.rack().setTransportPlayPos(128);
+  tester.play(rack::Duration{1});
+  ASSERT_EQ(std::vector<std::string>({"0.500@0", "0.625@16", "0.750@32", "0.875@48"}), tester.device()->fOutput);
+
+  // only number properties can be automated
+  tester.sequencerTrack().reset();
+  tester.sequencerTrack().automation("/transport/playing", PPQ{0}, 1.0);
+  tester.rack().setTransportPlayPos(0);
+  ASSERT_THROW(tester.play(rack::Duration{1}), Exception);
+}
+
+}
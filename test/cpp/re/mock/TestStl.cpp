@@ -51,4 +51,36 @@ TEST(Stl, join)
   }
 }
 
+// Stl.parallel_for
+TEST(Stl, parallel_for)
+{
+  for(unsigned int threadCount: {0u, 1u, 4u, 100u})
+  {
+    std::vector<int> v(50);
+    stl::parallel_for(v.size(), threadCount, [&v](size_t i) { v[i] = static_cast<int>(i) * 2; });
+    for(size_t i = 0; i < v.size(); i++)
+      ASSERT_EQ(i * 2, v[i]);
+  }
+
+  // nothing to do
+  stl::parallel_for(0, 4, [](size_t) { FAIL(); });
+
+  // all indices are processed and the first error (in index order) is rethrown
+  std::vector<int> v(10);
+  try
+  {
+    stl::parallel_for(v.size(), 4, [&v](size_t i) {
+      v[i] = 1;
+      if(i == 3 || i == 7)
+        throw static_cast<int>(i);
+    });
+    FAIL();
+  }
+  catch(int i)
+  {
+    ASSERT_EQ(3, i);
+  }
+  ASSERT_EQ(10, std::count(v.begin(), v.end(), 1));
+}
+
 }
\ No newline at end of file
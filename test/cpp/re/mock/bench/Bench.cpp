@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "Bench.h"
+#include <re/mock/fmt.h>
+#include <re/mock/Errors.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <regex>
+#include <sstream>
+
+/**
+ * Runs the benchmarks (`re-mock_bench --help` for the options). The results are written as JSON and can be compared
+ * against a previous run (`--baseline`) in which case the exit code is 1 if any benchmark is slower than the baseline
+ * by more than the tolerance. */
+
+namespace re::mock::bench {
+
+//------------------------------------------------------------------------
+// registry
+//------------------------------------------------------------------------
+std::vector<Benchmark> &registry()
+{
+  static std::vector<Benchmark> kRegistry{};
+  return kRegistry;
+}
+
+namespace {
+
+struct Options
+{
+  std::string fFilter{};
+  int fRepetitions{5};
+  double fScale{1.0};
+  std::optional<std::string> fJsonFile{};
+  std::optional<std::string> fBaselineFile{};
+  double fTolerance{10.0}; // percent
+};
+
+struct Result
+{
+  std::string fName{};
+  size_t fIterations{};
+  std::vector<double> fNsPerIteration{}; // one per repetition (sorted)
+  double fItemsPerIteration{};
+
+  double min() const { return fNsPerIteration.front(); }
+  double median() const { return fNsPerIteration[fNsPerIteration.size() / 2]; }
+  double itemsPerSecond() const { return fItemsPerIteration > 0 ? fItemsPerIteration * 1e9 / median() : 0; }
+};
+
+//------------------------------------------------------------------------
+// usage
+//------------------------------------------------------------------------
+int usage(char const *iProgram)
+{
+  std::cerr << fmt::printf("Usage: %s [options]\n", iProgram);
+  std::cerr << "  --filter <text>        only runs the benchmarks whose name contains text\n";
+  std::cerr << "  --repetitions <n>      number of times each benchmark is run (default 5, the median is reported)\n";
+  std::cerr << "  --scale <factor>       multiplies the number of iterations (ex: 0.01 for a quick run)\n";
+  std::cerr << "  --json <file>          writes the results as JSON (- for stdout)\n";
+  std::cerr << "  --baseline <file>      compares the results against a JSON file written by a previous run\n";
+  std::cerr << "  --tolerance <percent>  slowdown allowed before being reported as a regression (default 10)\n";
+  return 1;
+}
+
+//------------------------------------------------------------------------
+// run
+//------------------------------------------------------------------------
+Result run(Benchmark const &iBenchmark, Options const &iOptions)
+{
+  Result res{};
+  res.fName = iBenchmark.fName;
+  res.fIterations = std::max<size_t>(static_cast<size_t>(std::llround(iBenchmark.fIterations * iOptions.fScale)), 1);
+  for(int i = 0; i < iOptions.fRepetitions; i++)
+  {
+    State state{res.fIterations, iOptions.fScale};
+    iBenchmark.fFunction(state);
+    res.fNsPerIteration.emplace_back(static_cast<double>(state.getElapsedTime().count()) / res.fIterations);
+    res.fItemsPerIteration = state.getItemsPerIteration();
+  }
+  std::sort(res.fNsPerIteration.begin(), res.fNsPerIteration.end());
+  return res;
+}
+
+//------------------------------------------------------------------------
+// toJson
+//------------------------------------------------------------------------
+std::string toJson(std::vector<Result> const &iResults, Options const &iOptions)
+{
+  std::ostringstream s{};
+  s << "{\n";
+  s << fmt::printf("  \"context\": { \"repetitions\": %d, \"scale\": %g, \"debug\": %s },\n",
+                   iOptions.fRepetitions, iOptions.fScale,
+#ifdef NDEBUG
+                   "false"
+#else
+                   "true"
+#endif
+  );
+  s << "  \"benchmarks\": [\n";
+  for(size_t i = 0; i < iResults.size(); i++)
+  {
+    auto const &r = iResults[i];
+    // one benchmark per line (see loadBaseline)
+    s << fmt::printf("    { \"name\": \"%s\", \"iterations\": %llu, \"min_ns\": %.3f, \"median_ns\": %.3f, \"items_per_second\": %.3f }%s\n",
+                     r.fName, static_cast<unsigned long long>(r.fIterations), r.min(), r.median(), r.itemsPerSecond(), i + 1 < iResults.size() ? "," : "");
+  }
+  s << "  ]\n";
+  s << "}\n";
+  return s.str();
+}
+
+//------------------------------------------------------------------------
+// loadBaseline
+//------------------------------------------------------------------------
+std::map<std::string, double> loadBaseline(std::string const &iFile)
+{
+  std::ifstream f{iFile};
+  RE_MOCK_ASSERT(f.good(), "Cannot read baseline file [%s]", iFile);
+
+  static const std::regex kBenchmark{R"#("name":\s*"([^"]+)".*"median_ns":\s*([-+0-9.eE]+))#"};
+
+  std::map<std::string, double> res{};
+  std::string line{};
+  while(std::getline(f, line))
+  {
+    std::smatch m{};
+    if(std::regex_search(line, m, kBenchmark))
+      res[m[1].str()] = std::stod(m[2].str());
+  }
+  return res;
+}
+
+}
+
+}
+
+using namespace re::mock;
+using namespace re::mock::bench;
+
+//------------------------------------------------------------------------
+// main
+//------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  Options options{};
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg{argv[i]};
+    auto hasValue = i + 1 < argc;
+    if(arg == "--filter" && hasValue)
+      options.fFilter = argv[++i];
+    else if(arg == "--repetitions" && hasValue)
+      options.fRepetitions = std::max(std::stoi(argv[++i]), 1);
+    else if(arg == "--scale" && hasValue)
+      options.fScale = std::stod(argv[++i]);
+    else if(arg == "--json" && hasValue)
+      options.fJsonFile = argv[++i];
+    else if(arg == "--baseline" && hasValue)
+      options.fBaselineFile = argv[++i];
+    else if(arg == "--tolerance" && hasValue)
+      options.fTolerance = std::stod(argv[++i]);
+    else
+      return usage(argv[0]);
+  }
+
+  try
+  {
+    // when the json goes to stdout, the human readable output goes to stderr
+    auto &out = options.fJsonFile == "-" ? std::cerr : std::cout;
+
+    std::optional<std::map<std::string, double>> baseline{};
+    if(options.fBaselineFile)
+      baseline = loadBaseline(*options.fBaselineFile);
+
+    std::vector<Result> results{};
+    int regressionCount = 0;
+    for(auto const &benchmark: registry())
+    {
+      if(benchmark.fName.find(options.fFilter) == std::string::npos)
+        continue;
+
+      auto result = run(benchmark, options);
+      out << fmt::printf("%-40s %12.1f ns/iter (min %12.1f)", result.fName, result.median(), result.min());
+      if(result.fItemsPerIteration > 0)
+        out << fmt::printf(" %14.0f items/s", result.itemsPerSecond());
+      else
+        out << fmt::printf(" %14s        ", "");
+      if(baseline)
+      {
+        auto b = baseline->find(result.fName);
+        if(b != baseline->end() && b->second > 0)
+        {
+          auto change = (result.median() - b->second) * 100.0 / b->second;
+          auto regression = change > options.fTolerance;
+          if(regression)
+            regressionCount++;
+          out << fmt::printf(" %+7.1f%%%s", change, regression ? " REGRESSION" : "");
+        }
+        else
+          out << " (new)";
+      }
+      out << std::endl;
+      results.emplace_back(std::move(result));
+    }
+
+    if(options.fJsonFile)
+    {
+      auto json = toJson(results, options);
+      if(*options.fJsonFile == "-")
+        std::cout << json;
+      else
+      {
+        std::ofstream f{*options.fJsonFile};
+        RE_MOCK_ASSERT(f.good(), "Cannot write [%s]", *options.fJsonFile);
+        f << json;
+      }
+    }
+
+    if(regressionCount > 0)
+    {
+      out << fmt::printf("%d benchmark(s) slower than the baseline by more than %g%%\n", regressionCount, options.fTolerance);
+      return 1;
+    }
+    return 0;
+  }
+  catch(std::exception &e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#pragma once
+#ifndef __Pongasoft_re_mock_bench_h__
+#define __Pongasoft_re_mock_bench_h__
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace re::mock::bench {
+
+/**
+ * Passed to each benchmark: the benchmark does its (untimed) setup then calls `run()` with the code to measure
+ * which is executed `iterations()` times. */
+class State
+{
+public:
+  State(size_t iIterations, double iScale) : fIterations{iIterations}, fScale{iScale} {}
+
+  //! Number of times the body passed to `run()` is executed
+  inline size_t iterations() const { return fIterations; }
+
+  //! Scales a count (for example a number of notes) by the `--scale` option (never less than 1)
+  inline size_t scaled(size_t iCount) const { return std::max<size_t>(static_cast<size_t>(std::llround(iCount * fScale)), 1); }
+
+  //! Number of items (frames, notes...) processed per iteration (used to compute the items per second)
+  inline void setItemsPerIteration(double iItems) { fItemsPerIteration = iItems; }
+  inline double getItemsPerIteration() const { return fItemsPerIteration; }
+
+  //! Executes and times the body `iterations()` times
+  template<typename F>
+  void run(F &&iBody)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < fIterations; i++)
+      iBody();
+    fElapsedTime += std::chrono::steady_clock::now() - start;
+  }
+
+  inline std::chrono::nanoseconds getElapsedTime() const { return fElapsedTime; }
+
+private:
+  size_t fIterations;
+  double fScale;
+  double fItemsPerIteration{};
+  std::chrono::nanoseconds fElapsedTime{};
+};
+
+struct Benchmark
+{
+  std::string fName;
+  size_t fIterations; // before scaling
+  std::function<void(State &)> fFunction;
+};
+
+//! All the benchmarks registered with `RE_MOCK_BENCH`
+std::vector<Benchmark> &registry();
+
+struct Registrar
+{
+  Registrar(std::string iName, size_t iIterations, std::function<void(State &)> iFunction)
+  {
+    registry().emplace_back(Benchmark{std::move(iName), iIterations, std::move(iFunction)});
+  }
+};
+
+}
+
+/**
+ * Defines a benchmark (similar to gtest `TEST`) named `Suite.Name` whose body is executed `Iterations` times (scaled
+ * by the `--scale` option). The benchmark gets a `state` variable (`re::mock::bench::State`). */
+#define RE_MOCK_BENCH(Suite, Name, Iterations) \
+  static void re_mock_bench_##Suite##_##Name(re::mock::bench::State &state); \
+  static re::mock::bench::Registrar re_mock_bench_registrar_##Suite##_##Name{#Suite "." #Name, Iterations, re_mock_bench_##Suite##_##Name}; \
+  static void re_mock_bench_##Suite##_##Name(re::mock::bench::State &state)
+
+#endif //__Pongasoft_re_mock_bench_h__
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "Bench.h"
+#include <re/mock/DeviceTesters.h>
+#include <re/mock/MockDevices.h>
+
+// Macro benchmarks: realistic scenarios exercising the whole framework
+
+namespace re::mock::bench {
+
+// Macro.rack16: a chain of 16 devices (source -> 16 x pass through -> destination) for 1M batches
+RE_MOCK_BENCH(Macro, rack16, 1000000)
+{
+  constexpr int kDeviceCount = 16;
+
+  Rack rack{};
+  auto src = rack.newDevice(MAUSrc::CONFIG);
+  auto previous = src.getStereoAudioOutSocket(MAUSrc::LEFT_SOCKET, MAUSrc::RIGHT_SOCKET);
+  for(int i = 0; i < kDeviceCount; i++)
+  {
+    auto pst = rack.newDevice(MAUPst::CONFIG);
+    rack.wire(previous, pst.getStereoAudioInSocket(MAUPst::LEFT_SOCKET, MAUPst::RIGHT_SOCKET));
+    previous = pst.getStereoAudioOutSocket(MAUPst::LEFT_SOCKET, MAUPst::RIGHT_SOCKET);
+  }
+  auto dst = rack.newDevice(MAUDst::CONFIG);
+  rack.wire(previous, dst.getStereoAudioInSocket(MAUDst::LEFT_SOCKET, MAUDst::RIGHT_SOCKET));
+
+  state.setItemsPerIteration(constants::kBatchSize);
+  state.run([&rack]() { rack.nextBatch(); });
+}
+
+// Macro.build64: builds a rack of 64 devices one at a time (Rack::newExtension)
+RE_MOCK_BENCH(Macro, build64, 20)
+{
+  constexpr int kDeviceCount = 64;
+
+  auto config = MAUPst::CONFIG.getConfig();
+  state.setItemsPerIteration(kDeviceCount);
+  state.run([&config]() {
+    Rack rack{};
+    for(int i = 0; i < kDeviceCount; i++)
+      rack.newExtension(config);
+  });
+}
+
+// Macro.build64Parallel: same as Macro.build64 but all at once (Rack::newExtensions)
+RE_MOCK_BENCH(Macro, build64Parallel, 20)
+{
+  constexpr int kDeviceCount = 64;
+
+  auto configs = std::vector<Config>(kDeviceCount, MAUPst::CONFIG.getConfig());
+  state.setItemsPerIteration(kDeviceCount);
+  state.run([&configs]() {
+    Rack rack{};
+    rack.newExtensions(configs);
+  });
+}
+
+// Macro.buildLarge: builds a device with a large motherboard definition (64 user samples, 32 patterns, 2500 properties)
+RE_MOCK_BENCH(Macro, buildLarge, 50)
+{
+  auto c = DeviceConfig<MockDevice>::fromSkeleton().accept_notes(true).mdef(Config::patterns(32));
+  for(int i = 0; i < 64; i++)
+    c.mdef(Config::user_sample(i, lua::jbox_user_sample_property{}.all_sample_parameters()));
+  for(int i = 0; i < 2000; i++)
+    c.mdef(Config::document_owner_property(fmt::printf("prop_%d", i), lua::jbox_number_property{}.default_value(0.5).persistence(lua::EPersistence::kPatch)));
+  for(int i = 0; i < 500; i++)
+    c.mdef(Config::rtc_owner_property(fmt::printf("rtc_%d", i), lua::jbox_number_property{}));
+  auto config = c.getConfig();
+
+  state.setItemsPerIteration(1);
+  state.run([&config]() {
+    Rack rack{};
+    rack.newExtension(config);
+  });
+}
+
+// Macro.cvChain100: a chain of 100 cv devices (source -> 100 x pass through -> destination) with a value changing every other batch
+RE_MOCK_BENCH(Macro, cvChain100, 100000)
+{
+  constexpr int kDeviceCount = 100;
+
+  Rack rack{};
+  auto src = rack.newDevice(MCVSrc::CONFIG);
+  auto previous = src.getCVOutSocket(MCVSrc::SOCKET);
+  for(int i = 0; i < kDeviceCount; i++)
+  {
+    auto pst = rack.newDevice(MCVPst::CONFIG);
+    rack.wire(previous, pst.getCVInSocket(MCVPst::SOCKET));
+    previous = pst.getCVOutSocket(MCVPst::SOCKET);
+  }
+  auto dst = rack.newDevice(MCVDst::CONFIG);
+  rack.wire(previous, dst.getCVInSocket(MCVDst::SOCKET));
+
+  size_t batch = 0;
+  state.setItemsPerIteration(kDeviceCount + 1);
+  state.run([&rack, &src, &batch]() {
+    src->fValue = static_cast<TJBox_Float64>(batch++ / 2);
+    rack.nextBatch();
+  });
+}
+
+// Macro.noteChain16: a chain of 16 note players (source -> 16 x pass through -> destination), 8 notes per batch
+RE_MOCK_BENCH(Macro, noteChain16, 100000)
+{
+  constexpr int kDeviceCount = 16;
+  constexpr int kNoteCount = 8;
+
+  Rack rack{};
+  auto src = rack.newDevice(MNPSrc::CONFIG);
+  rack::Extension previous = src;
+  for(int i = 0; i < kDeviceCount; i++)
+  {
+    auto pst = rack.newDevice(MNPPst::CONFIG);
+    MockNotePlayer::wire(rack, previous, pst);
+    previous = pst;
+  }
+  auto dst = rack.newDevice(MNPDst::CONFIG);
+  MockNotePlayer::wire(rack, previous, dst);
+
+  bool on = true;
+  state.setItemsPerIteration(kNoteCount * (kDeviceCount + 1));
+  state.run([&rack, &src, &on]() {
+    for(int i = 0; i < kNoteCount; i++)
+      src->fNoteEvents.note(static_cast<TJBox_UInt8>(60 + i), on ? 100 : 0, static_cast<TJBox_UInt16>(i));
+    on = !on;
+    rack.nextBatch();
+  });
+  RE_MOCK_ASSERT(dst->fNoteEvents.events().size() == kNoteCount);
+}
+
+// Macro.bounce100kNotes: bounces an instrument playing a sequencer track of 100k notes (chords of 8 notes)
+RE_MOCK_BENCH(Macro, bounce100kNotes, 1)
+{
+  struct Instrument : public MockDevice
+  {
+    explicit Instrument(int iSampleRate) : MockDevice(iSampleRate), fNoteStates{JBox_GetMotherboardObjectRef("/note_states")} {}
+
+    void renderBatch(TJBox_PropertyDiff const *iPropertyDiffs, TJBox_UInt32 iDiffCount) override
+    {
+      for(TJBox_UInt32 i = 0; i < iDiffCount; i++)
+      {
+        if(iPropertyDiffs[i].fPropertyRef.fObject == fNoteStates && JBox_AsNoteEvent(iPropertyDiffs[i]).fVelocity > 0)
+          fNoteCount++;
+      }
+    }
+
+    TJBox_ObjectRef fNoteStates;
+    size_t fNoteCount{};
+  };
+
+  constexpr int kChordSize = 8;
+  constexpr TJBox_Float64 kStep = constants::kPPQResolution / 8; // 1/32th note
+
+  auto noteCount = state.scaled(100000);
+
+  InstrumentTester<Instrument> tester(DeviceConfig<Instrument>::fromSkeleton(DeviceType::kInstrument)
+                                        .accept_notes(true)
+                                        .mdef(Config::stereo_audio_out())
+                                        .rtc(Config::rt_input_setup_notify("/note_states/*")));
+  tester.wireMainOut(Config::LEFT_SOCKET, Config::RIGHT_SOCKET);
+  tester.transportTempo(999);
+
+  auto &track = tester.sequencerTrack();
+  for(size_t i = 0; i < noteCount; i++)
+  {
+    auto step = static_cast<TJBox_Float64>(i / kChordSize);
+    auto note = static_cast<TJBox_UInt8>(48 + i % kChordSize);
+    track.noteOn(sequencer::PPQ{step * kStep}, note);
+    track.noteOff(sequencer::PPQ{step * kStep + kStep / 2}, note);
+  }
+  auto duration = sequencer::Duration::from(sequencer::PPQ{static_cast<TJBox_Float64>(noteCount / kChordSize + 1) * kStep});
+
+  state.setItemsPerIteration(static_cast<double>(noteCount));
+  state.run([&tester, &duration]() { tester.bounce(duration); });
+  RE_MOCK_ASSERT(tester.device()->fNoteCount == noteCount, "%d != %d", tester.device()->fNoteCount, noteCount);
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2021 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "Bench.h"
+#include <re/mock/Rack.h>
+#include <re/mock/MockDevices.h>
+#include <re/mock/FileManager.h>
+#include <re/mock/PatchParser.h>
+#include <re/mock/fft.h>
+#include <re_mock_build.h>
+#include <random>
+
+// Micro benchmarks: each one measures a single hot path of the framework
+
+namespace re::mock::bench {
+
+namespace {
+
+//------------------------------------------------------------------------
+// resourceFile
+//------------------------------------------------------------------------
+fs::path resourceFile(std::string const &iRelativePath)
+{
+  return fs::path(RE_MOCK_PROJECT_DIR) / "test" / "resources" / "re" / "mock" / iRelativePath;
+}
+
+//------------------------------------------------------------------------
+// propertiesConfig
+//------------------------------------------------------------------------
+DeviceConfig<MockDevice> propertiesConfig()
+{
+  return DeviceConfig<MockDevice>::fromSkeleton()
+    .mdef(Config::document_owner_property("prop_number", lua::jbox_number_property{}.property_tag(100)))
+    .mdef(Config::rt_owner_property("prop_rt_number", lua::jbox_number_property{}.property_tag(101)))
+    .mdef(Config::rtc_owner_property("prop_rtc_number", lua::jbox_number_property{}))
+    .rtc(Config::rtc_binding("/custom_properties/prop_number", "/global_rtc/on_prop_number"))
+    .rtc_string(R"(
+global_rtc["on_prop_number"] = function(source_property_path, new_value)
+  jbox.store_property("/custom_properties/prop_rtc_number", new_value)
+end
+)");
+}
+
+}
+
+// Rack.nextBatch: source -> pass through -> destination
+RE_MOCK_BENCH(Rack, nextBatch, 100000)
+{
+  Rack rack{};
+  auto src = rack.newDevice(MAUSrc::CONFIG);
+  auto pst = rack.newDevice(MAUPst::CONFIG);
+  auto dst = rack.newDevice(MAUDst::CONFIG);
+  rack.wire(src.getStereoAudioOutSocket(MAUSrc::LEFT_SOCKET, MAUSrc::RIGHT_SOCKET),
+            pst.getStereoAudioInSocket(MAUPst::LEFT_SOCKET, MAUPst::RIGHT_SOCKET));
+  rack.wire(pst.getStereoAudioOutSocket(MAUPst::LEFT_SOCKET, MAUPst::RIGHT_SOCKET),
+            dst.getStereoAudioInSocket(MAUDst::LEFT_SOCKET, MAUDst::RIGHT_SOCKET));
+  state.setItemsPerIteration(constants::kBatchSize);
+  state.run([&rack]() { rack.nextBatch(); });
+}
+
+// Motherboard.loadByTag: JBox_LoadMOMPropertyByTag
+RE_MOCK_BENCH(Motherboard, loadByTag, 1000000)
+{
+  Rack rack{};
+  auto re = rack.newDevice(propertiesConfig());
+  re.withJukebox([&state]() {
+    auto customProperties = JBox_GetMotherboardObjectRef("/custom_properties");
+    TJBox_Float64 sum{};
+    state.run([&]() { sum += JBox_GetNumber(JBox_LoadMOMPropertyByTag(customProperties, 100)); });
+    RE_MOCK_ASSERT(sum == 0);
+  });
+}
+
+// Motherboard.storeByTag: JBox_StoreMOMPropertyByTag
+RE_MOCK_BENCH(Motherboard, storeByTag, 1000000)
+{
+  Rack rack{};
+  auto re = rack.newDevice(propertiesConfig());
+  re.withJukebox([&state]() {
+    auto customProperties = JBox_GetMotherboardObjectRef("/custom_properties");
+    TJBox_Float64 value{};
+    state.run([&]() { JBox_StoreMOMPropertyByTag(customProperties, 101, JBox_MakeNumber(value++)); });
+  });
+}
+
+// Motherboard.loadByPath: Extension::getNum (path resolved on every call)
+RE_MOCK_BENCH(Motherboard, loadByPath, 1000000)
+{
+  Rack rack{};
+  auto re = rack.newDevice(propertiesConfig());
+  TJBox_Float64 sum{};
+  state.run([&]() { sum += re.getNum("/custom_properties/prop_number"); });
+  RE_MOCK_ASSERT(sum == 0);
+}
+
+// Motherboard.storeByPath: Extension::setNum (path resolved on every call)
+RE_MOCK_BENCH(Motherboard, storeByPath, 1000000)
+{
+  Rack rack{};
+  auto re = rack.newDevice(propertiesConfig());
+  TJBox_Float64 value{};
+  state.run([&]() { re.setNum("/custom_properties/prop_rt_number", value++); });
+}
+
+// RTC.bindingDispatch: a property change dispatched to a lua rtc binding (includes the batch)
+RE_MOCK_BENCH(RTC, bindingDispatch, 100000)
+{
+  Rack rack{};
+  auto re = rack.newDevice(propertiesConfig());
+  TJBox_Float64 value{};
+  state.run([&]() {
+    re.setNum("/custom_properties/prop_number", ++value);
+    rack.nextBatch();
+  });
+  RE_MOCK_ASSERT(re.getNum("/custom_properties/prop_rtc_number") == value);
+}
+
+// Sequencer.notes: sequencer track with 1 note per batch (on and off)
+RE_MOCK_BENCH(Sequencer, notes, 100000)
+{
+  Rack rack{};
+  auto re = rack.newDevice(DeviceConfig<MockDevice>::fromSkeleton(DeviceType::kInstrument).accept_notes(true));
+  auto &track = re.getSequencerTrack();
+  // at 120 bpm and 44100, 1 batch is ~ 1393 PPQ
+  constexpr TJBox_Float64 kStep = 1393;
+  for(size_t i = 0; i < state.iterations(); i++)
+  {
+    auto note = static_cast<TJBox_UInt8>(i % 128);
+    track.noteOn(sequencer::PPQ{i * kStep}, note);
+    track.noteOff(sequencer::PPQ{i * kStep + kStep / 2}, note);
+  }
+  rack.transportStart();
+  state.setItemsPerIteration(2); // events per batch
+  state.run([&rack]() { rack.nextBatch(); });
+}
+
+// FFT.realForward: 4096 points FFT (JBox_FFTRealForward)
+RE_MOCK_BENCH(FFT, realForward, 10000)
+{
+  constexpr TJBox_Int32 kFFTSize = 12; // 2^12 = 4096
+  std::mt19937 generator{0};
+  std::uniform_real_distribution<TJBox_Float32> distribution{-1.0f, 1.0f};
+  std::vector<TJBox_Float32> input(1 << kFFTSize);
+  for(auto &s: input)
+    s = distribution(generator);
+  auto data = input;
+  state.setItemsPerIteration(static_cast<double>(input.size()));
+  state.run([&]() {
+    std::copy(input.begin(), input.end(), data.begin());
+    computeFFTRealForward(kFFTSize, data.data());
+  });
+}
+
+// FileManager.loadSample: loads (and decodes) a wav file
+RE_MOCK_BENCH(FileManager, loadSample, 1000)
+{
+  auto file = resource::File{resourceFile("audio/sine.wav")};
+  state.run([&file]() { RE_MOCK_ASSERT(FileManager::loadSample(file) != nullptr); });
+}
+
+// PatchParser.parse: parses a patch file (no cache)
+RE_MOCK_BENCH(PatchParser, parse, 10000)
+{
+  auto file = resource::File{resourceFile("patches/Kooza_test0.repatch")};
+  state.run([&file]() { RE_MOCK_ASSERT(PatchParser::from(file) != nullptr); });
+}
+
+// PatchParser.cached: returns a patch from the cache
+RE_MOCK_BENCH(PatchParser, cached, 100000)
+{
+  auto file = resource::File{resourceFile("patches/Kooza_test0.repatch")};
+  state.run([&file]() { RE_MOCK_ASSERT(PatchParser::fromCache(file) != nullptr); });
+}
+
+}